@@ -0,0 +1,157 @@
+// Counts heap allocations per encoded/decoded document for the FieldValue map path
+// (to_fields/from_fields) and the direct schema path (to_bson/from_bson).
+//
+// Usage: qdb_alloc_bench [iterations]
+
+#include "quickdb/components/reflection.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    std::atomic<uint64_t> g_allocations{0};
+} // namespace
+
+void *operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+// A mid-sized model with short strings (within SSO) so that key allocations dominate the counts.
+class BenchRecord : public QDB::Model<BenchRecord>
+{
+public:
+    std::string name;
+    std::string region;
+    int32_t version = 0;
+    int64_t created_at = 0;
+    int64_t updated_at = 0;
+    double balance = 0.0;
+    double rating = 0.0;
+    bool active = false;
+    bool verified = false;
+    std::vector<int32_t> scores;
+    std::map<std::string, int32_t> limits;
+
+    template <typename Self, typename Visitor> static void schema(Self &self, Visitor &visitor)
+    {
+        visitor("name", self.name);
+        visitor("region", self.region);
+        visitor("version", self.version);
+        visitor("created_at", self.created_at);
+        visitor("updated_at", self.updated_at);
+        visitor("balance", self.balance);
+        visitor("rating", self.rating);
+        visitor("active", self.active);
+        visitor("verified", self.verified);
+        visitor("scores", self.scores);
+        visitor("limits", self.limits);
+    }
+};
+
+struct Result
+{
+    double allocations_per_doc;
+    double ns_per_doc;
+};
+
+template <typename Fn> Result measure(int iterations, Fn &&fn)
+{
+    fn(); // Warm up function-local statics (key tables) outside the measurement.
+    const uint64_t before = g_allocations.load();
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        fn();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    const uint64_t allocations = g_allocations.load() - before;
+    return Result{static_cast<double>(allocations) / iterations,
+                  static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) /
+                      iterations};
+}
+
+int main(int argc, char **argv)
+{
+    const int iterations = argc > 1 ? std::atoi(argv[1]) : 100000;
+
+    BenchRecord record;
+    record.name = "bench-user";
+    record.region = "eu-west";
+    record.version = 3;
+    record.created_at = 1700000000000;
+    record.updated_at = 1700000500000;
+    record.balance = 1024.5;
+    record.rating = 4.25;
+    record.active = true;
+    record.verified = true;
+    record.scores = {10, 20, 30, 40};
+    record.limits = {{"daily", 100}, {"monthly", 3000}};
+
+    bsoncxx::builder::basic::document seed;
+    record.to_bson(seed);
+    const bsoncxx::document::value encoded = seed.extract();
+
+    const Result encode_map = measure(iterations,
+                                      [&]()
+                                      {
+                                          bsoncxx::builder::basic::document builder;
+                                          for (const auto &pair : record.to_fields())
+                                          {
+                                              QDB::AppendToDocument(builder, pair.first, pair.second);
+                                          }
+                                      });
+
+    const Result encode_direct = measure(iterations,
+                                         [&]()
+                                         {
+                                             bsoncxx::builder::basic::document builder;
+                                             record.to_bson(builder);
+                                         });
+
+    const Result decode_map = measure(iterations,
+                                      [&]()
+                                      {
+                                          std::unordered_map<std::string, QDB::FieldValue> fields;
+                                          for (const auto &element : encoded.view())
+                                          {
+                                              fields[static_cast<std::string>(element.key())] =
+                                                  QDB::fromBsonElement(element);
+                                          }
+                                          BenchRecord decoded;
+                                          decoded.from_fields(fields);
+                                      });
+
+    const Result decode_direct = measure(iterations,
+                                         [&]()
+                                         {
+                                             BenchRecord decoded;
+                                             decoded.from_bson(encoded.view());
+                                         });
+
+    std::printf("sizeof(FieldValue) = %zu bytes\n\n", sizeof(QDB::FieldValue));
+    std::printf("%-28s %14s %12s\n", "path", "allocs/doc", "ns/doc");
+    std::printf("%-28s %14.2f %12.1f\n", "encode: to_fields map", encode_map.allocations_per_doc, encode_map.ns_per_doc);
+    std::printf("%-28s %14.2f %12.1f\n", "encode: to_bson direct", encode_direct.allocations_per_doc,
+                encode_direct.ns_per_doc);
+    std::printf("%-28s %14.2f %12.1f\n", "decode: from_fields map", decode_map.allocations_per_doc, decode_map.ns_per_doc);
+    std::printf("%-28s %14.2f %12.1f\n", "decode: from_bson direct", decode_direct.allocations_per_doc,
+                decode_direct.ns_per_doc);
+    return 0;
+}
@@ -3,7 +3,10 @@
 #include "quickdb/components/document.h"
 #include "quickdb/components/field.h"
 #include "quickdb/components/query.h"
+#include "quickdb/components/query_shape.h"
 #include <mongocxx/pipeline.hpp>
+#include <cstdint>
+#include <string>
 #include <vector>
 
 namespace QDB
@@ -53,7 +56,7 @@ namespace QDB
 
     private:
         /// @brief The internal map holding the document fields.
-        std::unordered_map<std::string, FieldValue> _doc_map;
+        FieldMap _doc_map;
     };
 
     /// @brief A fluent interface for building MongoDB aggregation pipelines.
@@ -163,6 +166,17 @@ namespace QDB
         /// @return The configured mongocxx::pipeline.
         const mongocxx::pipeline &to_mongocxx() const { return _pipeline; }
 
+        /// @brief Renders the pipeline in canonical form. Stages keep their order. See canonical_array().
+        /// @param mode Whether literal values are kept or replaced by `?`.
+        /// @return The canonical form.
+        std::string canonical(ShapeMode mode = ShapeMode::kWithValues) const
+        {
+            return canonical_array(_pipeline.view_array(), mode);
+        }
+
+        /// @brief Gets a 64-bit hash of canonical().
+        std::uint64_t hash(ShapeMode mode = ShapeMode::kWithValues) const { return shape_hash(canonical(mode)); }
+
     private:
         /// @brief The underlying mongocxx pipeline object.
         mongocxx::pipeline _pipeline{};
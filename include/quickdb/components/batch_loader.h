@@ -0,0 +1,235 @@
+#pragma once
+
+#include "quickdb/components/exception.h"
+#include "quickdb/components/options.h"
+#include "quickdb/components/query.h"
+#include "quickdb/components/shared_collection.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <bsoncxx/oid.hpp>
+
+namespace QDB
+{
+    /// @brief Coalesces concurrent find-by-id lookups into batched `$in` queries.
+    ///
+    /// Ids requested within BatchLoaderOptions::window() of the first id of a batch, up to
+    /// max_batch_size() distinct ids, are fetched with a single `find_many(Query().in("_id", ids))` on a
+    /// background thread. The results are then fanned out to every waiter. Duplicate ids share one
+    /// result, including ids requested while a query for them is already in flight. Each batch is a fresh
+    /// read: nothing is cached once it completes.
+    ///
+    /// The loader can be shared by any number of threads. The destructor completes every pending lookup.
+    /// The Database must outlive the loader.
+    /// @tparam T A copyable class that inherits from QDB::Document.
+    template <typename T> class BatchLoader
+    {
+        static_assert(std::is_base_of_v<Document, T>, "Template argument T must be a subclass of QDB::Document");
+        static_assert(std::is_copy_constructible_v<T>, "BatchLoader shares results between waiters, so T must be copyable");
+
+    public:
+        /// @brief The result of a lookup: the document, or nullopt if no document has the id.
+        using Result = std::shared_future<std::optional<T>>;
+
+        /// @brief Constructs a loader and starts its background thread.
+        /// @param collection The collection to read from.
+        /// @param options The batching window and size.
+        explicit BatchLoader(SharedCollection<T> collection, const BatchLoaderOptions &options = BatchLoaderOptions{})
+            : _collection(std::move(collection)), _options(options)
+        {
+            _dispatcher = std::thread([this] { run(); });
+        }
+
+        /// @brief Completes every pending lookup, then stops the background thread.
+        ~BatchLoader()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stopping = true;
+            }
+            _wake.notify_all();
+            _dispatcher.join();
+        }
+
+        BatchLoader(const BatchLoader &) = delete;
+        BatchLoader &operator=(const BatchLoader &) = delete;
+
+        /// @brief Requests a document by id without waiting.
+        /// @param id The document's ObjectId.
+        /// @return A shared future for the document. Query failures are rethrown by get() as QDB::Exception.
+        Result load_async(const bsoncxx::oid &id)
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (auto in_flight = _in_flight.find(id); in_flight != _in_flight.end())
+            {
+                return in_flight->second.result;
+            }
+            auto [slot, inserted] = _pending.try_emplace(id);
+            if (inserted)
+            {
+                slot->second.result = slot->second.promise.get_future().share();
+                if (_pending.size() == 1)
+                {
+                    // The first id opens the window.
+                    _window_end = std::chrono::steady_clock::now() + _options.get_window();
+                    _wake.notify_all();
+                }
+                else if (_pending.size() >= _options.get_max_batch_size())
+                {
+                    _wake.notify_all();
+                }
+            }
+            return slot->second.result;
+        }
+
+        /// @brief Fetches a document by id, sharing the query with concurrent lookups.
+        /// @param id The document's ObjectId.
+        /// @return The document, or std::nullopt if none has the id.
+        /// @throws QDB::Exception if the batched query fails.
+        std::optional<T> load(const bsoncxx::oid &id) { return load_async(id).get(); }
+
+        /// @brief Fetches several documents by id.
+        /// @param ids The ids, which may repeat.
+        /// @return One entry per id, in order.
+        /// @throws QDB::Exception if a batched query fails.
+        std::vector<std::optional<T>> load_many(const std::vector<bsoncxx::oid> &ids)
+        {
+            std::vector<Result> results;
+            results.reserve(ids.size());
+            for (const auto &id : ids)
+            {
+                results.push_back(load_async(id));
+            }
+            std::vector<std::optional<T>> documents;
+            documents.reserve(ids.size());
+            for (auto &result : results)
+            {
+                documents.push_back(result.get());
+            }
+            return documents;
+        }
+
+        /// @brief Gets the number of `$in` queries sent so far.
+        std::uint64_t query_count() const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _query_count;
+        }
+
+    private:
+        /// @brief One distinct requested id and the waiters' shared result.
+        struct Slot
+        {
+            std::promise<std::optional<T>> promise;
+            Result result;
+        };
+
+        /// @brief The background loop: sends a batch when its window ends or it is full.
+        void run()
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            for (;;)
+            {
+                _wake.wait(lock, [&] { return _stopping || !_pending.empty(); });
+                if (_pending.empty())
+                {
+                    return;
+                }
+                _wake.wait_until(lock, _window_end,
+                                 [&] { return _stopping || _pending.size() >= _options.get_max_batch_size(); });
+
+                // Ids beyond the batch size stay pending and keep the current window end, since they
+                // arrived during it.
+                while (!_pending.empty() && _in_flight.size() < _options.get_max_batch_size())
+                {
+                    _in_flight.insert(_pending.extract(_pending.begin()));
+                }
+                ++_query_count;
+                std::vector<bsoncxx::oid> ids;
+                ids.reserve(_in_flight.size());
+                for (const auto &entry : _in_flight)
+                {
+                    ids.push_back(entry.first);
+                }
+
+                // Callers only read _in_flight, so its slots can be completed without the lock.
+                lock.unlock();
+                fetch(ids);
+                lock.lock();
+                _in_flight.clear();
+            }
+        }
+
+        /// @brief Runs one `$in` query and completes the in-flight slots.
+        void fetch(const std::vector<bsoncxx::oid> &ids)
+        {
+            try
+            {
+                std::vector<T> documents = _collection.find_many(Query().in("_id", ids));
+                std::map<bsoncxx::oid, T *> found;
+                for (auto &document : documents)
+                {
+                    found.emplace(document.get_id(), &document);
+                }
+                for (auto &entry : _in_flight)
+                {
+                    auto document = found.find(entry.first);
+                    if (document != found.end())
+                    {
+                        entry.second.promise.set_value(std::move(*document->second));
+                    }
+                    else
+                    {
+                        entry.second.promise.set_value(std::nullopt);
+                    }
+                }
+            }
+            catch (...)
+            {
+                auto error = std::current_exception();
+                for (auto &entry : _in_flight)
+                {
+                    try
+                    {
+                        entry.second.promise.set_exception(error);
+                    }
+                    catch (const std::future_error &)
+                    {
+                        // Already completed before the failure.
+                    }
+                }
+            }
+        }
+
+        /// @brief The collection lookups read from.
+        SharedCollection<T> _collection;
+        /// @brief The batching window and size.
+        BatchLoaderOptions _options;
+
+        mutable std::mutex _mutex;
+        /// @brief Wakes the background thread.
+        std::condition_variable _wake;
+        /// @brief Ids waiting for the next batch.
+        std::map<bsoncxx::oid, Slot> _pending;
+        /// @brief Ids of the batch being queried.
+        std::map<bsoncxx::oid, Slot> _in_flight;
+        /// @brief When the pending batch is sent at the latest.
+        std::chrono::steady_clock::time_point _window_end;
+        /// @brief The number of queries sent.
+        std::uint64_t _query_count = 0;
+        bool _stopping = false;
+        /// @brief The background thread. Declared last so it starts after every other member exists.
+        std::thread _dispatcher;
+    };
+} // namespace QDB
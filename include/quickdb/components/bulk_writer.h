@@ -0,0 +1,651 @@
+#pragma once
+
+#include "quickdb/components/document.h"
+#include "quickdb/components/exception.h"
+#include "quickdb/components/field.h"
+#include "quickdb/components/metrics.h"
+#include "quickdb/components/options.h"
+#include "quickdb/components/query.h"
+#include "quickdb/components/update.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/kvp.hpp>
+#include <bsoncxx/document/value.hpp>
+#include <bsoncxx/document/view.hpp>
+#include <bsoncxx/oid.hpp>
+#include <mongocxx/bulk_write.hpp>
+#include <mongocxx/client_session.hpp>
+#include <mongocxx/collection.hpp>
+#include <mongocxx/exception/bulk_write_exception.hpp>
+#include <mongocxx/model/write.hpp>
+#include <mongocxx/result/bulk_write.hpp>
+
+namespace QDB
+{
+    /// @brief The kind of a queued bulk operation.
+    enum class BulkOpType
+    {
+        kInsert,
+        kUpdateOne,
+        kUpdateMany,
+        kReplaceOne,
+        kDeleteOne,
+        kDeleteMany
+    };
+
+    /// @brief What happened to a queued bulk operation.
+    enum class BulkOpStatus
+    {
+        kSucceeded,  ///< The server applied the operation.
+        kFailed,     ///< The server reported a write error for the operation.
+        kNotExecuted ///< An ordered bulk write stopped at an earlier error before reaching the operation.
+    };
+
+    /// @brief The outcome of one operation of a bulk write, in the order the operations were queued.
+    struct BulkOpResult
+    {
+        BulkOpType type = BulkOpType::kInsert;
+        BulkOpStatus status = BulkOpStatus::kSucceeded;
+        /// @brief The server error code when status is kFailed.
+        int32_t error_code = 0;
+        /// @brief The server error message when status is kFailed.
+        std::string error_message;
+        /// @brief The `_id` assigned to an inserted document.
+        std::optional<bsoncxx::oid> inserted_id;
+        /// @brief The `_id` of a document created by an upsert.
+        std::optional<FieldValue> upserted_id;
+
+        /// @brief Checks whether the operation succeeded.
+        bool ok() const { return status == BulkOpStatus::kSucceeded; }
+    };
+
+    /// @brief The combined result of a bulk write across all the batches it was split into.
+    struct BulkWriteResult
+    {
+        int64_t inserted_count = 0;
+        int64_t matched_count = 0;
+        int64_t modified_count = 0;
+        int64_t deleted_count = 0;
+        int64_t upserted_count = 0;
+        /// @brief The number of write commands the operations were split into.
+        std::size_t batch_count = 0;
+        /// @brief One entry per queued operation, in queue order.
+        std::vector<BulkOpResult> operations;
+        /// @brief Messages of any write concern errors reported by the server.
+        std::vector<std::string> write_concern_errors;
+
+        /// @brief Checks whether every operation succeeded and no write concern error was reported.
+        bool ok() const
+        {
+            if (!write_concern_errors.empty())
+            {
+                return false;
+            }
+            for (const auto &op : operations)
+            {
+                if (!op.ok())
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    /// @brief What an executed bulk write may have changed, for invalidating client-side caches.
+    struct BulkWriteChanges
+    {
+        /// @brief The ids of documents updated, replaced or deleted through a filter of the form `{_id: oid}`.
+        std::vector<bsoncxx::oid> ids;
+        /// @brief True if any update, replace or delete used another filter, so any document may have changed.
+        bool by_filter = false;
+    };
+
+    /// @brief Queues heterogeneous write operations and sends them with as few round trips as possible.
+    ///
+    /// Operations are built from the existing Query and Update builders and encoded when queued, so the
+    /// source objects may be reused straight away. execute() sends them with mongocxx::bulk_write, split
+    /// into batches that respect the server's maxWriteBatchSize and 48MB message limits, and reports an
+    /// outcome per operation. Inserted documents receive a client-generated ObjectId when queued.
+    ///
+    /// Obtain one from Collection::bulk_writer(). It must not outlive that Collection.
+    /// @tparam T The document type of the collection (a subclass of QDB::Document).
+    template <typename T> class BulkWriter
+    {
+        static_assert(std::is_base_of_v<Document, T>, "Template argument T must be a subclass of QDB::Document");
+
+    public:
+        /// @brief Constructs a writer for a collection.
+        /// @param collection_handle The collection the operations apply to.
+        /// @param options Ordering and batch-splitting options.
+        /// @param metrics Where execute() calls are recorded, as OperationKind::kBulkWrite.
+        BulkWriter(mongocxx::collection collection_handle, const BulkWriteOptions &options = BulkWriteOptions{},
+                   CollectionMetrics metrics = CollectionMetrics{})
+            : _collection_handle(std::move(collection_handle)), _options(options), _metrics(metrics)
+        {
+        }
+
+        /// @brief Sets a callback run after each execute(), including one that throws, with what the
+        /// operations sent may have changed. Collection::bulk_writer() uses it to keep its caches coherent.
+        /// @param hook The callback. It should not throw.
+        /// @return A reference to this writer for chaining.
+        BulkWriter &with_invalidation(std::function<void(const BulkWriteChanges &changes)> hook)
+        {
+            _invalidate = std::move(hook);
+            return *this;
+        }
+
+        /// @brief Queues an insert. A new ObjectId is assigned to `doc` immediately.
+        /// @param doc The document to insert.
+        /// @return A reference to this writer for chaining.
+        BulkWriter &insert(T &doc)
+        {
+            doc._id = bsoncxx::oid{};
+            bsoncxx::builder::basic::document builder;
+            builder.append(bsoncxx::builder::basic::kvp("_id", doc._id));
+            doc.to_bson(builder);
+            Operation op{BulkOpType::kInsert, builder.extract()};
+            op.inserted_id = doc._id;
+            return enqueue(std::move(op));
+        }
+
+        /// @brief Queues an update of the first document matching `filter`.
+        /// @param filter The selection criteria.
+        /// @param update The modifications to apply.
+        /// @param upsert True to insert a document when nothing matches.
+        /// @return A reference to this writer for chaining.
+        BulkWriter &update_one(const Query &filter, const Update &update, bool upsert = false)
+        {
+            Operation op{BulkOpType::kUpdateOne, encode(filter.get_fields())};
+            op.second = encode(update.get_fields());
+            op.upsert = upsert;
+            return enqueue(std::move(op));
+        }
+
+        /// @brief Queues an update of every document matching `filter`.
+        /// @param filter The selection criteria.
+        /// @param update The modifications to apply.
+        /// @param upsert True to insert a document when nothing matches.
+        /// @return A reference to this writer for chaining.
+        BulkWriter &update_many(const Query &filter, const Update &update, bool upsert = false)
+        {
+            Operation op{BulkOpType::kUpdateMany, encode(filter.get_fields())};
+            op.second = encode(update.get_fields());
+            op.upsert = upsert;
+            return enqueue(std::move(op));
+        }
+
+        /// @brief Queues an update of the first document matching `filter`, inserting one if none matches.
+        /// @param filter The selection criteria.
+        /// @param update The modifications to apply.
+        /// @return A reference to this writer for chaining.
+        BulkWriter &upsert(const Query &filter, const Update &update) { return update_one(filter, update, true); }
+
+        /// @brief Queues a replacement of the first document matching `filter`. The replacement's `_id`
+        /// is not sent, so the stored document keeps its own.
+        /// @param filter The selection criteria.
+        /// @param replacement The new document content.
+        /// @param upsert True to insert the replacement when nothing matches.
+        /// @return A reference to this writer for chaining.
+        BulkWriter &replace_one(const Query &filter, const T &replacement, bool upsert = false)
+        {
+            Operation op{BulkOpType::kReplaceOne, encode(filter.get_fields())};
+            bsoncxx::builder::basic::document builder;
+            replacement.to_bson(builder);
+            op.second = builder.extract();
+            op.upsert = upsert;
+            return enqueue(std::move(op));
+        }
+
+        /// @brief Queues a delete of the first document matching `filter`.
+        /// @param filter The selection criteria.
+        /// @return A reference to this writer for chaining.
+        BulkWriter &delete_one(const Query &filter)
+        {
+            return enqueue(Operation{BulkOpType::kDeleteOne, encode(filter.get_fields())});
+        }
+
+        /// @brief Queues a delete of every document matching `filter`.
+        /// @param filter The selection criteria.
+        /// @return A reference to this writer for chaining.
+        BulkWriter &delete_many(const Query &filter)
+        {
+            return enqueue(Operation{BulkOpType::kDeleteMany, encode(filter.get_fields())});
+        }
+
+        /// @brief Gets the number of queued operations.
+        std::size_t size() const { return _operations.size(); }
+
+        /// @brief Checks whether no operations are queued.
+        bool empty() const { return _operations.empty(); }
+
+        /// @brief Gets the estimated BSON bytes of the queued operations.
+        std::size_t queued_bytes() const { return _queued_bytes; }
+
+        /// @brief Discards all queued operations.
+        void clear()
+        {
+            _operations.clear();
+            _queued_bytes = 0;
+        }
+
+        /// @brief Moves every operation queued in `other` to the end of this writer's queue.
+        ///
+        /// Operations are collection-independent once queued, so they can be staged in one writer and sent
+        /// through another, e.g. one bound to a freshly leased connection.
+        /// @param other The writer to take operations from. It is left empty.
+        /// @return A reference to this writer for chaining.
+        BulkWriter &append(BulkWriter &&other)
+        {
+            if (_operations.empty())
+            {
+                _operations = std::move(other._operations);
+            }
+            else
+            {
+                _operations.insert(_operations.end(), std::make_move_iterator(other._operations.begin()),
+                                   std::make_move_iterator(other._operations.end()));
+            }
+            _queued_bytes += other._queued_bytes;
+            other.clear();
+            return *this;
+        }
+
+        /// @brief Encodes a queued operation as a self-contained BSON document, e.g. for a journal.
+        /// @param index The position of the operation in the queue.
+        /// @return A document that import_operation() turns back into the same operation.
+        bsoncxx::document::value export_operation(std::size_t index) const
+        {
+            using bsoncxx::builder::basic::kvp;
+            const Operation &op = _operations.at(index);
+            bsoncxx::builder::basic::document builder;
+            builder.append(kvp("type", static_cast<int32_t>(op.type)), kvp("first", op.first.view()));
+            if (op.second)
+            {
+                builder.append(kvp("second", op.second->view()));
+            }
+            builder.append(kvp("upsert", op.upsert));
+            return builder.extract();
+        }
+
+        /// @brief Queues an operation encoded by export_operation().
+        /// @param encoded The exported operation.
+        /// @return A reference to this writer for chaining.
+        /// @throws QDB::Exception if `encoded` is not a valid exported operation.
+        BulkWriter &import_operation(const bsoncxx::document::view &encoded)
+        {
+            auto type = encoded["type"];
+            auto first = encoded["first"];
+            if (!type || type.type() != bsoncxx::type::k_int32 || type.get_int32().value < 0 ||
+                type.get_int32().value > static_cast<int32_t>(BulkOpType::kDeleteMany) || !first ||
+                first.type() != bsoncxx::type::k_document)
+            {
+                throw QDB::Exception("Invalid encoded bulk operation");
+            }
+            Operation op{static_cast<BulkOpType>(type.get_int32().value),
+                         bsoncxx::document::value(first.get_document().value)};
+            auto second = encoded["second"];
+            if (second && second.type() == bsoncxx::type::k_document)
+            {
+                op.second = bsoncxx::document::value(second.get_document().value);
+            }
+            else if (op.type == BulkOpType::kUpdateOne || op.type == BulkOpType::kUpdateMany ||
+                     op.type == BulkOpType::kReplaceOne)
+            {
+                throw QDB::Exception("Invalid encoded bulk operation: missing update document");
+            }
+            auto upsert = encoded["upsert"];
+            op.upsert = upsert && upsert.type() == bsoncxx::type::k_bool && upsert.get_bool().value;
+            if (auto id = op.first.view()["_id"]; op.type == BulkOpType::kInsert && id && id.type() == bsoncxx::type::k_oid)
+            {
+                op.inserted_id = id.get_oid().value;
+            }
+            return enqueue(std::move(op));
+        }
+
+        /// @brief Sends all queued operations and clears the queue.
+        ///
+        /// Operations are split into batches of at most BulkWriteOptions::batch_ops() operations and
+        /// batch_bytes() estimated bytes. In ordered mode, execution stops at the first failed operation
+        /// and the remaining ones are reported as kNotExecuted; in unordered mode every batch is sent.
+        /// Write errors are reported per operation rather than thrown.
+        /// @param session An optional session to use for the operation.
+        /// @return The combined result, with one BulkOpResult per queued operation.
+        /// @throws QDB::Exception if a batch fails for a reason other than write errors (e.g. network).
+        BulkWriteResult execute(std::optional<std::reference_wrapper<mongocxx::client_session>> session = std::nullopt)
+        {
+            auto timer = _metrics.time(OperationKind::kBulkWrite);
+            timer.encoded(_queued_bytes);
+            std::vector<Operation> operations = std::move(_operations);
+            clear();
+            timer.documents(operations.size());
+
+            BulkWriteResult result;
+            result.operations.reserve(operations.size());
+            for (const auto &op : operations)
+            {
+                BulkOpResult outcome;
+                outcome.type = op.type;
+                outcome.inserted_id = op.inserted_id;
+                result.operations.push_back(std::move(outcome));
+            }
+
+            const std::size_t max_ops = _options.batch_ops();
+            const std::size_t max_bytes = _options.batch_bytes();
+            std::size_t begin = 0;
+            try
+            {
+                while (begin < operations.size())
+                {
+                    // Always take at least one operation, so an oversized document reaches the server's own check.
+                    std::size_t end = begin + 1;
+                    std::size_t bytes = operations[begin].bytes();
+                    while (end < operations.size() && end - begin < max_ops &&
+                           bytes + operations[end].bytes() <= max_bytes)
+                    {
+                        bytes += operations[end].bytes();
+                        ++end;
+                    }
+
+                    bool failed = execute_batch(operations, begin, end, session, result);
+                    ++result.batch_count;
+                    if (failed && _options.is_ordered())
+                    {
+                        mark_not_executed(result, end);
+                        break;
+                    }
+                    begin = end;
+                }
+            }
+            catch (const std::exception &)
+            {
+                // A failed batch may still have applied some of its operations.
+                notify_changes(operations);
+                throw;
+            }
+            notify_changes(operations);
+            return result;
+        }
+
+    private:
+        /// @brief A queued operation, already encoded.
+        struct Operation
+        {
+            Operation(BulkOpType op_type, bsoncxx::document::value doc) : type(op_type), first(std::move(doc)) {}
+
+            BulkOpType type;
+            /// @brief The filter, or the document for inserts.
+            bsoncxx::document::value first;
+            /// @brief The update or replacement document, when the operation has one.
+            std::optional<bsoncxx::document::value> second;
+            bool upsert = false;
+            std::optional<bsoncxx::oid> inserted_id;
+
+            /// @brief Estimates the bytes the operation adds to a write command.
+            std::size_t bytes() const
+            {
+                // The per-operation envelope ({q:, u:, upsert:, multi:} or the array index) is small.
+                constexpr std::size_t kEnvelope = 64;
+                return first.view().length() + (second ? second->view().length() : 0) + kEnvelope;
+            }
+        };
+
+        BulkWriter &enqueue(Operation op)
+        {
+            _queued_bytes += op.bytes();
+            _operations.push_back(std::move(op));
+            return *this;
+        }
+
+        /// @brief Converts an ordered map of FieldValues (a Query or Update document) to a BSON document.
+        static bsoncxx::document::value encode(const FieldMap &fields)
+        {
+            bsoncxx::builder::basic::document builder;
+            for (const auto &[key, value] : fields)
+            {
+                AppendToDocument(builder, key, value);
+            }
+            return builder.extract();
+        }
+
+        /// @brief Runs the invalidation hook with what `operations` may have changed.
+        void notify_changes(const std::vector<Operation> &operations) const
+        {
+            if (!_invalidate || operations.empty())
+            {
+                return;
+            }
+            BulkWriteChanges changes;
+            for (const auto &op : operations)
+            {
+                if (op.type == BulkOpType::kInsert)
+                {
+                    continue;
+                }
+                // Mirrors Query::id_value(): the filter holds nothing but an ObjectId `_id`.
+                const bsoncxx::document::view filter = op.first.view();
+                auto first = filter.begin();
+                if (first != filter.end() && std::next(first) == filter.end() && first->key() == "_id" &&
+                    first->type() == bsoncxx::type::k_oid)
+                {
+                    changes.ids.push_back(first->get_oid().value);
+                }
+                else
+                {
+                    changes.by_filter = true;
+                }
+            }
+            _invalidate(changes);
+        }
+
+        /// @brief Converts a queued operation to a driver write model.
+        static mongocxx::model::write to_model(const Operation &op)
+        {
+            switch (op.type)
+            {
+            case BulkOpType::kInsert:
+                return mongocxx::model::insert_one(op.first.view());
+            case BulkOpType::kUpdateOne:
+            {
+                mongocxx::model::update_one model(op.first.view(), op.second->view());
+                model.upsert(op.upsert);
+                return model;
+            }
+            case BulkOpType::kUpdateMany:
+            {
+                mongocxx::model::update_many model(op.first.view(), op.second->view());
+                model.upsert(op.upsert);
+                return model;
+            }
+            case BulkOpType::kReplaceOne:
+            {
+                mongocxx::model::replace_one model(op.first.view(), op.second->view());
+                model.upsert(op.upsert);
+                return model;
+            }
+            case BulkOpType::kDeleteOne:
+                return mongocxx::model::delete_one(op.first.view());
+            case BulkOpType::kDeleteMany:
+            default:
+                return mongocxx::model::delete_many(op.first.view());
+            }
+        }
+
+        /// @brief Sends operations [begin, end) as one write command and records their outcomes.
+        /// @return True if any operation in the batch failed.
+        bool execute_batch(const std::vector<Operation> &operations, std::size_t begin, std::size_t end,
+                           std::optional<std::reference_wrapper<mongocxx::client_session>> session,
+                           BulkWriteResult &result)
+        {
+            try
+            {
+                auto bulk = session ? _collection_handle.create_bulk_write(session->get(), _options.to_mongocxx())
+                                    : _collection_handle.create_bulk_write(_options.to_mongocxx());
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    bulk.append(to_model(operations[i]));
+                }
+
+                auto batch_result = bulk.execute();
+                if (batch_result)
+                {
+                    result.inserted_count += batch_result->inserted_count();
+                    result.matched_count += batch_result->matched_count();
+                    result.modified_count += batch_result->modified_count();
+                    result.deleted_count += batch_result->deleted_count();
+                    result.upserted_count += batch_result->upserted_count();
+                    for (const auto &[index, id] : batch_result->upserted_ids())
+                    {
+                        result.operations[begin + index].upserted_id = fromBsonElement(id);
+                    }
+                }
+                return false;
+            }
+            catch (const mongocxx::bulk_write_exception &e)
+            {
+                if (!e.raw_server_error())
+                {
+                    throw QDB::Exception("Bulk write failed: " + std::string(e.what()));
+                }
+                return apply_server_reply(e.raw_server_error()->view(), begin, end, result);
+            }
+            catch (const std::exception &e)
+            {
+                throw QDB::Exception("Bulk write failed: " + std::string(e.what()));
+            }
+        }
+
+        /// @brief Records counts, upserted ids and per-operation write errors from a failed batch's reply.
+        /// @return True if any operation in the batch has a write error.
+        bool apply_server_reply(const bsoncxx::document::view &reply, std::size_t begin, std::size_t end,
+                                BulkWriteResult &result) const
+        {
+            result.inserted_count += read_count(reply, "nInserted");
+            result.matched_count += read_count(reply, "nMatched");
+            result.modified_count += read_count(reply, "nModified");
+            result.deleted_count += read_count(reply, "nRemoved");
+            result.upserted_count += read_count(reply, "nUpserted");
+
+            if (auto upserted = reply["upserted"]; upserted && upserted.type() == bsoncxx::type::k_array)
+            {
+                for (const auto &entry : upserted.get_array().value)
+                {
+                    auto doc = entry.get_document().value;
+                    auto index = static_cast<std::size_t>(read_count(doc, "index"));
+                    if (begin + index < end && doc["_id"])
+                    {
+                        result.operations[begin + index].upserted_id = fromBsonElement(doc["_id"]);
+                    }
+                }
+            }
+
+            bool any_error = false;
+            std::size_t first_error = end;
+            if (auto errors = reply["writeErrors"]; errors && errors.type() == bsoncxx::type::k_array)
+            {
+                for (const auto &entry : errors.get_array().value)
+                {
+                    auto doc = entry.get_document().value;
+                    auto index = static_cast<std::size_t>(read_count(doc, "index"));
+                    if (begin + index >= end)
+                    {
+                        continue;
+                    }
+                    auto &outcome = result.operations[begin + index];
+                    outcome.status = BulkOpStatus::kFailed;
+                    outcome.error_code = static_cast<int32_t>(read_count(doc, "code"));
+                    if (auto message = doc["errmsg"]; message && message.type() == bsoncxx::type::k_string)
+                    {
+                        outcome.error_message = std::string(message.get_string().value);
+                    }
+                    any_error = true;
+                    first_error = std::min(first_error, begin + index);
+                }
+            }
+
+            if (auto errors = reply["writeConcernErrors"]; errors && errors.type() == bsoncxx::type::k_array)
+            {
+                for (const auto &entry : errors.get_array().value)
+                {
+                    auto message = entry.get_document().value["errmsg"];
+                    result.write_concern_errors.push_back(
+                        message && message.type() == bsoncxx::type::k_string ? std::string(message.get_string().value)
+                                                                            : std::string("write concern error"));
+                }
+            }
+
+            if (any_error && _options.is_ordered())
+            {
+                // An ordered batch stops at its first error; the operations after it were never applied.
+                for (std::size_t i = first_error + 1; i < end; ++i)
+                {
+                    if (result.operations[i].status == BulkOpStatus::kSucceeded)
+                    {
+                        result.operations[i].status = BulkOpStatus::kNotExecuted;
+                    }
+                }
+            }
+            return any_error;
+        }
+
+        /// @brief Marks every operation from `from` onwards as not executed.
+        static void mark_not_executed(BulkWriteResult &result, std::size_t from)
+        {
+            for (std::size_t i = from; i < result.operations.size(); ++i)
+            {
+                result.operations[i].status = BulkOpStatus::kNotExecuted;
+            }
+        }
+
+        /// @brief Reads an integer field of a server reply, accepting any numeric BSON type.
+        static int64_t read_count(const bsoncxx::document::view &doc, const char *key)
+        {
+            auto element = doc[key];
+            if (!element)
+            {
+                return 0;
+            }
+            switch (element.type())
+            {
+            case bsoncxx::type::k_int32:
+                return element.get_int32().value;
+            case bsoncxx::type::k_int64:
+                return element.get_int64().value;
+            case bsoncxx::type::k_double:
+                return static_cast<int64_t>(element.get_double().value);
+            default:
+                return 0;
+            }
+        }
+
+        /// @brief The collection the operations apply to.
+        mongocxx::collection _collection_handle;
+
+        /// @brief Ordering and batch-splitting options.
+        BulkWriteOptions _options;
+
+        /// @brief Where execute() calls are recorded.
+        CollectionMetrics _metrics;
+
+        /// @brief The operations queued since the last execute().
+        std::vector<Operation> _operations;
+
+        /// @brief The sum of Operation::bytes() over _operations.
+        std::size_t _queued_bytes = 0;
+
+        /// @brief Called after execute() with what it may have changed. May be empty.
+        std::function<void(const BulkWriteChanges &changes)> _invalidate;
+    };
+
+} // namespace QDB
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "quickdb/components/document.h"
+#include "quickdb/components/exception.h"
+
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <bsoncxx/document/value.hpp>
+#include <bsoncxx/document/view.hpp>
+#include <bsoncxx/oid.hpp>
+#include <bsoncxx/types.hpp>
+#include <mongocxx/change_stream.hpp>
+
+namespace QDB
+{
+    /// @brief The kind of a change event.
+    enum class ChangeType
+    {
+        kInsert,
+        kUpdate,
+        kReplace,
+        kDelete,
+        kDrop,
+        kRename,
+        kDropDatabase,
+        kInvalidate, ///< The stream was closed by a drop or rename. Reopen it with start_after().
+        kOther       ///< An event type this library does not know; see ChangeEvent::operation_type.
+    };
+
+    /// @brief A change event with its document decoded through the T codec.
+    /// @tparam T A class that inherits from QDB::Document.
+    template <typename T> struct ChangeEvent
+    {
+        ChangeType type = ChangeType::kOther;
+        /// @brief The server's operationType, e.g. "update".
+        std::string operation_type;
+        /// @brief The `_id` of the changed document, when it is an ObjectId.
+        std::optional<bsoncxx::oid> id;
+        /// @brief The documentKey: `_id` and, on sharded collections, the shard key.
+        std::optional<bsoncxx::document::value> document_key;
+        /// @brief The document after the change. Always set for inserts and replaces; set for updates with
+        /// FullDocument::kUpdateLookup (unless the document was deleted since) or kWhenAvailable.
+        std::optional<T> full_document;
+        /// @brief For updates, `{updatedFields, removedFields, truncatedArrays}`.
+        std::optional<bsoncxx::document::value> update_description;
+        /// @brief The token to resume the stream after this event.
+        std::optional<bsoncxx::document::value> resume_token;
+    };
+
+    /// @brief A change stream that yields typed events in batches.
+    ///
+    /// Returned by Collection::watch(). Each next_batch() call returns the events the server has, waiting up
+    /// to ChangeStreamOptions::max_await_time() when there are none, so a consumer loop costs one getMore per
+    /// batch instead of a query per poll. After each batch, resume_token() holds the position to restart from
+    /// via ChangeStreamOptions::resume_after(), even when the batch was empty.
+    ///
+    /// The stream must not outlive the Collection that opened it, and is not thread-safe.
+    /// @tparam T A class that inherits from QDB::Document.
+    template <typename T> class ChangeStream
+    {
+    public:
+        /// @brief Wraps an open driver change stream.
+        explicit ChangeStream(mongocxx::change_stream stream)
+            : _stream(std::make_unique<mongocxx::change_stream>(std::move(stream)))
+        {
+        }
+
+        ChangeStream(ChangeStream &&) noexcept = default;
+        ChangeStream &operator=(ChangeStream &&) noexcept = default;
+        ChangeStream(const ChangeStream &) = delete;
+        ChangeStream &operator=(const ChangeStream &) = delete;
+
+        /// @brief Reads the next batch of events.
+        /// @param max_events The most events to return. Zero returns the whole server batch. Events beyond the
+        /// limit are returned by the next call.
+        /// @return The events, oldest first. Empty if none arrived within the await time.
+        /// @throws QDB::Exception if reading from the server or decoding fails.
+        std::vector<ChangeEvent<T>> next_batch(std::size_t max_events = 0)
+        {
+            std::vector<ChangeEvent<T>> events;
+            try
+            {
+                // begin() does not advance past an event already read, so after stopping at the limit the
+                // iterator is kept, and the next call steps past the event it already returned.
+                mongocxx::change_stream::iterator it = _last_returned ? std::next(*_last_returned) : _stream->begin();
+                _last_returned.reset();
+                for (; it != _stream->end(); ++it)
+                {
+                    events.push_back(decode(*it));
+                    if (max_events != 0 && events.size() == max_events)
+                    {
+                        _last_returned = it;
+                        break;
+                    }
+                }
+                if (auto token = _stream->get_resume_token())
+                {
+                    _resume_token = bsoncxx::document::value(*token);
+                }
+            }
+            catch (const std::exception &e)
+            {
+                throw QDB::Exception("Failed to read from change stream: " + std::string(e.what()));
+            }
+            return events;
+        }
+
+        /// @brief Gets the token to resume after the last batch, if the server has provided one.
+        const std::optional<bsoncxx::document::value> &resume_token() const { return _resume_token; }
+
+    private:
+        /// @brief Converts a raw change event.
+        static ChangeEvent<T> decode(const bsoncxx::document::view &event)
+        {
+            ChangeEvent<T> result;
+            if (auto operation = event["operationType"]; operation && operation.type() == bsoncxx::type::k_string)
+            {
+                result.operation_type = std::string(operation.get_string().value);
+                result.type = change_type(result.operation_type);
+            }
+            if (auto key = event["documentKey"]; key && key.type() == bsoncxx::type::k_document)
+            {
+                result.document_key = bsoncxx::document::value(key.get_document().value);
+                if (auto id = key["_id"]; id && id.type() == bsoncxx::type::k_oid)
+                {
+                    result.id = id.get_oid().value;
+                }
+            }
+            if (auto full = event["fullDocument"]; full && full.type() == bsoncxx::type::k_document)
+            {
+                const bsoncxx::document::view view = full.get_document().value;
+                T doc;
+                if (auto id = view["_id"]; id && id.type() == bsoncxx::type::k_oid)
+                {
+                    doc._id = id.get_oid().value;
+                }
+                doc.from_bson(view);
+                result.full_document = std::move(doc);
+            }
+            if (auto update = event["updateDescription"]; update && update.type() == bsoncxx::type::k_document)
+            {
+                result.update_description = bsoncxx::document::value(update.get_document().value);
+            }
+            if (auto token = event["_id"]; token && token.type() == bsoncxx::type::k_document)
+            {
+                result.resume_token = bsoncxx::document::value(token.get_document().value);
+            }
+            return result;
+        }
+
+        static ChangeType change_type(const std::string &operation_type)
+        {
+            if (operation_type == "insert")
+                return ChangeType::kInsert;
+            if (operation_type == "update")
+                return ChangeType::kUpdate;
+            if (operation_type == "replace")
+                return ChangeType::kReplace;
+            if (operation_type == "delete")
+                return ChangeType::kDelete;
+            if (operation_type == "drop")
+                return ChangeType::kDrop;
+            if (operation_type == "rename")
+                return ChangeType::kRename;
+            if (operation_type == "dropDatabase")
+                return ChangeType::kDropDatabase;
+            if (operation_type == "invalidate")
+                return ChangeType::kInvalidate;
+            return ChangeType::kOther;
+        }
+
+        /// @brief The driver stream, on the heap so the ChangeStream can be moved while iterators are live.
+        std::unique_ptr<mongocxx::change_stream> _stream;
+        /// @brief Points at the last event returned when next_batch() stopped at its limit.
+        std::optional<mongocxx::change_stream::iterator> _last_returned;
+        std::optional<bsoncxx::document::value> _resume_token;
+    };
+} // namespace QDB
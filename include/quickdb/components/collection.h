@@ -1,17 +1,27 @@
 #pragma once
 
 #include "quickdb/components/aggregation.h"
+#include "quickdb/components/bulk_writer.h"
+#include "quickdb/components/change_stream.h"
+#include "quickdb/components/cursor.h"
 #include "quickdb/components/document.h"
+#include "quickdb/components/document_cache.h"
 #include "quickdb/components/exception.h"
 #include "quickdb/components/field.h"
+#include "quickdb/components/lazy_document.h"
+#include "quickdb/components/metrics.h"
 #include "quickdb/components/options.h"
 #include "quickdb/components/query.h"
+#include "quickdb/components/result_cache.h"
 #include "quickdb/components/update.h"
 
 // Standard library includes
 #include <functional>
 #include <iostream>
+#include <memory>
+#include <memory_resource>
 #include <optional>
+#include <string>
 #include <type_traits>
 #include <vector>
 
@@ -55,34 +65,107 @@ namespace QDB
         {
         }
 
+        /// @brief Serves find_one() lookups by id from a shared read-through cache.
+        ///
+        /// Updates and deletes through this handle evict the document their filter names by id, or clear the
+        /// cache when the filter is not by id. A BulkWriter from bulk_writer() does the same when executed.
+        /// Writes made elsewhere are evicted by the cache's change stream.
+        /// @param cache The cache, typically shared by every handle on the collection. Null detaches it.
+        /// @return A reference to this collection for chaining.
+        Collection &with_cache(std::shared_ptr<DocumentCache<T>> cache)
+        {
+            _cache = std::move(cache);
+            return *this;
+        }
+
+        /// @brief Gets the attached cache, or null.
+        const std::shared_ptr<DocumentCache<T>> &cache() const { return _cache; }
+
+        /// @brief Serves find_many(), count_documents() and aggregate() calls outside a session from a TTL
+        /// result cache.
+        ///
+        /// Results are keyed by `scope` and the call's canonical form, and may be up to the cache's TTL stale.
+        /// Writes through this handle drop every result in `scope`; writes elsewhere are seen once the TTL
+        /// expires.
+        /// @param cache The cache, which may be shared by many collections. Null detaches it.
+        /// @param scope The name results are grouped under, typically "database.collection".
+        /// @return A reference to this collection for chaining.
+        Collection &with_result_cache(std::shared_ptr<ResultCache> cache, std::string scope)
+        {
+            _result_cache = std::move(cache);
+            _result_scope = std::move(scope);
+            return *this;
+        }
+
+        /// @brief Gets the attached result cache, or null.
+        const std::shared_ptr<ResultCache> &result_cache() const { return _result_cache; }
+
+        /// @brief Records this handle's calls, and those of its BulkWriters, in a MetricsRegistry.
+        ///
+        /// Database attaches its registry to every handle it creates.
+        /// @param metrics The collection's handle into the registry. A default-constructed one disables recording.
+        /// @return A reference to this collection for chaining.
+        Collection &with_metrics(CollectionMetrics metrics)
+        {
+            _metrics = metrics;
+            return *this;
+        }
+
+        /// @brief Gets the handle calls are recorded through.
+        const CollectionMetrics &metrics() const { return _metrics; }
+
         /// @brief Creates a single document in the collection.
         /// @param doc The document object to insert.
         /// @param session An optional session to use for the operation.
         /// @return The number of documents inserted (1 on success).
         int64_t create_one(T &doc, std::optional<std::reference_wrapper<mongocxx::client_session>> session = std::nullopt)
         {
+            return create_one(doc, InsertOptions{}, session);
+        }
+
+        /// @brief Creates a single document in the collection with insert options.
+        ///
+        /// With InsertOptions::generate_ids(), the document's own ObjectId is sent as its first field, so the
+        /// id is known without reading the server's reply (and even when the write is unacknowledged), and
+        /// retrying the same document fails with a duplicate key error instead of inserting a second copy.
+        /// @param doc The document object to insert.
+        /// @param options The insert options (e.g., generate_ids, unacknowledged).
+        /// @param session An optional session to use for the operation.
+        /// @return The number of documents inserted (1 on success). Unacknowledged writes return 1 once sent.
+        int64_t create_one(T &doc, const InsertOptions &options,
+                           std::optional<std::reference_wrapper<mongocxx::client_session>> session = std::nullopt)
+        {
+            auto timer = _metrics.time(OperationKind::kCreateOne);
             try
             {
-                auto bson_doc = to_bson_doc(doc.to_fields());
+                auto bson_doc =
+                    timer.encode([&] { return options.generates_ids() ? to_bson_doc_with_id(doc) : to_bson_doc(doc); });
+                auto insert_opts = options.to_mongocxx();
                 bsoncxx::v_noabi::stdx::optional<mongocxx::result::insert_one> result;
                 if (session)
                 {
-                    result = _collection_handle.insert_one(session->get(), bson_doc.view());
+                    result = _collection_handle.insert_one(session->get(), bson_doc.view(), insert_opts);
                 }
                 else
                 {
-                    result = _collection_handle.insert_one(bson_doc.view());
+                    result = _collection_handle.insert_one(bson_doc.view(), insert_opts);
                 }
+                timer.documents(1);
 
+                invalidate_results();
                 if (result)
                 {
-                    doc._id = result->inserted_id().get_oid().value;
+                    if (!options.generates_ids())
+                    {
+                        doc._id = result->inserted_id().get_oid().value;
+                    }
                     return 1;
                 }
-                return 0;
+                return options.is_unacknowledged() ? 1 : 0;
             }
             catch (const std::exception &e)
             {
+                invalidate_results();
                 throw QDB::Exception("Failed to create document: " + std::string(e.what()));
             }
         }
@@ -94,44 +177,80 @@ namespace QDB
         int64_t create_many(std::vector<T> &docs,
                             std::optional<std::reference_wrapper<mongocxx::client_session>> session = std::nullopt)
         {
-            if (docs.empty())
+            return create_many(docs.begin(), docs.end(), InsertOptions{}, session);
+        }
+
+        /// @brief Creates multiple documents in the collection with insert options.
+        /// @param docs A vector of document objects to insert.
+        /// @param options The insert options (e.g., generate_ids, unacknowledged).
+        /// @param session An optional session to use for the operation.
+        /// @return The number of documents inserted. Unacknowledged writes return the number sent.
+        int64_t create_many(std::vector<T> &docs, const InsertOptions &options,
+                            std::optional<std::reference_wrapper<mongocxx::client_session>> session = std::nullopt)
+        {
+            return create_many(docs.begin(), docs.end(), options, session);
+        }
+
+        /// @brief Creates the documents in [first, last) in the collection.
+        ///
+        /// With InsertOptions::generate_ids(), each document's own ObjectId is sent as its first field; the
+        /// server's id map is then not consulted.
+        /// @param first The first document to insert.
+        /// @param last One past the last document to insert.
+        /// @param options The insert options (e.g., generate_ids, unacknowledged).
+        /// @param session An optional session to use for the operation.
+        /// @return The number of documents inserted. Unacknowledged writes return the number sent.
+        int64_t create_many(typename std::vector<T>::iterator first, typename std::vector<T>::iterator last,
+                            const InsertOptions &options = InsertOptions{},
+                            std::optional<std::reference_wrapper<mongocxx::client_session>> session = std::nullopt)
+        {
+            auto timer = _metrics.time(OperationKind::kCreateMany);
+            if (first == last)
                 return 0;
 
             try
             {
                 std::vector<bsoncxx::document::value> bson_docs;
-                bson_docs.reserve(docs.size());
-                for (const auto &doc : docs)
+                bson_docs.reserve(static_cast<size_t>(last - first));
+                for (auto it = first; it != last; ++it)
                 {
-                    bson_docs.push_back(to_bson_doc(doc.to_fields()));
+                    bson_docs.push_back(
+                        timer.encode([&] { return options.generates_ids() ? to_bson_doc_with_id(*it) : to_bson_doc(*it); }));
                 }
 
+                auto insert_opts = options.to_mongocxx();
                 bsoncxx::v_noabi::stdx::optional<mongocxx::result::insert_many> result;
                 if (session)
                 {
-                    result = _collection_handle.insert_many(session->get(), bson_docs);
+                    result = _collection_handle.insert_many(session->get(), bson_docs, insert_opts);
                 }
                 else
                 {
-                    result = _collection_handle.insert_many(bson_docs);
+                    result = _collection_handle.insert_many(bson_docs, insert_opts);
                 }
+                timer.documents(bson_docs.size());
+                invalidate_results();
 
                 if (result)
                 {
-                    const auto &inserted_ids = result->inserted_ids();
-                    for (size_t i = 0; i < docs.size(); ++i)
+                    if (!options.generates_ids())
                     {
-                        if (auto it = inserted_ids.find(static_cast<int32_t>(i)); it != inserted_ids.end())
+                        const auto &inserted_ids = result->inserted_ids();
+                        for (size_t i = 0; i < bson_docs.size(); ++i)
                         {
-                            docs[i]._id = it->second.get_oid().value;
+                            if (auto it = inserted_ids.find(static_cast<int32_t>(i)); it != inserted_ids.end())
+                            {
+                                first[i]._id = it->second.get_oid().value;
+                            }
                         }
                     }
                     return result->result().inserted_count();
                 }
-                return 0;
+                return options.is_unacknowledged() ? static_cast<int64_t>(bson_docs.size()) : 0;
             }
             catch (const std::exception &e)
             {
+                invalidate_results();
                 throw QDB::Exception("Failed to create many documents: " + std::string(e.what()));
             }
         }
@@ -144,22 +263,51 @@ namespace QDB
         std::optional<T> find_one(const Query &query, const FindOptions &options = FindOptions{},
                                   std::optional<std::reference_wrapper<mongocxx::client_session>> session = std::nullopt)
         {
+            auto timer = _metrics.time(OperationKind::kFindOne);
+            // Lookups by id outside a session, returning whole documents, can be served from the cache.
+            std::optional<bsoncxx::oid> cached_id;
+            std::uint64_t ticket = 0;
+            if constexpr (std::is_copy_constructible_v<T>)
+            {
+                if (_cache && !session && DocumentCache<T>::serves(options))
+                {
+                    cached_id = query.id_value();
+                    if (cached_id)
+                    {
+                        if (auto hit = _cache->get(*cached_id, &ticket))
+                        {
+                            timer.documents(1);
+                            return hit;
+                        }
+                    }
+                }
+            }
+
             try
             {
-                auto filter = to_bson_doc(query.get_fields());
+                auto filter = timer.encode([&] { return to_bson_doc(query.get_fields()); });
                 bsoncxx::v_noabi::stdx::optional<bsoncxx::document::value> result;
                 if (session)
                 {
-                    result = _collection_handle.find_one(session->get(), filter.view(), options.to_mongocxx());
+                    result = _collection_handle.find_one(session->get(), filter.view(), find_options(options));
                 }
                 else
                 {
-                    result = _collection_handle.find_one(filter.view(), options.to_mongocxx());
+                    result = _collection_handle.find_one(filter.view(), find_options(options));
                 }
 
                 if (result)
                 {
-                    return from_bson_doc(result->view());
+                    timer.documents(1);
+                    T doc = timer.decode(result->view(), [&] { return from_bson_doc(result->view()); });
+                    if constexpr (std::is_copy_constructible_v<T>)
+                    {
+                        if (cached_id)
+                        {
+                            _cache->put(doc, ticket);
+                        }
+                    }
+                    return doc;
                 }
                 return std::nullopt;
             }
@@ -177,26 +325,184 @@ namespace QDB
         std::vector<T> find_many(const Query &query, const FindOptions &options = FindOptions{},
                                  std::optional<std::reference_wrapper<mongocxx::client_session>> session = std::nullopt)
         {
-            std::vector<T> results;
+            auto timer = _metrics.time(OperationKind::kFindMany);
+            auto fetch = [&]
+            {
+                std::vector<T> results;
+                try
+                {
+                    auto filter = timer.encode([&] { return to_bson_doc(query.get_fields()); });
+                    mongocxx::cursor cursor =
+                        session ? _collection_handle.find(session->get(), filter.view(), find_options(options))
+                                : _collection_handle.find(filter.view(), find_options(options));
+
+                    if (auto config = stream_config(options); config.background())
+                    {
+                        collect(ResultStream<T>(std::move(cursor), config), results);
+                        return results;
+                    }
+                    for (const auto &view : cursor)
+                    {
+                        results.push_back(timer.decode(view, [&] { return from_bson_doc(view); }));
+                    }
+                }
+                catch (const std::exception &e)
+                {
+                    throw QDB::Exception("Failed to find many documents: " + std::string(e.what()));
+                }
+                return results;
+            };
+            if constexpr (std::is_copy_constructible_v<T>)
+            {
+                if (_result_cache && !session)
+                {
+                    auto results = _result_cache->get_or_compute<std::vector<T>>(
+                        _result_scope, "find:" + query.canonical() + options.canonical(), fetch);
+                    timer.documents(results.size());
+                    return results;
+                }
+            }
+            auto results = fetch();
+            timer.documents(results.size());
+            return results;
+        }
+
+        /// @brief Finds all documents matching the query, decoding them into a caller-supplied memory resource.
+        ///
+        /// The result vector is allocated from `resource`, and documents are constructed with it when T is
+        /// allocator-aware (declares `allocator_type` and an allocator constructor), so pmr members such as
+        /// std::pmr::string and std::pmr::vector decode into the resource too. FieldValue trees built during
+        /// decoding also use it. With a std::pmr::monotonic_buffer_resource, a whole page of results is released
+        /// at once when the resource is destroyed; the results must not outlive it.
+        /// @param query The query filter.
+        /// @param options The find options (e.g., sort, limit, skip).
+        /// @param resource The memory resource to allocate the results from.
+        /// @param session An optional session to use for the operation.
+        /// @return A std::pmr::vector of documents using `resource`.
+        std::pmr::vector<T> find_many(const Query &query, const FindOptions &options, std::pmr::memory_resource *resource,
+                                      std::optional<std::reference_wrapper<mongocxx::client_session>> session = std::nullopt)
+        {
+            auto timer = _metrics.time(OperationKind::kFindMany);
+            std::pmr::vector<T> results(resource);
             try
             {
-                auto filter = to_bson_doc(query.get_fields());
+                auto filter = timer.encode([&] { return to_bson_doc(query.get_fields()); });
                 mongocxx::cursor cursor = session
-                                              ? _collection_handle.find(session->get(), filter.view(), options.to_mongocxx())
-                                              : _collection_handle.find(filter.view(), options.to_mongocxx());
+                                              ? _collection_handle.find(session->get(), filter.view(), find_options(options))
+                                              : _collection_handle.find(filter.view(), find_options(options));
 
+                ScopedFieldResource scoped_resource(resource);
                 for (const auto &view : cursor)
                 {
-                    results.push_back(from_bson_doc(view));
+                    // emplace_back() performs uses-allocator construction for allocator-aware document types.
+                    results.emplace_back();
+                    timer.decode(view, [&] { decode_into(view, results.back()); });
                 }
             }
             catch (const std::exception &e)
             {
                 throw QDB::Exception("Failed to find many documents: " + std::string(e.what()));
             }
+            timer.documents(results.size());
+            return results;
+        }
+
+        /// @brief Finds a single document and returns it undecoded; fields are decoded when first read.
+        /// @param query The query filter.
+        /// @param options The find options (e.g., sort, projection).
+        /// @param session An optional session to use for the operation.
+        /// @return An std::optional containing the lazy document if found, otherwise std::nullopt.
+        std::optional<LazyDocument<T>> find_one_lazy(
+            const Query &query, const FindOptions &options = FindOptions{},
+            std::optional<std::reference_wrapper<mongocxx::client_session>> session = std::nullopt)
+        {
+            auto timer = _metrics.time(OperationKind::kFindOneLazy);
+            try
+            {
+                auto filter = timer.encode([&] { return to_bson_doc(query.get_fields()); });
+                bsoncxx::v_noabi::stdx::optional<bsoncxx::document::value> result;
+                if (session)
+                {
+                    result = _collection_handle.find_one(session->get(), filter.view(), find_options(options));
+                }
+                else
+                {
+                    result = _collection_handle.find_one(filter.view(), find_options(options));
+                }
+
+                if (result)
+                {
+                    timer.decoded(result->view().length());
+                    timer.documents(1);
+                    return LazyDocument<T>(std::move(*result));
+                }
+                return std::nullopt;
+            }
+            catch (const std::exception &e)
+            {
+                throw QDB::Exception("Failed to find one lazy document: " + std::string(e.what()));
+            }
+        }
+
+        /// @brief Finds all documents matching the query without decoding them.
+        /// Each result keeps its raw BSON and decodes only the fields that are read.
+        /// @param query The query filter.
+        /// @param options The find options (e.g., sort, limit, skip).
+        /// @param session An optional session to use for the operation.
+        /// @return A std::vector of lazy documents.
+        std::vector<LazyDocument<T>> find_many_lazy(
+            const Query &query, const FindOptions &options = FindOptions{},
+            std::optional<std::reference_wrapper<mongocxx::client_session>> session = std::nullopt)
+        {
+            auto timer = _metrics.time(OperationKind::kFindManyLazy);
+            std::vector<LazyDocument<T>> results;
+            try
+            {
+                auto filter = timer.encode([&] { return to_bson_doc(query.get_fields()); });
+                mongocxx::cursor cursor = session
+                                              ? _collection_handle.find(session->get(), filter.view(), find_options(options))
+                                              : _collection_handle.find(filter.view(), find_options(options));
+
+                for (const auto &view : cursor)
+                {
+                    timer.decoded(view.length());
+                    results.emplace_back(bsoncxx::document::value(view));
+                }
+            }
+            catch (const std::exception &e)
+            {
+                throw QDB::Exception("Failed to find many lazy documents: " + std::string(e.what()));
+            }
+            timer.documents(results.size());
             return results;
         }
 
+        /// @brief Finds all documents matching the query and returns them as a single-pass stream.
+        ///
+        /// Documents are decoded one at a time as the stream is iterated, and further batches are fetched
+        /// as needed, so memory stays bounded by the batch size rather than the result size. Use
+        /// FindOptions::batch_size() and FindOptions::max_await_time() to tune fetching.
+        /// @param query The query filter.
+        /// @param options The find options (e.g., sort, limit, batch_size).
+        /// @param session An optional session to use for the operation.
+        /// @return A ResultStream of documents. It must not outlive this collection.
+        ResultStream<T> find_stream(const Query &query, const FindOptions &options = FindOptions{},
+                                    std::optional<std::reference_wrapper<mongocxx::client_session>> session = std::nullopt)
+        {
+            auto timer = _metrics.time(OperationKind::kFindStream);
+            try
+            {
+                auto filter = timer.encode([&] { return to_bson_doc(query.get_fields()); });
+                return ResultStream<T>(session ? _collection_handle.find(session->get(), filter.view(), find_options(options))
+                                               : _collection_handle.find(filter.view(), find_options(options)),
+                                       stream_config(options));
+            }
+            catch (const std::exception &e)
+            {
+                throw QDB::Exception("Failed to open document stream: " + std::string(e.what()));
+            }
+        }
+
         /// @brief Updates a single document that matches the filter.
         /// @param filter_query A Query object defining which document to update.
         /// @param update_doc An Update object defining the update operations.
@@ -207,10 +513,11 @@ namespace QDB
                            const UpdateOptions &options = UpdateOptions{},
                            std::optional<std::reference_wrapper<mongocxx::client_session>> session = std::nullopt)
         {
+            auto timer = _metrics.time(OperationKind::kUpdateOne);
             try
             {
-                auto filter = to_bson_doc(filter_query.get_fields());
-                auto update = to_bson_doc(update_doc.get_fields());
+                auto filter = timer.encode([&] { return to_bson_doc(filter_query.get_fields()); });
+                auto update = timer.encode([&] { return to_bson_doc(update_doc.get_fields()); });
                 auto mongocxx_opts = options.to_mongocxx();
 
                 bsoncxx::v_noabi::stdx::optional<mongocxx::result::update> result;
@@ -222,6 +529,7 @@ namespace QDB
                 {
                     result = _collection_handle.update_one(filter.view(), update.view(), mongocxx_opts);
                 }
+                invalidate_cached(filter_query);
 
                 if (result)
                 {
@@ -231,6 +539,7 @@ namespace QDB
             }
             catch (const std::exception &e)
             {
+                invalidate_cached(filter_query);
                 throw QDB::Exception("Failed to update one document: " + std::string(e.what()));
             }
         }
@@ -245,10 +554,11 @@ namespace QDB
                             const UpdateOptions &options = UpdateOptions{},
                             std::optional<std::reference_wrapper<mongocxx::client_session>> session = std::nullopt)
         {
+            auto timer = _metrics.time(OperationKind::kUpdateMany);
             try
             {
-                auto filter = to_bson_doc(filter_query.get_fields());
-                auto update = to_bson_doc(update_doc.get_fields());
+                auto filter = timer.encode([&] { return to_bson_doc(filter_query.get_fields()); });
+                auto update = timer.encode([&] { return to_bson_doc(update_doc.get_fields()); });
                 auto mongocxx_opts = options.to_mongocxx();
 
                 bsoncxx::v_noabi::stdx::optional<mongocxx::result::update> result;
@@ -260,6 +570,7 @@ namespace QDB
                 {
                     result = _collection_handle.update_many(filter.view(), update.view(), mongocxx_opts);
                 }
+                invalidate_cached(filter_query);
 
                 if (result)
                 {
@@ -269,6 +580,7 @@ namespace QDB
             }
             catch (const std::exception &e)
             {
+                invalidate_cached(filter_query);
                 throw QDB::Exception("Failed to update many documents: " + std::string(e.what()));
             }
         }
@@ -280,9 +592,10 @@ namespace QDB
         int64_t delete_one(const Query &query,
                            std::optional<std::reference_wrapper<mongocxx::client_session>> session = std::nullopt)
         {
+            auto timer = _metrics.time(OperationKind::kDeleteOne);
             try
             {
-                auto filter = to_bson_doc(query.get_fields());
+                auto filter = timer.encode([&] { return to_bson_doc(query.get_fields()); });
                 bsoncxx::v_noabi::stdx::optional<mongocxx::result::delete_result> result;
                 if (session)
                 {
@@ -292,6 +605,7 @@ namespace QDB
                 {
                     result = _collection_handle.delete_one(filter.view());
                 }
+                invalidate_cached(query);
 
                 if (result)
                 {
@@ -301,6 +615,7 @@ namespace QDB
             }
             catch (const std::exception &e)
             {
+                invalidate_cached(query);
                 throw QDB::Exception("Failed to delete one document: " + std::string(e.what()));
             }
         }
@@ -312,9 +627,10 @@ namespace QDB
         int64_t delete_many(const Query &query,
                             std::optional<std::reference_wrapper<mongocxx::client_session>> session = std::nullopt)
         {
+            auto timer = _metrics.time(OperationKind::kDeleteMany);
             try
             {
-                auto filter = to_bson_doc(query.get_fields());
+                auto filter = timer.encode([&] { return to_bson_doc(query.get_fields()); });
                 bsoncxx::v_noabi::stdx::optional<mongocxx::result::delete_result> result;
                 if (session)
                 {
@@ -324,6 +640,7 @@ namespace QDB
                 {
                     result = _collection_handle.delete_many(filter.view());
                 }
+                invalidate_cached(query);
                 if (result)
                 {
                     return result->deleted_count();
@@ -332,6 +649,7 @@ namespace QDB
             }
             catch (const std::exception &e)
             {
+                invalidate_cached(query);
                 throw QDB::Exception("Failed to delete many documents: " + std::string(e.what()));
             }
         }
@@ -343,22 +661,31 @@ namespace QDB
         int64_t count_documents(const Query &query = Query{},
                                 std::optional<std::reference_wrapper<mongocxx::client_session>> session = std::nullopt)
         {
-            try
+            auto timer = _metrics.time(OperationKind::kCountDocuments);
+            auto count = [&]() -> int64_t
             {
-                auto filter = to_bson_doc(query.get_fields());
-                if (session)
+                try
                 {
-                    return _collection_handle.count_documents(session->get(), filter.view());
+                    auto filter = timer.encode([&] { return to_bson_doc(query.get_fields()); });
+                    if (session)
+                    {
+                        return _collection_handle.count_documents(session->get(), filter.view());
+                    }
+                    else
+                    {
+                        return _collection_handle.count_documents(filter.view());
+                    }
                 }
-                else
+                catch (const std::exception &e)
                 {
-                    return _collection_handle.count_documents(filter.view());
+                    throw QDB::Exception("Failed to count documents: " + std::string(e.what()));
                 }
-            }
-            catch (const std::exception &e)
+            };
+            if (_result_cache && !session)
             {
-                throw QDB::Exception("Failed to count documents: " + std::string(e.what()));
+                return _result_cache->get_or_compute<int64_t>(_result_scope, "count:" + query.canonical(), count);
             }
+            return count();
         }
 
         /// @brief Executes an aggregation pipeline.
@@ -373,36 +700,201 @@ namespace QDB
         {
             static_assert(std::is_base_of_v<Document, ResultType>, "ResultType must be a subclass of QDB::Document");
 
-            std::vector<ResultType> results;
-            try
+            auto timer = _metrics.time(OperationKind::kAggregate);
+
+            auto fetch = [&]
             {
-                mongocxx::cursor cursor = session ? _collection_handle.aggregate(session->get(), aggregation.to_mongocxx())
-                                                  : _collection_handle.aggregate(aggregation.to_mongocxx());
-                for (const auto &view : cursor)
+                std::vector<ResultType> results;
+                try
                 {
-                    ResultType doc;
-                    std::unordered_map<std::string, FieldValue> fields;
-                    for (const auto &element : view)
+                    timer.encoded(aggregation.to_mongocxx().view_array().length());
+                    mongocxx::cursor cursor =
+                        session ? _collection_handle.aggregate(session->get(), aggregation.to_mongocxx())
+                                : _collection_handle.aggregate(aggregation.to_mongocxx());
+                    for (const auto &view : cursor)
                     {
-                        std::string key = static_cast<std::string>(element.key());
-                        if (key == "_id" && element.type() == bsoncxx::type::k_oid)
+                        results.push_back(timer.decode(view, [&] { return from_bson_doc<ResultType>(view); }));
+                    }
+                }
+                catch (const std::exception &e)
+                {
+                    throw QDB::Exception("Failed to execute aggregation: " + std::string(e.what()));
+                }
+                return results;
+            };
+            if constexpr (std::is_copy_constructible_v<ResultType>)
+            {
+                // AggregateOptions only tune delivery, so they are not part of the key.
+                if (_result_cache && !session)
+                {
+                    auto results = _result_cache->get_or_compute<std::vector<ResultType>>(
+                        _result_scope, "aggregate:" + aggregation.canonical(), fetch);
+                    timer.documents(results.size());
+                    return results;
+                }
+            }
+            auto results = fetch();
+            timer.documents(results.size());
+            return results;
+        }
+
+        /// @brief Executes an aggregation pipeline with options (e.g., batch_size, allow_disk_use, prefetch,
+        /// decode_threads).
+        /// @tparam ResultType The Document subclass to decode each result into. Defaults to T.
+        /// @param aggregation The aggregation pipeline to execute.
+        /// @param options The aggregation options.
+        /// @param session An optional session to use for the operation.
+        /// @return A std::vector of the aggregation results.
+        template <typename ResultType = T>
+        std::vector<ResultType>
+        aggregate(const Aggregation &aggregation, const AggregateOptions &options,
+                  std::optional<std::reference_wrapper<mongocxx::client_session>> session = std::nullopt)
+        {
+            static_assert(std::is_base_of_v<Document, ResultType>, "ResultType must be a subclass of QDB::Document");
+
+            auto timer = _metrics.time(OperationKind::kAggregate);
+
+            auto fetch = [&]
+            {
+                std::vector<ResultType> results;
+                try
+                {
+                    timer.encoded(aggregation.to_mongocxx().view_array().length());
+                    mongocxx::cursor cursor = session ? _collection_handle.aggregate(session->get(), aggregation.to_mongocxx(),
+                                                                                     options.to_mongocxx())
+                                                      : _collection_handle.aggregate(aggregation.to_mongocxx(),
+                                                                                     options.to_mongocxx());
+                    if (auto config = stream_config(options); config.background())
+                    {
+                        collect(ResultStream<ResultType>(std::move(cursor), config), results);
+                        return results;
+                    }
+                    for (const auto &view : cursor)
+                    {
+                        results.push_back(timer.decode(view, [&] { return from_bson_doc<ResultType>(view); }));
+                    }
+                }
+                catch (const std::exception &e)
+                {
+                    throw QDB::Exception("Failed to execute aggregation: " + std::string(e.what()));
+                }
+                return results;
+            };
+            if constexpr (std::is_copy_constructible_v<ResultType>)
+            {
+                // AggregateOptions only tune delivery, so they are not part of the key.
+                if (_result_cache && !session)
+                {
+                    auto results = _result_cache->get_or_compute<std::vector<ResultType>>(
+                        _result_scope, "aggregate:" + aggregation.canonical(), fetch);
+                    timer.documents(results.size());
+                    return results;
+                }
+            }
+            auto results = fetch();
+            timer.documents(results.size());
+            return results;
+        }
+
+        /// @brief Executes an aggregation pipeline and returns the results as a single-pass stream.
+        ///
+        /// Results are decoded one at a time as the stream is iterated; see find_stream().
+        /// @tparam ResultType The Document subclass to decode each result into. Defaults to T.
+        /// @param aggregation The aggregation pipeline to execute.
+        /// @param options The aggregation options (e.g., batch_size, allow_disk_use).
+        /// @param session An optional session to use for the operation.
+        /// @return A ResultStream of results. It must not outlive this collection.
+        template <typename ResultType = T>
+        ResultStream<ResultType>
+        aggregate_stream(const Aggregation &aggregation, const AggregateOptions &options = AggregateOptions{},
+                         std::optional<std::reference_wrapper<mongocxx::client_session>> session = std::nullopt)
+        {
+            static_assert(std::is_base_of_v<Document, ResultType>, "ResultType must be a subclass of QDB::Document");
+
+            auto timer = _metrics.time(OperationKind::kAggregateStream);
+
+            try
+            {
+                timer.encoded(aggregation.to_mongocxx().view_array().length());
+                return ResultStream<ResultType>(
+                    session ? _collection_handle.aggregate(session->get(), aggregation.to_mongocxx(), options.to_mongocxx())
+                            : _collection_handle.aggregate(aggregation.to_mongocxx(), options.to_mongocxx()),
+                    stream_config(options));
+            }
+            catch (const std::exception &e)
+            {
+                throw QDB::Exception("Failed to open aggregation stream: " + std::string(e.what()));
+            }
+        }
+
+        /// @brief Creates a BulkWriter that queues mixed operations and sends them in as few round trips as
+        /// possible.
+        ///
+        /// Each execute() invalidates this handle's caches like the single-document writes do: documents
+        /// changed by id are evicted from the DocumentCache, which is cleared after writes through any other
+        /// filter, and the collection's ResultCache scope is dropped.
+        /// @param options Ordering and batch-splitting options.
+        /// @return A BulkWriter for this collection. It must not outlive this collection.
+        BulkWriter<T> bulk_writer(const BulkWriteOptions &options = BulkWriteOptions{}) const
+        {
+            BulkWriter<T> writer(_collection_handle, options, _metrics);
+            if (_cache || _result_cache)
+            {
+                writer.with_invalidation(
+                    [cache = _cache, result_cache = _result_cache, scope = _result_scope](const BulkWriteChanges &changes)
+                    {
+                        if (result_cache)
                         {
-                            doc._id = element.get_oid().value;
+                            result_cache->invalidate(scope);
                         }
-                        else
+                        if (!cache)
                         {
-                            fields[key] = fromBsonElement(element);
+                            return;
                         }
-                    }
-                    doc.from_fields(fields);
-                    results.push_back(doc);
-                }
+                        if (changes.by_filter)
+                        {
+                            cache->clear();
+                            return;
+                        }
+                        for (const auto &id : changes.ids)
+                        {
+                            cache->invalidate(id);
+                        }
+                    });
+            }
+            return writer;
+        }
+
+        /// @brief Opens a change stream on the collection.
+        ///
+        /// Change streams need a replica set or sharded cluster.
+        /// @param options Full document mode, resume token, batch size and await time.
+        /// @return A stream of typed events. It must not outlive this collection.
+        /// @throws QDB::Exception if the driver rejects the pipeline or options. Server errors, such as a
+        /// standalone server that does not support change streams, are thrown by the first next_batch().
+        ChangeStream<T> watch(const ChangeStreamOptions &options = ChangeStreamOptions{})
+        {
+            return watch(Aggregation{}, options);
+        }
+
+        /// @brief Opens a change stream on the collection, filtered or reshaped by a pipeline.
+        /// @param pipeline Stages applied to the events, e.g. `Aggregation().match(...)` on `operationType`.
+        /// @param options Full document mode, resume token, batch size and await time.
+        /// @return A stream of typed events. It must not outlive this collection.
+        /// @throws QDB::Exception if the driver rejects the pipeline or options. Server errors, such as a
+        /// standalone server that does not support change streams, are thrown by the first next_batch().
+        ChangeStream<T> watch(const Aggregation &pipeline, const ChangeStreamOptions &options = ChangeStreamOptions{})
+        {
+            auto timer = _metrics.time(OperationKind::kWatch);
+            try
+            {
+                timer.encoded(pipeline.to_mongocxx().view_array().length());
+                return ChangeStream<T>(_collection_handle.watch(pipeline.to_mongocxx(), options.to_mongocxx()));
             }
             catch (const std::exception &e)
             {
-                throw QDB::Exception("Failed to execute aggregation: " + std::string(e.what()));
+                throw QDB::Exception("Failed to open change stream: " + std::string(e.what()));
             }
-            return results;
         }
 
         /// @brief Finds a single document and updates it in one atomic operation.
@@ -417,10 +909,11 @@ namespace QDB
                             const FindAndModifyOptions &options = FindAndModifyOptions{},
                             std::optional<std::reference_wrapper<mongocxx::client_session>> session = std::nullopt)
         {
+            auto timer = _metrics.time(OperationKind::kFindOneAndUpdate);
             try
             {
-                auto filter = to_bson_doc(query.get_fields());
-                auto update_doc = to_bson_doc(update.get_fields());
+                auto filter = timer.encode([&] { return to_bson_doc(query.get_fields()); });
+                auto update_doc = timer.encode([&] { return to_bson_doc(update.get_fields()); });
 
                 mongocxx::options::find_one_and_update mongocxx_opts{};
                 if (!options._sort_builder.view().empty())
@@ -453,15 +946,18 @@ namespace QDB
                 {
                     result = _collection_handle.find_one_and_update(filter.view(), update_doc.view(), mongocxx_opts);
                 }
+                invalidate_cached(query);
 
                 if (result)
                 {
-                    return from_bson_doc(result->view());
+                    timer.documents(1);
+                    return timer.decode(result->view(), [&] { return from_bson_doc(result->view()); });
                 }
                 return std::nullopt;
             }
             catch (const std::exception &e)
             {
+                invalidate_cached(query);
                 throw QDB::Exception("find_one_and_update failed: " + std::string(e.what()));
             }
         }
@@ -478,10 +974,11 @@ namespace QDB
                              const FindAndModifyOptions &options = FindAndModifyOptions{},
                              std::optional<std::reference_wrapper<mongocxx::client_session>> session = std::nullopt)
         {
+            auto timer = _metrics.time(OperationKind::kFindOneAndReplace);
             try
             {
-                auto filter = to_bson_doc(query.get_fields());
-                auto replacement_doc = to_bson_doc(replacement.to_fields());
+                auto filter = timer.encode([&] { return to_bson_doc(query.get_fields()); });
+                auto replacement_doc = timer.encode([&] { return to_bson_doc(replacement); });
 
                 mongocxx::options::find_one_and_replace mongocxx_opts{};
                 if (!options._sort_builder.view().empty())
@@ -514,15 +1011,18 @@ namespace QDB
                 {
                     result = _collection_handle.find_one_and_replace(filter.view(), replacement_doc.view(), mongocxx_opts);
                 }
+                invalidate_cached(query);
 
                 if (result)
                 {
-                    return from_bson_doc(result->view());
+                    timer.documents(1);
+                    return timer.decode(result->view(), [&] { return from_bson_doc(result->view()); });
                 }
                 return std::nullopt;
             }
             catch (const std::exception &e)
             {
+                invalidate_cached(query);
                 throw QDB::Exception("find_one_and_replace failed: " + std::string(e.what()));
             }
         }
@@ -536,9 +1036,10 @@ namespace QDB
         find_one_and_delete(const Query &query, const FindAndModifyOptions &options = FindAndModifyOptions{},
                             std::optional<std::reference_wrapper<mongocxx::client_session>> session = std::nullopt)
         {
+            auto timer = _metrics.time(OperationKind::kFindOneAndDelete);
             try
             {
-                auto filter = to_bson_doc(query.get_fields());
+                auto filter = timer.encode([&] { return to_bson_doc(query.get_fields()); });
 
                 mongocxx::options::find_one_and_delete mongocxx_opts{};
                 if (!options._sort_builder.view().empty())
@@ -559,15 +1060,18 @@ namespace QDB
                 {
                     result = _collection_handle.find_one_and_delete(filter.view(), mongocxx_opts);
                 }
+                invalidate_cached(query);
 
                 if (result)
                 {
-                    return from_bson_doc(result->view());
+                    timer.documents(1);
+                    return timer.decode(result->view(), [&] { return from_bson_doc(result->view()); });
                 }
                 return std::nullopt;
             }
             catch (const std::exception &e)
             {
+                invalidate_cached(query);
                 throw QDB::Exception("find_one_and_delete failed: " + std::string(e.what()));
             }
         }
@@ -581,6 +1085,7 @@ namespace QDB
         /// @return The name of the created index.
         std::string create_index(const std::string &field, bool ascending = true, bool unique = false)
         {
+            auto timer = _metrics.time(OperationKind::kCreateIndex);
             try
             {
                 bsoncxx::builder::basic::document keys;
@@ -610,6 +1115,7 @@ namespace QDB
         /// @return The name of the created index.
         std::string create_compound_index(const std::vector<std::pair<std::string, bool>> &fields)
         {
+            auto timer = _metrics.time(OperationKind::kCreateIndex);
             if (fields.empty())
             {
                 throw QDB::Exception("Cannot create a compound index with no fields.");
@@ -648,6 +1154,7 @@ namespace QDB
         /// @return The name of the created index.
         std::string create_text_index(const std::vector<std::string> &fields)
         {
+            auto timer = _metrics.time(OperationKind::kCreateIndex);
             if (fields.empty())
             {
                 throw QDB::Exception("Cannot create a text index with no fields.");
@@ -676,6 +1183,7 @@ namespace QDB
         /// @param index_name The name of the index to drop.
         void drop_index(const std::string &index_name)
         {
+            auto timer = _metrics.time(OperationKind::kDropIndex);
             try
             {
                 _collection_handle.indexes().drop_one(index_name);
@@ -690,6 +1198,7 @@ namespace QDB
         /// @return A vector of strings, where each string is an index name.
         std::vector<std::string> list_indexes()
         {
+            auto timer = _metrics.time(OperationKind::kListIndexes);
             std::vector<std::string> index_names;
             try
             {
@@ -710,10 +1219,38 @@ namespace QDB
         }
 
     private:
-        /// @brief Converts a map of FieldValues to a BSON document.
+        /// @brief Evicts the cached documents and results a write with this filter may have changed.
+        void invalidate_cached(const Query &filter)
+        {
+            invalidate_results();
+            if (!_cache)
+            {
+                return;
+            }
+            if (auto id = filter.id_value())
+            {
+                _cache->invalidate(*id);
+            }
+            else
+            {
+                _cache->clear();
+            }
+        }
+
+        /// @brief Drops the cached results of this collection after a write.
+        void invalidate_results()
+        {
+            if (_result_cache)
+            {
+                _result_cache->invalidate(_result_scope);
+            }
+        }
+
+        /// @brief Converts an ordered map of FieldValues (a Query or Update document) to a BSON document.
+        /// Keys are emitted in insertion order.
         /// @param fields The map of fields to convert.
         /// @return The BSON document value.
-        bsoncxx::document::value to_bson_doc(const std::unordered_map<std::string, FieldValue> &fields) const
+        bsoncxx::document::value to_bson_doc(const FieldMap &fields) const
         {
             bsoncxx::builder::basic::document builder;
             for (const auto &[key, value] : fields)
@@ -723,33 +1260,119 @@ namespace QDB
             return builder.extract();
         }
 
-        /// @brief Converts a BSON document view to a document of type T.
-        /// @param view The BSON document view to convert.
-        /// @return The deserialized document object.
-        T from_bson_doc(const bsoncxx::document::view &view) const
+        /// @brief Converts a document to BSON through its to_bson() writer.
+        /// For QDB::Model types this encodes members directly, without building a FieldValue map.
+        /// @param doc The document to convert.
+        /// @return The BSON document value.
+        bsoncxx::document::value to_bson_doc(const T &doc) const
+        {
+            bsoncxx::builder::basic::document builder;
+            doc.to_bson(builder);
+            return builder.extract();
+        }
+
+        /// @brief Converts a document to BSON with its existing `_id` as the first field.
+        ///
+        /// The id is created when the document is constructed, so every attempt to insert the same document
+        /// sends the same id.
+        /// @param doc The document to convert.
+        /// @return The BSON document value.
+        bsoncxx::document::value to_bson_doc_with_id(const T &doc) const
+        {
+            bsoncxx::builder::basic::document builder;
+            builder.append(bsoncxx::builder::basic::kvp("_id", doc._id));
+            doc.to_bson(builder);
+            return builder.extract();
+        }
+
+        /// @brief Converts FindOptions to driver options, applying the schema projection when requested.
+        /// @param options The find options supplied by the caller.
+        /// @return The configured mongocxx::options::find object.
+        mongocxx::options::find find_options(const FindOptions &options) const
         {
-            T doc;
-            std::unordered_map<std::string, FieldValue> fields;
-            for (const auto &element : view)
+            auto opts = options.to_mongocxx();
+            if constexpr (has_schema_projection<T>::value)
             {
-                if (element.key() == "_id")
-                {
-                    doc._id = element.get_oid().value;
-                }
-                else
+                if (options.uses_schema_projection() && !options.has_projection())
                 {
-                    fields[static_cast<std::string>(element.key())] = fromBsonElement(element);
+                    // The cached projection lives for the whole program, so the view stays valid.
+                    opts.projection(T::schema_projection().view());
                 }
             }
-            doc.from_fields(fields);
+            return opts;
+        }
+
+        /// @brief Builds the ResultStream configuration for find or aggregate options.
+        /// Prefetched chunks follow the cursor batch size, so one chunk is decoded per getMore.
+        template <typename Options> static StreamConfig stream_config(const Options &options)
+        {
+            StreamConfig config;
+            config.prefetch_depth = options.prefetch_depth();
+            config.decode_threads = options.get_decode_threads();
+            if (auto batch = options.get_batch_size(); batch && *batch > 0)
+            {
+                config.chunk_size = static_cast<std::size_t>(*batch);
+            }
+            else if (config.decode_threads > 1)
+            {
+                // Larger chunks amortise the hand-off to the decode pool.
+                config.chunk_size = 1000;
+            }
+            return config;
+        }
+
+        /// @brief Drains a stream into a vector, moving each decoded document.
+        template <typename ResultType>
+        static void collect(ResultStream<ResultType> stream, std::vector<ResultType> &results)
+        {
+            for (auto &doc : stream)
+            {
+                results.push_back(std::move(doc));
+            }
+        }
+
+        /// @brief Converts a BSON document view to a document of type ResultType.
+        /// An ObjectId `_id` is stored on the document; all other elements are decoded by from_bson(),
+        /// which reads QDB::Model members straight from the view.
+        /// @tparam ResultType The Document subclass to decode into. Defaults to T.
+        /// @param view The BSON document view to convert.
+        /// @return The deserialized document object.
+        template <typename ResultType = T> ResultType from_bson_doc(const bsoncxx::document::view &view) const
+        {
+            ResultType doc;
+            decode_into(view, doc);
             return doc;
         }
 
+        /// @brief Decodes a BSON document view into an existing document (e.g. one constructed with an allocator).
+        /// @param view The BSON document view to convert.
+        /// @param doc The document to populate.
+        template <typename ResultType> void decode_into(const bsoncxx::document::view &view, ResultType &doc) const
+        {
+            if (auto id = view["_id"]; id && id.type() == bsoncxx::type::k_oid)
+            {
+                doc._id = id.get_oid().value;
+            }
+            doc.from_bson(view);
+        }
+
     private:
         /// @brief This unique_ptr owns the client connection, keeping it alive.
         std::unique_ptr<mongocxx::pool::entry> _client_entry;
 
         /// @brief The collection handle itself. It is dependent on the client from _client_entry.
         mongocxx::collection _collection_handle;
+
+        /// @brief The read-through cache for lookups by id, if attached.
+        std::shared_ptr<DocumentCache<T>> _cache;
+
+        /// @brief The result cache for find_many(), count_documents() and aggregate(), if attached.
+        std::shared_ptr<ResultCache> _result_cache;
+
+        /// @brief The scope this collection's results are cached under.
+        std::string _result_scope;
+
+        /// @brief Where calls are recorded. Disabled unless attached.
+        CollectionMetrics _metrics;
     };
 } // namespace QDB
\ No newline at end of file
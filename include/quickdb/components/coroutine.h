@@ -0,0 +1,239 @@
+#pragma once
+
+// C++20 coroutine support. This header is empty unless the translation unit is compiled with coroutine
+// support (e.g. -std=c++20), so the C++17 library and its consumers can include it unconditionally.
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#define QDB_HAS_COROUTINES 1
+
+#include "quickdb/components/exception.h"
+#include "quickdb/components/executor.h"
+#include "quickdb/components/shared_collection.h"
+
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace QDB
+{
+    /// @brief Schedules the continuation of a suspended coroutine.
+    ///
+    /// It is called from a worker thread with a callable that resumes the coroutine, and it should hand that
+    /// callable to the caller's event loop (e.g. `[&loop](auto resume) { loop.post(std::move(resume)); }`).
+    /// It must not throw. An empty ResumeExecutor resumes the coroutine directly on the worker thread.
+    using ResumeExecutor = std::function<void(std::function<void()>)>;
+
+    /// @brief An awaitable that runs one blocking driver call on a worker pool.
+    ///
+    /// `co_await` suspends the coroutine and posts the call to the worker Executor. When the call
+    /// finishes, the coroutine is resumed through the ResumeExecutor with the call's result, or the call's
+    /// exception is rethrown from the `co_await` expression. The calling thread is never blocked.
+    /// @tparam R The result type of the call.
+    template <typename R> class [[nodiscard]] Awaitable
+    {
+    public:
+        /// @brief Constructs an awaitable. The call does not start until the awaitable is awaited.
+        /// @param worker The Executor that runs the call. Must outlive the awaitable.
+        /// @param work The blocking call.
+        /// @param resume Where the awaiting coroutine is resumed.
+        Awaitable(Executor &worker, std::function<R()> work, ResumeExecutor resume)
+            : _worker(&worker), _work(std::move(work)), _resume(std::move(resume))
+        {
+        }
+
+        /// @brief Always suspends: the call never runs on the awaiting thread.
+        bool await_ready() const noexcept { return false; }
+
+        /// @brief Posts the call to the worker pool.
+        /// @param handle The suspended coroutine.
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            // The coroutine may be resumed, and this awaitable destroyed, before post() returns, so
+            // nothing may touch `this` after posting.
+            _worker->post(
+                [this, handle]
+                {
+                    try
+                    {
+                        if constexpr (std::is_void_v<R>)
+                        {
+                            _work();
+                        }
+                        else
+                        {
+                            _result.template emplace<1>(_work());
+                        }
+                    }
+                    catch (...)
+                    {
+                        _result.template emplace<2>(std::current_exception());
+                    }
+                    if (_resume)
+                    {
+                        // The coroutine may resume, and destroy this awaitable, before the executor returns.
+                        ResumeExecutor resume = std::move(_resume);
+                        resume([handle] { handle.resume(); });
+                    }
+                    else
+                    {
+                        handle.resume();
+                    }
+                });
+        }
+
+        /// @brief Returns the call's result or rethrows its exception.
+        R await_resume()
+        {
+            if (_result.index() == 2)
+            {
+                std::rethrow_exception(std::get<2>(_result));
+            }
+            if constexpr (!std::is_void_v<R>)
+            {
+                return std::move(std::get<1>(_result));
+            }
+        }
+
+    private:
+        using Value = std::conditional_t<std::is_void_v<R>, std::monostate, R>;
+
+        Executor *_worker;
+        std::function<R()> _work;
+        ResumeExecutor _resume;
+        std::variant<std::monostate, Value, std::exception_ptr> _result;
+    };
+
+    /// @brief A collection handle with `co_await`-able operations for coroutine-based services.
+    ///
+    /// Each operation returns an Awaitable. Awaiting it runs the call on the Database's Executor with a
+    /// leased client, the same way the SharedCollection `*_async` methods do, and resumes the coroutine on
+    /// the caller-supplied ResumeExecutor. A reactor thread therefore never blocks on the driver.
+    /// Like SharedCollection, the handle is copyable and the Database must outlive it.
+    ///
+    /// @code
+    /// QDB::AwaitableCollection<User> users(db.get_shared_collection<User>("app", "users"),
+    ///                                      [&loop](auto resume) { loop.post(std::move(resume)); });
+    /// std::optional<User> user = co_await users.find_one(QDB::Query::by_id(id));
+    /// @endcode
+    /// @tparam T A class that inherits from QDB::Document.
+    template <typename T> class AwaitableCollection
+    {
+    public:
+        /// @brief Constructs an awaitable handle.
+        /// @param collection A shared handle obtained from Database::get_shared_collection.
+        /// @param resume Where awaiting coroutines are resumed. Empty resumes them on the worker thread.
+        /// @throws QDB::Exception if the handle has no executor.
+        explicit AwaitableCollection(SharedCollection<T> collection, ResumeExecutor resume = ResumeExecutor{})
+            : _collection(std::move(collection)), _resume(std::move(resume))
+        {
+            if (_collection.executor() == nullptr)
+            {
+                throw QDB::Exception("Collection handle '" + _collection.collection_name() +
+                                     "' has no executor for awaitable operations");
+            }
+        }
+
+        /// @brief Gets the underlying shared handle.
+        const SharedCollection<T> &shared() const { return _collection; }
+
+        /// @brief Awaitable version of Collection::create_one(). `doc` must outlive the co_await.
+        Awaitable<int64_t> create_one(T &doc, InsertOptions options = InsertOptions{}) const
+        {
+            return run([&doc, options](Collection<T> &collection) { return collection.create_one(doc, options); });
+        }
+
+        /// @brief Awaitable version of Collection::create_many(). `docs` must outlive the co_await.
+        Awaitable<int64_t> create_many(std::vector<T> &docs, InsertOptions options = InsertOptions{}) const
+        {
+            return run([&docs, options](Collection<T> &collection) { return collection.create_many(docs, options); });
+        }
+
+        /// @brief Awaitable version of Collection::find_one().
+        Awaitable<std::optional<T>> find_one(Query query, FindOptions options = FindOptions{}) const
+        {
+            return run([query = std::move(query), options = std::move(options)](Collection<T> &collection)
+                       { return collection.find_one(query, options); });
+        }
+
+        /// @brief Awaitable version of Collection::find_many().
+        Awaitable<std::vector<T>> find_many(Query query, FindOptions options = FindOptions{}) const
+        {
+            return run([query = std::move(query), options = std::move(options)](Collection<T> &collection)
+                       { return collection.find_many(query, options); });
+        }
+
+        /// @brief Awaitable version of Collection::update_one().
+        Awaitable<int64_t> update_one(Query filter_query, Update update_doc,
+                                      UpdateOptions options = UpdateOptions{}) const
+        {
+            return run([filter_query = std::move(filter_query), update_doc = std::move(update_doc),
+                        options](Collection<T> &collection)
+                       { return collection.update_one(filter_query, update_doc, options); });
+        }
+
+        /// @brief Awaitable version of Collection::update_many().
+        Awaitable<int64_t> update_many(Query filter_query, Update update_doc,
+                                       UpdateOptions options = UpdateOptions{}) const
+        {
+            return run([filter_query = std::move(filter_query), update_doc = std::move(update_doc),
+                        options](Collection<T> &collection)
+                       { return collection.update_many(filter_query, update_doc, options); });
+        }
+
+        /// @brief Awaitable version of Collection::delete_one().
+        Awaitable<int64_t> delete_one(Query query) const
+        {
+            return run([query = std::move(query)](Collection<T> &collection) { return collection.delete_one(query); });
+        }
+
+        /// @brief Awaitable version of Collection::delete_many().
+        Awaitable<int64_t> delete_many(Query query) const
+        {
+            return run([query = std::move(query)](Collection<T> &collection) { return collection.delete_many(query); });
+        }
+
+        /// @brief Awaitable version of Collection::count_documents().
+        Awaitable<int64_t> count_documents(Query query = Query{}) const
+        {
+            return run([query = std::move(query)](Collection<T> &collection)
+                       { return collection.count_documents(query); });
+        }
+
+        /// @brief Awaitable version of Collection::aggregate().
+        template <typename ResultType = T>
+        Awaitable<std::vector<ResultType>> aggregate(Aggregation aggregation,
+                                                     AggregateOptions options = AggregateOptions{}) const
+        {
+            return run([aggregation = std::move(aggregation), options](Collection<T> &collection)
+                       { return collection.template aggregate<ResultType>(aggregation, options); });
+        }
+
+        /// @brief Awaits an arbitrary sequence of calls on one leased connection.
+        /// @param operation A copyable callable taking `Collection<T>&`.
+        template <typename Operation>
+        Awaitable<std::invoke_result_t<Operation &, Collection<T> &>> run(Operation operation) const
+        {
+            using Result = std::invoke_result_t<Operation &, Collection<T> &>;
+            return Awaitable<Result>(*_collection.executor(),
+                                     [collection = _collection, operation = std::move(operation)]() mutable -> Result
+                                     {
+                                         Collection<T> leased = collection.lease();
+                                         return operation(leased);
+                                     },
+                                     _resume);
+        }
+
+    private:
+        SharedCollection<T> _collection;
+        ResumeExecutor _resume;
+    };
+} // namespace QDB
+
+#endif
@@ -0,0 +1,563 @@
+#pragma once
+
+#include "quickdb/components/document.h"
+#include "quickdb/components/exception.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <bsoncxx/document/value.hpp>
+#include <bsoncxx/document/view.hpp>
+#include <mongocxx/cursor.hpp>
+
+namespace QDB
+{
+    /// @brief How a ResultStream reads its cursor.
+    struct StreamConfig
+    {
+        /// @brief The number of decoded chunks a background worker may buffer ahead of the consumer.
+        /// Zero reads and decodes on the consumer's thread.
+        std::size_t prefetch_depth = 0;
+        /// @brief The number of documents per prefetched chunk (normally the cursor batch size).
+        std::size_t chunk_size = 100;
+        /// @brief The number of threads decoding chunks in parallel. Values above one copy each batch's raw
+        /// BSON off the cursor and decode whole chunks on a worker pool, still yielding cursor order.
+        std::size_t decode_threads = 1;
+
+        /// @brief Checks whether the cursor is read on a background thread.
+        bool background() const { return prefetch_depth > 0 || decode_threads > 1; }
+    };
+
+    namespace detail
+    {
+        /// @brief A bounded, closable FIFO of chunks handed from a prefetch worker to its consumer.
+        ///
+        /// push() blocks while the queue is full, which keeps the worker at most `capacity` chunks ahead.
+        /// An error raised by the worker is delivered to the consumer once the chunks before it are drained.
+        /// @tparam Chunk The queued item (a decoded chunk, or a future for one being decoded).
+        template <typename Chunk> class ChunkQueue
+        {
+        public:
+            explicit ChunkQueue(std::size_t capacity) : _capacity(capacity == 0 ? 1 : capacity) {}
+
+            /// @brief Adds a chunk, waiting for space. Returns false if the consumer has closed the queue.
+            bool push(Chunk chunk)
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _not_full.wait(lock, [this] { return _closed || _chunks.size() < _capacity; });
+                if (_closed)
+                {
+                    return false;
+                }
+                _chunks.push_back(std::move(chunk));
+                _not_empty.notify_one();
+                return true;
+            }
+
+            /// @brief Takes the next chunk, waiting for one to arrive.
+            /// @return False once the producer has finished and every chunk has been taken.
+            /// @throws The exception reported by the producer, after the chunks queued before it.
+            bool pop(Chunk &chunk)
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _not_empty.wait(lock, [this] { return !_chunks.empty() || _finished; });
+                if (_chunks.empty())
+                {
+                    if (_error)
+                    {
+                        std::rethrow_exception(std::exchange(_error, nullptr));
+                    }
+                    return false;
+                }
+                chunk = std::move(_chunks.front());
+                _chunks.pop_front();
+                _not_full.notify_one();
+                return true;
+            }
+
+            /// @brief Marks the producer as done, optionally with an error for the consumer.
+            void finish(std::exception_ptr error = nullptr)
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _finished = true;
+                _error = std::move(error);
+                _not_empty.notify_all();
+            }
+
+            /// @brief Stops the producer: pending and future push() calls return false.
+            void close()
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _closed = true;
+                _not_full.notify_all();
+            }
+
+            /// @brief Checks whether the consumer has closed the queue.
+            bool closed() const
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _closed;
+            }
+
+        private:
+            const std::size_t _capacity;
+            mutable std::mutex _mutex;
+            std::condition_variable _not_full;
+            std::condition_variable _not_empty;
+            std::deque<Chunk> _chunks;
+            std::exception_ptr _error;
+            bool _finished = false;
+            bool _closed = false;
+        };
+    } // namespace detail
+
+    /// @brief A single-pass range over query results that decodes one document at a time.
+    ///
+    /// Unlike find_many(), which collects the whole cursor into a std::vector, a ResultStream keeps only
+    /// the current document in memory and hands out the first result as soon as the first batch arrives.
+    /// Further batches are fetched from the server (getMore) as iteration advances. The stream must not
+    /// outlive the Collection that created it.
+    ///
+    /// With a non-zero StreamConfig::prefetch_depth, a background thread reads the cursor and decodes
+    /// chunks of documents while the consumer works through earlier ones, so network waits overlap with
+    /// processing. The worker stays at most `prefetch_depth` chunks ahead. With StreamConfig::decode_threads
+    /// above one, the worker only copies raw batches off the cursor and a pool of threads decodes them in
+    /// parallel; chunks are still handed out in cursor order. While such a stream is open,
+    /// the collection that created it must not be used for other operations, because the worker is
+    /// using the collection's connection.
+    /// @tparam T The document type (a subclass of QDB::Document) to decode into.
+    template <typename T> class ResultStream
+    {
+    public:
+        /// @brief An input iterator over the decoded documents of a ResultStream.
+        class iterator
+        {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = T *;
+            using reference = T &;
+
+            iterator() = default;
+
+            /// @brief Gets the current document. It is replaced when the iterator is advanced.
+            reference operator*() const { return *_stream->_current; }
+            pointer operator->() const { return _stream->_current; }
+
+            /// @brief Moves to the next document, fetching (or waiting for) the next batch if needed.
+            iterator &operator++()
+            {
+                _stream->advance();
+                if (!_stream->_current)
+                {
+                    _stream = nullptr;
+                }
+                return *this;
+            }
+            void operator++(int) { ++*this; }
+
+            friend bool operator==(const iterator &lhs, const iterator &rhs) { return lhs._stream == rhs._stream; }
+            friend bool operator!=(const iterator &lhs, const iterator &rhs) { return !(lhs == rhs); }
+
+        private:
+            friend class ResultStream;
+            explicit iterator(ResultStream *stream) : _stream(stream) {}
+
+            /// @brief The stream being iterated, or nullptr for the end iterator.
+            ResultStream *_stream = nullptr;
+        };
+
+        /// @brief Constructs a stream over an open driver cursor.
+        /// @param cursor The cursor returned by a find or aggregate call.
+        /// @param config Whether and how far to prefetch in the background.
+        explicit ResultStream(mongocxx::cursor cursor, const StreamConfig &config = StreamConfig{})
+            : _config(config), _cursor(std::make_unique<mongocxx::cursor>(std::move(cursor)))
+        {
+        }
+
+        ResultStream(ResultStream &&) noexcept = default;
+        ResultStream &operator=(ResultStream &&) noexcept = default;
+        ResultStream(const ResultStream &) = delete;
+        ResultStream &operator=(const ResultStream &) = delete;
+
+        /// @brief Starts iteration and decodes the first document.
+        ///
+        /// The stream is single-pass: calling begin() again returns an iterator at the current position.
+        /// @throws QDB::Exception if reading from the server or decoding fails.
+        iterator begin()
+        {
+            if (!_started)
+            {
+                _started = true;
+                if (_config.background())
+                {
+                    _prefetcher = std::make_unique<Prefetcher>(std::move(_cursor), _config);
+                    next_chunk();
+                }
+                else
+                {
+                    try
+                    {
+                        _position = _cursor->begin();
+                    }
+                    catch (const std::exception &e)
+                    {
+                        throw QDB::Exception("Failed to read from cursor: " + std::string(e.what()));
+                    }
+                    decode_current();
+                }
+            }
+            return _current ? iterator(this) : iterator();
+        }
+
+        /// @brief Gets the end iterator.
+        iterator end() { return iterator(); }
+
+    private:
+        /// @brief Decodes a BSON view into a document, storing an ObjectId `_id` first.
+        static void decode(const bsoncxx::document::view &view, T &doc)
+        {
+            if (auto id = view["_id"]; id && id.type() == bsoncxx::type::k_oid)
+            {
+                doc._id = id.get_oid().value;
+            }
+            doc.from_bson(view);
+        }
+
+        /// @brief A fixed set of threads that decode raw chunks for a Prefetcher.
+        class DecodePool
+        {
+        public:
+            using Task = std::packaged_task<std::vector<T>()>;
+
+            explicit DecodePool(std::size_t threads)
+            {
+                _threads.reserve(threads);
+                for (std::size_t i = 0; i < threads; ++i)
+                {
+                    _threads.emplace_back([this] { run(); });
+                }
+            }
+
+            /// @brief Stops the threads once their current task is done. Tasks not yet started are dropped.
+            ~DecodePool()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _stopping = true;
+                }
+                _ready.notify_all();
+                for (auto &thread : _threads)
+                {
+                    thread.join();
+                }
+            }
+
+            DecodePool(const DecodePool &) = delete;
+            DecodePool &operator=(const DecodePool &) = delete;
+
+            /// @brief Queues a decode task.
+            void post(Task task)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _tasks.push_back(std::move(task));
+                }
+                _ready.notify_one();
+            }
+
+        private:
+            void run()
+            {
+                for (;;)
+                {
+                    Task task;
+                    {
+                        std::unique_lock<std::mutex> lock(_mutex);
+                        _ready.wait(lock, [this] { return _stopping || !_tasks.empty(); });
+                        if (_stopping)
+                        {
+                            return;
+                        }
+                        task = std::move(_tasks.front());
+                        _tasks.pop_front();
+                    }
+                    // Exceptions are stored in the task's future.
+                    task();
+                }
+            }
+
+            std::mutex _mutex;
+            std::condition_variable _ready;
+            std::deque<Task> _tasks;
+            bool _stopping = false;
+            std::vector<std::thread> _threads;
+        };
+
+        /// @brief Owns the cursor and the worker thread that reads it ahead of the consumer.
+        ///
+        /// Chunks travel through the queue as futures, in cursor order. Without a decode pool the worker
+        /// decodes each chunk itself and queues a ready future; with one, it queues the future of a pool task.
+        class Prefetcher
+        {
+        public:
+            Prefetcher(std::unique_ptr<mongocxx::cursor> cursor, const StreamConfig &config)
+                : _cursor(std::move(cursor)),
+                  _pool(config.decode_threads > 1 ? std::make_unique<DecodePool>(config.decode_threads) : nullptr),
+                  _queue(config.prefetch_depth + (_pool ? config.decode_threads : 0)),
+                  _worker([this, chunk_size = config.chunk_size == 0 ? 1 : config.chunk_size] { run(chunk_size); })
+            {
+            }
+
+            /// @brief Stops the worker and waits for it. A getMore already in flight is allowed to complete.
+            ~Prefetcher()
+            {
+                _queue.close();
+                if (_worker.joinable())
+                {
+                    _worker.join();
+                }
+            }
+
+            Prefetcher(const Prefetcher &) = delete;
+            Prefetcher &operator=(const Prefetcher &) = delete;
+
+            /// @brief Takes the next decoded chunk, waiting for it to be decoded. Returns false at the end of
+            /// the cursor.
+            bool pop(std::vector<T> &chunk)
+            {
+                PendingChunk pending;
+                if (!_queue.pop(pending))
+                {
+                    return false;
+                }
+                try
+                {
+                    chunk = pending.get();
+                }
+                catch (const std::exception &e)
+                {
+                    throw QDB::Exception("Failed to decode prefetched documents: " + std::string(e.what()));
+                }
+                return true;
+            }
+
+        private:
+            using PendingChunk = std::future<std::vector<T>>;
+
+            /// @brief The worker loop: reads the cursor in chunks and queues them for the consumer.
+            void run(std::size_t chunk_size)
+            {
+                try
+                {
+                    if (_pool)
+                    {
+                        read_raw(chunk_size);
+                    }
+                    else
+                    {
+                        read_decoded(chunk_size);
+                    }
+                }
+                catch (const std::exception &e)
+                {
+                    _queue.finish(std::make_exception_ptr(
+                        QDB::Exception("Failed to prefetch documents: " + std::string(e.what()))));
+                }
+                catch (...)
+                {
+                    _queue.finish(std::current_exception());
+                }
+            }
+
+            /// @brief Decodes documents on the worker thread and queues each chunk as a ready future.
+            void read_decoded(std::size_t chunk_size)
+            {
+                std::vector<T> chunk;
+                chunk.reserve(chunk_size);
+                for (const auto &view : *_cursor)
+                {
+                    chunk.emplace_back();
+                    decode(view, chunk.back());
+                    if (chunk.size() == chunk_size)
+                    {
+                        if (!push_ready(std::move(chunk)))
+                        {
+                            return;
+                        }
+                        chunk = std::vector<T>();
+                        chunk.reserve(chunk_size);
+                    }
+                    else if (_queue.closed())
+                    {
+                        return;
+                    }
+                }
+                if (!chunk.empty() && !push_ready(std::move(chunk)))
+                {
+                    return;
+                }
+                _queue.finish();
+            }
+
+            /// @brief Copies raw documents off the cursor and hands each chunk to the decode pool.
+            void read_raw(std::size_t chunk_size)
+            {
+                std::vector<bsoncxx::document::value> raw;
+                raw.reserve(chunk_size);
+                for (const auto &view : *_cursor)
+                {
+                    raw.emplace_back(view);
+                    if (raw.size() == chunk_size)
+                    {
+                        if (!push_task(std::move(raw)))
+                        {
+                            return;
+                        }
+                        raw = std::vector<bsoncxx::document::value>();
+                        raw.reserve(chunk_size);
+                    }
+                    else if (_queue.closed())
+                    {
+                        return;
+                    }
+                }
+                if (!raw.empty() && !push_task(std::move(raw)))
+                {
+                    return;
+                }
+                _queue.finish();
+            }
+
+            bool push_ready(std::vector<T> chunk)
+            {
+                std::promise<std::vector<T>> ready;
+                ready.set_value(std::move(chunk));
+                return _queue.push(ready.get_future());
+            }
+
+            /// @brief Queues the chunk's future first, so the queue bound also limits pending decode work.
+            bool push_task(std::vector<bsoncxx::document::value> raw)
+            {
+                typename DecodePool::Task task([raw = std::move(raw)] {
+                    std::vector<T> docs(raw.size());
+                    for (std::size_t i = 0; i < raw.size(); ++i)
+                    {
+                        decode(raw[i].view(), docs[i]);
+                    }
+                    return docs;
+                });
+                if (!_queue.push(task.get_future()))
+                {
+                    return false;
+                }
+                _pool->post(std::move(task));
+                return true;
+            }
+
+            std::unique_ptr<mongocxx::cursor> _cursor;
+            /// @brief The decode threads, when decoding in parallel.
+            std::unique_ptr<DecodePool> _pool;
+            detail::ChunkQueue<PendingChunk> _queue;
+            /// @brief Declared last so the cursor, pool and queue exist before the thread starts.
+            std::thread _worker;
+        };
+
+        /// @brief Moves to the next document.
+        void advance()
+        {
+            if (_prefetcher)
+            {
+                if (++_index < _chunk.size())
+                {
+                    _current = &_chunk[_index];
+                    return;
+                }
+                next_chunk();
+                return;
+            }
+
+            try
+            {
+                ++*_position;
+            }
+            catch (const std::exception &e)
+            {
+                _current = nullptr;
+                throw QDB::Exception("Failed to read from cursor: " + std::string(e.what()));
+            }
+            decode_current();
+        }
+
+        /// @brief Replaces the current chunk with the next one from the prefetch worker.
+        void next_chunk()
+        {
+            _current = nullptr;
+            _chunk.clear();
+            _index = 0;
+            if (_prefetcher->pop(_chunk) && !_chunk.empty())
+            {
+                _current = &_chunk.front();
+            }
+        }
+
+        /// @brief Decodes the document at the current cursor position, or clears it at the end.
+        /// The document is kept in `_chunk` (reusing its storage) so it stays put when the stream is moved.
+        void decode_current()
+        {
+            _current = nullptr;
+            _chunk.clear();
+            if (*_position == _cursor->end())
+            {
+                return;
+            }
+            try
+            {
+                decode(**_position, _chunk.emplace_back());
+                _current = &_chunk.back();
+            }
+            catch (const std::exception &e)
+            {
+                _chunk.clear();
+                throw QDB::Exception("Failed to decode streamed document: " + std::string(e.what()));
+            }
+        }
+
+        /// @brief How the cursor is read.
+        StreamConfig _config;
+
+        /// @brief The driver cursor. Heap-allocated so its iterators stay valid when the stream is moved.
+        /// Handed to the Prefetcher when prefetching.
+        std::unique_ptr<mongocxx::cursor> _cursor;
+
+        /// @brief The current cursor position when reading on the consumer's thread.
+        std::optional<mongocxx::cursor::iterator> _position;
+
+        /// @brief The decoded documents being consumed (a single document when not prefetching), and the
+        /// position in them.
+        std::vector<T> _chunk;
+        std::size_t _index = 0;
+
+        /// @brief The current document, or nullptr at the end of the stream.
+        T *_current = nullptr;
+
+        /// @brief Whether begin() has been called.
+        bool _started = false;
+
+        /// @brief The background reader when prefetching. Declared last so it is stopped first.
+        std::unique_ptr<Prefetcher> _prefetcher;
+    };
+
+} // namespace QDB
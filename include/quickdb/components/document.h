@@ -12,8 +12,11 @@
 
 namespace QDB
 {
-    // forward declare the Collection class
+    // forward declare the Collection and LazyDocument classes
     template <typename T> class Collection;
+    template <typename T> class LazyDocument;
+    template <typename T> class ResultStream;
+    template <typename T> class BulkWriter;
 
     /// @brief Base class for all document models.
     class Document
@@ -29,6 +32,38 @@ namespace QDB
         /// @param fields The map of fields from the database.
         virtual void from_fields(const std::unordered_map<std::string, FieldValue> &fields) = 0;
 
+        /// @brief Writes the document's fields (excluding _id) into a BSON builder.
+        ///
+        /// The default implementation goes through to_fields(). Subclasses that can write their
+        /// members directly (such as QDB::Model) override this to skip the intermediate map.
+        /// @param builder The BSON (sub-)document builder to append to.
+        virtual void to_bson(bsoncxx::builder::basic::sub_document &builder) const
+        {
+            for (const auto &pair : to_fields())
+            {
+                QDB::AppendToDocument(builder, pair.first, pair.second);
+            }
+        }
+
+        /// @brief Populates the document from a BSON view. The `_id` element is handled by the caller.
+        ///
+        /// The default implementation decodes every element into a FieldValue map and calls from_fields().
+        /// Subclasses that can read their members directly (such as QDB::Model) override this.
+        /// @param view The BSON document returned by the database.
+        virtual void from_bson(const bsoncxx::document::view &view)
+        {
+            std::unordered_map<std::string, FieldValue> fields;
+            for (const auto &element : view)
+            {
+                if (element.key() == "_id" && element.type() == bsoncxx::type::k_oid)
+                {
+                    continue;
+                }
+                fields[static_cast<std::string>(element.key())] = QDB::fromBsonElement(element);
+            }
+            from_fields(fields);
+        }
+
         /// @brief Gets the document's ObjectId as a hex string.
         /// @return The 24-character hex string representation of the _id.
         std::string get_id_str() const { return _id.to_string(); }
@@ -50,12 +85,7 @@ namespace QDB
             builder.append(bsoncxx::builder::basic::kvp("_id", get_id()));
 
             // Add all other fields
-            auto fields = to_fields();
-            for (const auto &pair : fields)
-            {
-                // Reuse the helper logic from field.h
-                QDB::AppendToDocument(builder, pair.first, pair.second);
-            }
+            to_bson(builder);
 
             // Use the driver's native to_json functionality
             return bsoncxx::to_json(builder.view());
@@ -66,6 +96,10 @@ namespace QDB
     protected:
         friend class Collection<Document>;
         template <typename T> friend class Collection;
+        template <typename T> friend class LazyDocument;
+        template <typename T> friend class ResultStream;
+        template <typename T> friend class ChangeStream;
+        template <typename T> friend class BulkWriter;
 
         /// @brief The document's unique identifier, managed by the library.
         bsoncxx::oid _id;
@@ -99,13 +133,12 @@ namespace QDB
     /// @brief Recursively prints the content of a FieldValue.
     inline void print_field_value(const FieldValue &fv, int indent_level)
     {
-        switch (fv.type)
+        switch (fv.type())
         {
         case FieldType::FT_OBJECT:
         {
-            const auto &map = std::get<std::unordered_map<std::string, FieldValue>>(fv.value);
             std::cout << "{\n";
-            for (const auto &[key, value] : map)
+            for (const auto &[key, value] : fv.object())
             {
                 print_kv_pair(key, value, indent_level + 1);
             }
@@ -114,9 +147,8 @@ namespace QDB
         }
         case FieldType::FT_ARRAY:
         {
-            const auto &vec = std::get<std::vector<FieldValue>>(fv.value);
             std::cout << "[\n";
-            for (const auto &item : vec)
+            for (const auto &item : fv.array())
             {
                 std::cout << std::string((indent_level + 1) * 2, ' ');
                 print_field_value(item, indent_level + 1);
@@ -126,7 +158,7 @@ namespace QDB
             break;
         }
         case FieldType::FT_STRING:
-            std::cout << "\"" << fv.as<std::string>() << "\"";
+            std::cout << "\"" << fv.string_view() << "\"";
             break;
         case FieldType::FT_OBJECT_ID:
             std::cout << "ObjectId(\"" << fv.as<bsoncxx::oid>().to_string() << "\")";
@@ -0,0 +1,353 @@
+#pragma once
+
+#include "quickdb/components/options.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <bsoncxx/document/view.hpp>
+#include <bsoncxx/oid.hpp>
+#include <bsoncxx/types.hpp>
+#include <mongocxx/change_stream.hpp>
+#include <mongocxx/collection.hpp>
+#include <mongocxx/options/change_stream.hpp>
+#include <mongocxx/pool.hpp>
+
+namespace QDB
+{
+    /// @brief Counters of a DocumentCache, summed over its shards.
+    struct CacheStats
+    {
+        /// @brief Lookups served from the cache.
+        std::uint64_t hits = 0;
+        /// @brief Lookups that went to the server.
+        std::uint64_t misses = 0;
+        /// @brief Entries dropped for capacity or because they expired.
+        std::uint64_t evictions = 0;
+        /// @brief Entries dropped because their document was written or changed.
+        std::uint64_t invalidations = 0;
+        /// @brief The number of cached documents.
+        std::size_t size = 0;
+
+        /// @brief Gets the fraction of lookups served from the cache.
+        double hit_ratio() const { return hits + misses == 0 ? 0.0 : static_cast<double>(hits) / (hits + misses); }
+    };
+
+    /// @brief A sharded LRU cache of documents by `_id`, with a TTL, kept coherent by a change stream.
+    ///
+    /// Attach it with Collection::with_cache() or SharedCollection::with_cache(). find_one() with a
+    /// Query::by_id() filter is then served from the cache, and writes through those handles evict what they
+    /// may have changed. A background thread watches the collection and evicts documents updated, replaced or
+    /// deleted by any client. While that change stream is not open (e.g. on a standalone server), lookups go to
+    /// the server and nothing is cached. With CacheOptions::watch_changes(false), writes made elsewhere are
+    /// only picked up when entries expire.
+    ///
+    /// Each shard has its own lock, LRU list and counters, so lookups of different ids rarely contend. A fetched
+    /// document is only admitted if its shard saw no invalidation since the lookup missed, so a read racing a
+    /// write cannot cache the old version. The cache is thread-safe; the Database must outlive it.
+    /// @tparam T A copyable class that inherits from QDB::Document.
+    template <typename T> class DocumentCache
+    {
+    public:
+        /// @brief Constructs a cache and, unless disabled, starts watching the collection.
+        /// @param pool The pool the change stream leases its client from.
+        /// @param database_name The database name.
+        /// @param collection_name The collection name.
+        /// @param options The capacity, TTL, shard count and change stream settings.
+        DocumentCache(mongocxx::pool &pool, std::string database_name, std::string collection_name,
+                      const CacheOptions &options = CacheOptions{})
+            : _pool(&pool), _database_name(std::move(database_name)), _collection_name(std::move(collection_name)),
+              _options(options), _shards(new Shard[options.get_shards()]),
+              _shard_capacity((options.get_max_entries() + options.get_shards() - 1) / options.get_shards())
+        {
+            if (_options.watches_changes())
+            {
+                _watcher = std::thread([this] { watch(); });
+            }
+        }
+
+        /// @brief Stops the change stream.
+        ~DocumentCache()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_watch_mutex);
+                _stopping = true;
+            }
+            _wake.notify_all();
+            if (_watcher.joinable())
+            {
+                _watcher.join();
+            }
+        }
+
+        DocumentCache(const DocumentCache &) = delete;
+        DocumentCache &operator=(const DocumentCache &) = delete;
+
+        /// @brief Looks up a document.
+        /// @param id The document's ObjectId.
+        /// @param ticket On a miss, receives the value to pass to put() with the fetched document.
+        /// @return A copy of the cached document, or std::nullopt on a miss.
+        std::optional<T> get(const bsoncxx::oid &id, std::uint64_t *ticket = nullptr)
+        {
+            Shard &shard = shard_for(id);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.index.find(id);
+            if (it != shard.index.end() && it->second->expires <= std::chrono::steady_clock::now())
+            {
+                shard.lru.erase(it->second);
+                shard.index.erase(it);
+                ++shard.evictions;
+                it = shard.index.end();
+            }
+            if (it == shard.index.end())
+            {
+                ++shard.misses;
+                if (ticket != nullptr)
+                {
+                    *ticket = shard.generation;
+                }
+                return std::nullopt;
+            }
+            ++shard.hits;
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            return it->second->document;
+        }
+
+        /// @brief Caches a document fetched after a miss.
+        /// @param document The document read from the server.
+        /// @param ticket The ticket get() returned with the miss. The document is dropped if its shard was
+        /// invalidated since, or if the change stream is required but not open.
+        void put(const T &document, std::uint64_t ticket)
+        {
+            if (_shard_capacity == 0 || (_options.watches_changes() && !_watching.load()))
+            {
+                return;
+            }
+            const bsoncxx::oid id = document.get_id();
+            const auto expires = std::chrono::steady_clock::now() + _options.get_ttl();
+            Shard &shard = shard_for(id);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (shard.generation != ticket)
+            {
+                return;
+            }
+            if (auto it = shard.index.find(id); it != shard.index.end())
+            {
+                it->second->document = document;
+                it->second->expires = expires;
+                shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+                return;
+            }
+            shard.lru.push_front(Entry{id, document, expires});
+            shard.index.emplace(id, shard.lru.begin());
+            if (shard.lru.size() > _shard_capacity)
+            {
+                shard.index.erase(shard.lru.back().id);
+                shard.lru.pop_back();
+                ++shard.evictions;
+            }
+        }
+
+        /// @brief Evicts a document and rejects in-flight fetches of its shard.
+        /// @param id The document's ObjectId.
+        void invalidate(const bsoncxx::oid &id)
+        {
+            Shard &shard = shard_for(id);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            ++shard.generation;
+            if (auto it = shard.index.find(id); it != shard.index.end())
+            {
+                shard.lru.erase(it->second);
+                shard.index.erase(it);
+                ++shard.invalidations;
+            }
+        }
+
+        /// @brief Evicts every document and rejects every in-flight fetch.
+        void clear()
+        {
+            for (std::size_t i = 0; i < _options.get_shards(); ++i)
+            {
+                Shard &shard = _shards[i];
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                ++shard.generation;
+                shard.invalidations += shard.lru.size();
+                shard.index.clear();
+                shard.lru.clear();
+            }
+        }
+
+        /// @brief Gets the hit, miss and eviction counters.
+        CacheStats stats() const
+        {
+            CacheStats stats;
+            for (std::size_t i = 0; i < _options.get_shards(); ++i)
+            {
+                const Shard &shard = _shards[i];
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                stats.hits += shard.hits;
+                stats.misses += shard.misses;
+                stats.evictions += shard.evictions;
+                stats.invalidations += shard.invalidations;
+                stats.size += shard.lru.size();
+            }
+            return stats;
+        }
+
+        /// @brief Checks whether the change stream is open.
+        bool is_watching() const { return _watching.load(); }
+
+        /// @brief Gets the options the cache was created with.
+        const CacheOptions &options() const { return _options; }
+
+        /// @brief Checks whether a find_one() with these options may be served from the cache: it must return
+        /// whole documents and not skip any.
+        static bool serves(const FindOptions &options)
+        {
+            return !options.has_projection() && !options.uses_schema_projection() && !options.get_skip();
+        }
+
+    private:
+        /// @brief A cached document.
+        struct Entry
+        {
+            bsoncxx::oid id;
+            T document;
+            std::chrono::steady_clock::time_point expires;
+        };
+
+        /// @brief An independently locked part of the cache. Aligned so neighbouring locks do not share a
+        /// cache line.
+        struct alignas(64) Shard
+        {
+            mutable std::mutex mutex;
+            /// @brief Entries, most recently used first.
+            std::list<Entry> lru;
+            std::map<bsoncxx::oid, typename std::list<Entry>::iterator> index;
+            /// @brief Incremented by every invalidation, to reject fetches that raced it.
+            std::uint64_t generation = 0;
+            std::uint64_t hits = 0;
+            std::uint64_t misses = 0;
+            std::uint64_t evictions = 0;
+            std::uint64_t invalidations = 0;
+        };
+
+        /// @brief How long the change stream waits for events before checking for shutdown.
+        static constexpr std::chrono::milliseconds kPollInterval{500};
+
+        Shard &shard_for(const bsoncxx::oid &id)
+        {
+            // FNV-1a over the id bytes; the trailing counter bytes spread sequential ids across shards.
+            std::uint64_t hash = 14695981039346656037ull;
+            for (std::size_t i = 0; i < bsoncxx::oid::size(); ++i)
+            {
+                hash = (hash ^ static_cast<unsigned char>(id.bytes()[i])) * 1099511628211ull;
+            }
+            return _shards[hash % _options.get_shards()];
+        }
+
+        /// @brief The background loop: keeps a change stream open and evicts changed documents.
+        void watch()
+        {
+            std::unique_lock<std::mutex> lock(_watch_mutex);
+            while (!_stopping)
+            {
+                lock.unlock();
+                try
+                {
+                    auto client = _pool->acquire();
+                    mongocxx::collection collection = (*client)[_database_name][_collection_name];
+                    mongocxx::options::change_stream stream_options;
+                    stream_options.max_await_time(kPollInterval);
+                    mongocxx::change_stream stream = collection.watch(stream_options);
+
+                    // Documents cached before the stream opened may have missed their events.
+                    clear();
+                    _watching = true;
+                    bool open = true;
+                    while (open && !stopping())
+                    {
+                        for (const auto &event : stream)
+                        {
+                            if (!apply(event))
+                            {
+                                open = false;
+                                break;
+                            }
+                        }
+                    }
+                }
+                catch (const std::exception &)
+                {
+                    // Unsupported (standalone server) or interrupted: retry after the interval.
+                }
+                _watching = false;
+                clear();
+                lock.lock();
+                _wake.wait_for(lock, _options.get_retry_interval(), [&] { return _stopping; });
+            }
+        }
+
+        /// @brief Applies a change event.
+        /// @return False if the stream was invalidated and must be reopened.
+        bool apply(const bsoncxx::document::view &event)
+        {
+            auto operation = event["operationType"];
+            if (!operation || operation.type() != bsoncxx::type::k_string)
+            {
+                return true;
+            }
+            const auto kind = operation.get_string().value;
+            if (kind == "insert")
+            {
+                return true;
+            }
+            if (kind == "update" || kind == "replace" || kind == "delete")
+            {
+                auto id = event["documentKey"]["_id"];
+                if (id && id.type() == bsoncxx::type::k_oid)
+                {
+                    invalidate(id.get_oid().value);
+                }
+                return true;
+            }
+            // drop, rename, dropDatabase and invalidate affect every document.
+            clear();
+            return kind != "invalidate";
+        }
+
+        bool stopping()
+        {
+            std::lock_guard<std::mutex> lock(_watch_mutex);
+            return _stopping;
+        }
+
+        mongocxx::pool *_pool;
+        std::string _database_name;
+        std::string _collection_name;
+        CacheOptions _options;
+        std::unique_ptr<Shard[]> _shards;
+        /// @brief The capacity of each shard.
+        std::size_t _shard_capacity;
+
+        /// @brief Whether the change stream is open.
+        std::atomic<bool> _watching{false};
+        std::mutex _watch_mutex;
+        std::condition_variable _wake;
+        bool _stopping = false;
+        /// @brief The change stream thread. Declared last so it starts after every other member exists.
+        std::thread _watcher;
+    };
+} // namespace QDB
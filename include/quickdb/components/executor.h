@@ -0,0 +1,83 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace QDB
+{
+    /// @brief A bounded pool of worker threads that runs database tasks off the caller's thread.
+    ///
+    /// The pool owned by a Database backs the `*_async` methods of SharedCollection. Threads are started
+    /// on the first submission, so a Database that never runs async work never starts them. The task
+    /// queue is bounded: when it is full, submit() blocks the caller until a worker frees a slot, which
+    /// keeps a burst of requests from queuing unbounded work. A task submitted from one of the pool's own
+    /// workers while the queue is full runs inline instead, so nested submissions cannot deadlock.
+    class Executor
+    {
+    public:
+        /// @brief Constructs an executor.
+        /// @param threads The number of worker threads (zero picks the hardware concurrency).
+        /// @param queue_capacity The maximum number of queued tasks (zero means 1).
+        explicit Executor(std::size_t threads = 0, std::size_t queue_capacity = 1024);
+
+        /// @brief Runs every task already queued, then stops and joins the workers.
+        ~Executor();
+
+        Executor(const Executor &) = delete;
+        Executor &operator=(const Executor &) = delete;
+
+        /// @brief Queues a callable and returns a future for its result.
+        ///
+        /// Exceptions thrown by the callable are stored in the future.
+        /// @param task The callable to run on a worker thread.
+        /// @return A std::future that becomes ready when the task completes.
+        template <typename F> std::future<std::invoke_result_t<std::decay_t<F>>> submit(F &&task)
+        {
+            using Result = std::invoke_result_t<std::decay_t<F>>;
+            auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+            std::future<Result> future = packaged->get_future();
+            post([packaged] { (*packaged)(); });
+            return future;
+        }
+
+        /// @brief Queues a fire-and-forget task, waiting while the queue is full.
+        /// @param task The task to run. It must not throw.
+        void post(std::function<void()> task);
+
+        /// @brief Gets the number of worker threads.
+        std::size_t thread_count() const { return _thread_count; }
+
+        /// @brief Gets the maximum number of queued tasks.
+        std::size_t queue_capacity() const { return _queue_capacity; }
+
+    private:
+        /// @brief Starts the worker threads (once).
+        void start();
+
+        /// @brief The worker loop.
+        void run();
+
+        /// @brief Checks whether the calling thread is one of this executor's workers.
+        bool on_worker_thread() const;
+
+        const std::size_t _thread_count;
+        const std::size_t _queue_capacity;
+
+        std::once_flag _started;
+        std::mutex _mutex;
+        std::condition_variable _not_empty;
+        std::condition_variable _not_full;
+        std::deque<std::function<void()>> _tasks;
+        bool _stopping = false;
+        std::vector<std::thread> _workers;
+    };
+} // namespace QDB
@@ -1,13 +1,20 @@
 #pragma once
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <new>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <unordered_map>
 #include <variant>
 #include <vector>
 #include <map>
+#include <memory_resource>
 #include <utility>
 
 // Include MongoDB C++ driver headers for BSON building.
@@ -49,6 +56,7 @@ namespace QDB
 
     // Forward declaration for self-referential variant.
     struct FieldValue;
+    class FieldMap;
 
     // --- SFINAE DETECTORS ---
     // These helpers detect if a type has to_fields() or from_fields() methods.
@@ -72,6 +80,40 @@ namespace QDB
                                   std::declval<std::unordered_map<std::string, FieldValue>>()))>> : std::true_type
     {
     };
+
+    template <typename T, typename = void> struct has_to_bson : std::false_type
+    {
+    };
+
+    template <typename T>
+    struct has_to_bson<T, std::void_t<decltype(std::declval<const T>().to_bson(
+                              std::declval<bsoncxx::builder::basic::sub_document &>()))>> : std::true_type
+    {
+    };
+
+    template <typename T, typename = void> struct has_from_bson : std::false_type
+    {
+    };
+
+    template <typename T>
+    struct has_from_bson<T, std::void_t<decltype(std::declval<T &>().from_bson(
+                                std::declval<const bsoncxx::document::view &>()))>> : std::true_type
+    {
+    };
+
+    template <typename T, typename = void> struct has_schema_projection : std::false_type
+    {
+    };
+
+    template <typename T>
+    struct has_schema_projection<T, std::void_t<decltype(T::schema_projection())>> : std::true_type
+    {
+    };
+
+    /// @brief Helper for static_asserts in discarded `if constexpr` branches.
+    template <typename> struct dependent_false : std::false_type
+    {
+    };
     // ------------------------
 
     /// @brief Metafunction to map C++ types to FieldType enum values.
@@ -171,9 +213,8 @@ namespace QDB
     };
 
     /// @brief A std::variant type alias representing the possible C++ types a field can hold.
-    /// This variant is used by FieldValue to store the actual data.
-    /// It includes recursive types like std::vector<FieldValue> for arrays and
-    /// std::unordered_map<std::string, FieldValue> for nested objects.
+    /// FieldValue no longer stores this variant; it is accepted by the FieldValue(FieldType, FieldVariant)
+    /// constructor for code that builds values generically.
     using FieldVariant = std::variant<std::vector<FieldValue>,                    // For FT_ARRAY
                                       std::vector<uint8_t>,                       // For FT_BINARY
                                       bool,                                       // For FT_BOOLEAN
@@ -205,6 +246,14 @@ namespace QDB
     {
     };
 
+    /// @brief Type trait to check if a type is a std::basic_string<char> with any allocator (e.g. std::pmr::string).
+    template <typename> struct is_std_string : std::false_type
+    {
+    };
+    template <typename Traits, typename A> struct is_std_string<std::basic_string<char, Traits, A>> : std::true_type
+    {
+    };
+
     /// @brief Type trait to check if a type is a std::pair.
     template <typename> struct is_std_pair : std::false_type
     {
@@ -213,19 +262,233 @@ namespace QDB
     {
     };
 
+    /// @brief A contiguous range of elements stored inside a FieldValue (array items, object members or bytes).
+    /// @tparam T The element type (const-qualified for read-only access).
+    template <typename T> class FieldRange
+    {
+    public:
+        FieldRange() = default;
+        FieldRange(T *first, size_t count) : _first(first), _count(count) {}
+
+        T *begin() const { return _first; }
+        T *end() const { return _first + _count; }
+        size_t size() const { return _count; }
+        bool empty() const { return _count == 0; }
+        T &operator[](size_t index) const { return _first[index]; }
+
+    private:
+        T *_first = nullptr;
+        size_t _count = 0;
+    };
+
+    namespace detail
+    {
+        /// @brief The memory resource FieldValue heap blocks are allocated from on this thread (nullptr = operator new).
+        inline std::pmr::memory_resource *&current_field_resource()
+        {
+            thread_local std::pmr::memory_resource *resource = nullptr;
+            return resource;
+        }
+
+        /// @brief Header in front of every out-of-line FieldValue payload (long strings, binary, arrays, objects).
+        /// The elements follow the header contiguously in the same allocation.
+        struct alignas(alignof(void *)) FieldBlock
+        {
+            uint32_t size;                       ///< Number of constructed elements.
+            uint32_t capacity;                   ///< Number of elements the block can hold.
+            std::pmr::memory_resource *resource; ///< Resource the block came from, or nullptr for operator new.
+        };
+
+        template <typename Elem> Elem *block_data(FieldBlock *block) { return reinterpret_cast<Elem *>(block + 1); }
+
+        template <typename Elem> const Elem *block_data(const FieldBlock *block)
+        {
+            return reinterpret_cast<const Elem *>(block + 1);
+        }
+
+        template <typename Elem> size_t block_bytes(uint32_t capacity) { return sizeof(FieldBlock) + sizeof(Elem) * capacity; }
+
+        /// @brief Allocates an empty block with room for `capacity` elements.
+        /// @param resource The memory resource to allocate from, or nullptr for operator new.
+        template <typename Elem>
+        FieldBlock *allocate_block(uint32_t capacity, std::pmr::memory_resource *resource = current_field_resource())
+        {
+            static_assert(alignof(Elem) <= alignof(FieldBlock), "FieldBlock element is over-aligned");
+            const size_t bytes = block_bytes<Elem>(capacity);
+            void *memory = resource ? resource->allocate(bytes, alignof(FieldBlock)) : ::operator new(bytes);
+            return new (memory) FieldBlock{0, capacity, resource};
+        }
+
+        /// @brief Returns a block's memory to where it came from, without destroying elements.
+        template <typename Elem> void free_block(FieldBlock *block)
+        {
+            if (block->resource)
+            {
+                block->resource->deallocate(block, block_bytes<Elem>(block->capacity), alignof(FieldBlock));
+            }
+            else
+            {
+                ::operator delete(block);
+            }
+        }
+
+        /// @brief Destroys the elements of a block and frees it. Accepts nullptr.
+        template <typename Elem> void release_block(FieldBlock *block)
+        {
+            if (!block)
+            {
+                return;
+            }
+            if constexpr (!std::is_trivially_destructible_v<Elem>)
+            {
+                Elem *data = block_data<Elem>(block);
+                for (uint32_t i = 0; i < block->size; ++i)
+                {
+                    data[i].~Elem();
+                }
+            }
+            free_block<Elem>(block);
+        }
+
+        /// @brief Deep-copies a block into a new, exactly-sized block. Accepts nullptr.
+        template <typename Elem> FieldBlock *copy_block(const FieldBlock *source)
+        {
+            if (!source)
+            {
+                return nullptr;
+            }
+            FieldBlock *block = allocate_block<Elem>(source->size);
+            const Elem *from = block_data<Elem>(source);
+            Elem *to = block_data<Elem>(block);
+            try
+            {
+                for (; block->size < source->size; ++block->size)
+                {
+                    new (to + block->size) Elem(from[block->size]);
+                }
+            }
+            catch (...)
+            {
+                release_block<Elem>(block);
+                throw;
+            }
+            return block;
+        }
+
+        /// @brief Returns a block with room for at least `capacity` elements, moving elements if it must grow.
+        template <typename Elem> FieldBlock *reserve_block(FieldBlock *block, uint32_t capacity)
+        {
+            if (block && block->capacity >= capacity)
+            {
+                return block;
+            }
+            // A growing block stays with the resource it was first allocated from.
+            FieldBlock *grown = allocate_block<Elem>(capacity, block ? block->resource : current_field_resource());
+            if (block)
+            {
+                Elem *from = block_data<Elem>(block);
+                Elem *to = block_data<Elem>(grown);
+                for (uint32_t i = 0; i < block->size; ++i)
+                {
+                    new (to + i) Elem(std::move(from[i]));
+                    from[i].~Elem();
+                }
+                grown->size = block->size;
+                free_block<Elem>(block);
+            }
+            return grown;
+        }
+    } // namespace detail
+
+    /// @brief Routes the heap blocks of FieldValues created on this thread to a memory resource while in scope.
+    ///
+    /// Typically used with a std::pmr::monotonic_buffer_resource so a whole batch of decoded values can be
+    /// released at once. Values keep a pointer to their resource, so they must not outlive it. Object keys
+    /// longer than the std::string small-buffer size are still allocated with operator new.
+    class ScopedFieldResource
+    {
+    public:
+        /// @param resource The resource to allocate from, or nullptr to use operator new.
+        explicit ScopedFieldResource(std::pmr::memory_resource *resource) : _previous(detail::current_field_resource())
+        {
+            detail::current_field_resource() = resource;
+        }
+        ~ScopedFieldResource() { detail::current_field_resource() = _previous; }
+
+        ScopedFieldResource(const ScopedFieldResource &) = delete;
+        ScopedFieldResource &operator=(const ScopedFieldResource &) = delete;
+
+    private:
+        std::pmr::memory_resource *_previous;
+    };
+
     /// @brief Represents a BSON-like field, containing both its type and its value.
     /// This struct is used to build and parse BSON documents in a more type-safe manner
     /// before converting to/from the bsoncxx library's representations.
+    ///
+    /// The representation is compact (24 bytes): scalars, ObjectIds and strings of up to 16 bytes are stored
+    /// inline; longer strings, binary data, arrays and objects live in a single heap block each, with array
+    /// items and object members stored contiguously.
     struct FieldValue
     {
-        /// @brief Default constructor. Initializes type to an undefined state and value to default.
+        /// @brief An object member: the key and its value.
+        using Member = std::pair<std::string, FieldValue>;
+
+        /// @brief Default constructor. Initializes type to an undefined state.
         FieldValue() = default;
-        /// @brief Default destructor.
-        ~FieldValue() = default;
+        /// @brief Destructor. Frees any out-of-line storage.
+        ~FieldValue() { release(); }
+
+        /// @brief Copy constructor. Performs a deep copy.
+        FieldValue(const FieldValue &other) : _type(other._type), _small(other._small)
+        {
+            if (other.owns_block())
+            {
+                _payload.block = other.clone_block();
+            }
+            else
+            {
+                _payload = other._payload;
+            }
+        }
+
+        /// @brief Move constructor. Takes over the other value's storage and leaves it undefined.
+        FieldValue(FieldValue &&other) noexcept : _payload(other._payload), _type(other._type), _small(other._small)
+        {
+            other._type = FieldType::FT_UNDEFINED;
+            other._small = 0;
+        }
+
+        FieldValue &operator=(const FieldValue &other)
+        {
+            if (this != &other)
+            {
+                FieldValue copy(other);
+                swap(copy);
+            }
+            return *this;
+        }
+
+        FieldValue &operator=(FieldValue &&other) noexcept
+        {
+            // Moving through a temporary keeps `fv = std::move(fv.array()[0])` safe.
+            FieldValue moved(std::move(other));
+            swap(moved);
+            return *this;
+        }
+
         /// @brief Constructs a FieldValue with a specific type and value.
-        /// @param _type The FieldType of this field.
-        /// @param _val The FieldVariant holding the actual data for this field.
-        FieldValue(const FieldType &_type, const FieldVariant &_val) : type(_type), value(_val) {}
+        /// @param field_type The FieldType of this field. It is kept when it matches how the value is stored
+        ///        (e.g. FT_CODE for a string); otherwise the type implied by the value is used.
+        /// @param val The FieldVariant holding the actual data for this field.
+        FieldValue(const FieldType &field_type, const FieldVariant &val)
+        {
+            std::visit([this](const auto &alternative) { *this = FieldValue(alternative); }, val);
+            if (storage_of(field_type) == storage_of(_type))
+            {
+                _type = field_type;
+            }
+        }
 
         /// @brief Template constructor for creating a FieldValue from a raw C++ type.
         /// @tparam T The type of the value.
@@ -234,78 +497,262 @@ namespace QDB
         FieldValue(const T &val)
         {
             using DecayedT = std::decay_t<T>;
-            type = type_to_fieldtype<DecayedT>::value;
 
             if constexpr (std::is_enum_v<DecayedT>)
             {
-                value = static_cast<int32_t>(val);
+                _type = FieldType::FT_INT_32;
+                _payload.int32 = static_cast<int32_t>(val);
             }
             else if constexpr (has_to_fields<DecayedT>::value)
             {
                 // This detects nested models (QDB::Model<T> or similar) via SFINAE
-                // and serializes them into a map for storage.
-                value = val.to_fields();
+                // and serializes them into an object for storage.
+                init_object(val.to_fields());
+            }
+            else if constexpr (std::is_same_v<DecayedT, bool>)
+            {
+                _type = FieldType::FT_BOOLEAN;
+                _payload.boolean = val;
+            }
+            else if constexpr (std::is_same_v<DecayedT, int32_t>)
+            {
+                _type = FieldType::FT_INT_32;
+                _payload.int32 = val;
+            }
+            else if constexpr (std::is_same_v<DecayedT, int64_t>)
+            {
+                _type = FieldType::FT_INT_64;
+                _payload.int64 = val;
+            }
+            else if constexpr (std::is_same_v<DecayedT, double>)
+            {
+                _type = FieldType::FT_DOUBLE;
+                _payload.real = val;
+            }
+            else if constexpr (is_std_string<DecayedT>::value || std::is_same_v<DecayedT, const char *> ||
+                               std::is_same_v<DecayedT, char *>)
+            {
+                init_string(std::string_view(val), FieldType::FT_STRING);
+            }
+            else if constexpr (std::is_same_v<DecayedT, bsoncxx::oid>)
+            {
+                _type = FieldType::FT_OBJECT_ID;
+                std::memcpy(_payload.bytes, val.bytes(), bsoncxx::oid::size());
+            }
+            else if constexpr (std::is_same_v<DecayedT, bsoncxx::types::b_date>)
+            {
+                _type = FieldType::FT_DATE;
+                _payload.int64 = val.value.count();
+            }
+            else if constexpr (std::is_same_v<DecayedT, bsoncxx::types::b_timestamp>)
+            {
+                _type = FieldType::FT_TIMESTAMP;
+                _payload.words[0] = val.increment;
+                _payload.words[1] = val.timestamp;
+            }
+            else if constexpr (std::is_same_v<DecayedT, std::unordered_map<std::string, FieldValue>> ||
+                               std::is_same_v<DecayedT, FieldMap>)
+            {
+                init_object(val);
+            }
+            else if constexpr (std::is_same_v<DecayedT, std::nullptr_t>)
+            {
+                _type = FieldType::FT_NULL;
             }
             else
             {
-                value = val;
+                static_assert(dependent_false<DecayedT>::value, "Type is not supported by QDB::FieldValue");
             }
         }
 
         /// @brief Constructs a FieldValue from a std::chrono::system_clock::time_point, converting it to a b_date.
         /// @param tp The time point to store.
-        FieldValue(const std::chrono::system_clock::time_point &tp)
-            : type(FieldType::FT_DATE), value(bsoncxx::types::b_date{tp})
-        {
-        }
+        FieldValue(const std::chrono::system_clock::time_point &tp) : FieldValue(bsoncxx::types::b_date{tp}) {}
 
-        FieldValue(const std::vector<uint8_t> &vec) : type(FieldType::FT_BINARY), value(vec) {}
+        /// @brief Constructs an FT_BINARY FieldValue from a byte vector.
+        FieldValue(const std::vector<uint8_t> &vec) : FieldValue(from_binary(vec.data(), vec.size())) {}
 
         /// @brief Template constructor to automatically handle std::vector<T>.
         /// @tparam T The inner type of the vector.
         /// @param vec The vector of values.
-        template <typename T> FieldValue(const std::vector<T> &vec) : type(FieldType::FT_ARRAY)
+        template <typename T, typename A> FieldValue(const std::vector<T, A> &vec) : _type(FieldType::FT_ARRAY)
         {
-            std::vector<FieldValue> fv_vector;
-            fv_vector.reserve(vec.size());
+            reserve(vec.size());
             for (const auto &item : vec)
             {
-                if constexpr (has_to_fields<T>::value)
+                if constexpr (std::is_same_v<T, bool>)
                 {
-                    fv_vector.emplace_back(FieldType::FT_OBJECT, item.to_fields());
+                    push_back(FieldValue(static_cast<bool>(item)));
                 }
                 else
                 {
-                    fv_vector.emplace_back(item);
+                    push_back(FieldValue(item));
                 }
             }
-            value = fv_vector;
         }
 
-        template <typename T> FieldValue(const std::map<std::string, T> &map_in) : type(FieldType::FT_OBJECT)
+        template <typename T> FieldValue(const std::map<std::string, T> &map_in) : _type(FieldType::FT_OBJECT)
         {
-            std::unordered_map<std::string, FieldValue> fv_map;
+            reserve(map_in.size());
             for (const auto &[key, item] : map_in)
             {
-                if constexpr (has_to_fields<T>::value)
-                {
-                    fv_map.emplace(key, FieldValue(FieldType::FT_OBJECT, item.to_fields()));
-                }
-                else
+                emplace_member(key, FieldValue(item));
+            }
+        }
+
+        template <typename T1, typename T2> FieldValue(const std::pair<T1, T2> &pair_in) : _type(FieldType::FT_ARRAY)
+        {
+            reserve(2);
+            push_back(FieldValue(pair_in.first));
+            push_back(FieldValue(pair_in.second));
+        }
+
+        /// @brief Creates an empty FT_ARRAY value.
+        /// @param capacity The number of items to reserve room for.
+        static FieldValue make_array(size_t capacity = 0)
+        {
+            FieldValue fv;
+            fv._type = FieldType::FT_ARRAY;
+            fv.reserve(capacity);
+            return fv;
+        }
+
+        /// @brief Creates an empty FT_OBJECT value.
+        /// @param capacity The number of members to reserve room for.
+        static FieldValue make_object(size_t capacity = 0)
+        {
+            FieldValue fv;
+            fv._type = FieldType::FT_OBJECT;
+            fv.reserve(capacity);
+            return fv;
+        }
+
+        /// @brief Creates a string-typed value without going through std::string.
+        /// @param text The string contents.
+        /// @param field_type One of the string-backed types (FT_STRING, FT_CODE, FT_BSON_SYMBOL, ...).
+        static FieldValue from_string(std::string_view text, FieldType field_type = FieldType::FT_STRING)
+        {
+            FieldValue fv;
+            fv.init_string(text, field_type);
+            return fv;
+        }
+
+        /// @brief Creates an FT_BINARY value from raw bytes.
+        static FieldValue from_binary(const uint8_t *data, size_t size)
+        {
+            FieldValue fv;
+            fv._type = FieldType::FT_BINARY;
+            if (size > 0)
+            {
+                fv._payload.block = detail::allocate_block<uint8_t>(static_cast<uint32_t>(size));
+                std::memcpy(detail::block_data<uint8_t>(fv._payload.block), data, size);
+                fv._payload.block->size = static_cast<uint32_t>(size);
+            }
+            return fv;
+        }
+
+        /// @brief Gets the BSON type of the field.
+        FieldType type() const { return _type; }
+
+        /// @brief Gets the contents of a string-backed value, or an empty view for other types.
+        std::string_view string_view() const
+        {
+            if (storage_of(_type) != Storage::String)
+            {
+                return {};
+            }
+            if (_small == kHeapString)
+            {
+                return {detail::block_data<char>(_payload.block), _payload.block->size};
+            }
+            return {_payload.bytes, _small};
+        }
+
+        /// @brief Gets the bytes of an FT_BINARY value, or an empty range for other types.
+        FieldRange<const uint8_t> binary() const { return range<const uint8_t>(Storage::Binary); }
+
+        /// @brief Gets the items of an FT_ARRAY value, or an empty range for other types.
+        FieldRange<const FieldValue> array() const { return range<const FieldValue>(Storage::Array); }
+        FieldRange<FieldValue> array() { return range<FieldValue>(Storage::Array); }
+
+        /// @brief Gets the members of an FT_OBJECT value in insertion order, or an empty range for other types.
+        FieldRange<const Member> object() const { return range<const Member>(Storage::Object); }
+        FieldRange<Member> object() { return range<Member>(Storage::Object); }
+
+        /// @brief Finds an object member by key.
+        /// @return A pointer to the member's value, or nullptr if absent or if this is not an object.
+        const FieldValue *find(std::string_view key) const
+        {
+            for (const auto &member : object())
+            {
+                if (member.first == key)
                 {
-                    fv_map.emplace(key, FieldValue(item));
+                    return &member.second;
                 }
             }
-            value = fv_map;
+            return nullptr;
+        }
+
+        FieldValue *find(std::string_view key)
+        {
+            return const_cast<FieldValue *>(static_cast<const FieldValue &>(*this).find(key));
+        }
+
+        /// @brief Reserves room for array items or object members. Has no effect on other types.
+        void reserve(size_t capacity)
+        {
+            const Storage storage = storage_of(_type);
+            if (capacity == 0 || (storage != Storage::Array && storage != Storage::Object))
+            {
+                return;
+            }
+            _payload.block = storage == Storage::Array
+                                 ? detail::reserve_block<FieldValue>(_payload.block, static_cast<uint32_t>(capacity))
+                                 : detail::reserve_block<Member>(_payload.block, static_cast<uint32_t>(capacity));
+        }
+
+        /// @brief Appends an item to an array. A value that is not an array is replaced by an empty array first.
+        /// @return A reference to the appended item.
+        FieldValue &push_back(FieldValue item)
+        {
+            if (_type != FieldType::FT_ARRAY)
+            {
+                *this = make_array();
+            }
+            grow_for_one<FieldValue>();
+            FieldValue *slot = detail::block_data<FieldValue>(_payload.block) + _payload.block->size;
+            new (slot) FieldValue(std::move(item));
+            ++_payload.block->size;
+            return *slot;
+        }
+
+        /// @brief Appends a member to an object without checking for an existing key.
+        /// A value that is not an object is replaced by an empty object first.
+        /// @return A reference to the appended member's value.
+        FieldValue &emplace_member(std::string key, FieldValue value)
+        {
+            if (_type != FieldType::FT_OBJECT)
+            {
+                *this = make_object();
+            }
+            grow_for_one<Member>();
+            Member *slot = detail::block_data<Member>(_payload.block) + _payload.block->size;
+            new (slot) Member(std::move(key), std::move(value));
+            ++_payload.block->size;
+            return slot->second;
         }
 
-        template <typename T1, typename T2> FieldValue(const std::pair<T1, T2> &pair_in) : type(FieldType::FT_ARRAY)
+        /// @brief Sets an object member, replacing the value of an existing key or appending a new member.
+        /// A value that is not an object is replaced by an empty object first.
+        /// @return A reference to the member's value.
+        FieldValue &set_member(std::string_view key, FieldValue value)
         {
-            std::vector<FieldValue> fv_vector;
-            fv_vector.reserve(2);
-            fv_vector.push_back(FieldValue(pair_in.first));
-            fv_vector.push_back(FieldValue(pair_in.second));
-            value = fv_vector;
+            if (FieldValue *existing = find(key))
+            {
+                *existing = std::move(value);
+                return *existing;
+            }
+            return emplace_member(std::string(key), std::move(value));
         }
 
         /// @brief Template method to get the value as a specific type T.
@@ -319,41 +766,34 @@ namespace QDB
             }
             else if constexpr (std::is_same_v<T, std::vector<uint8_t>>)
             {
-                if (type != FieldType::FT_BINARY)
-                    return T{};
-                try
-                {
-                    return std::get<std::vector<uint8_t>>(value);
-                }
-                catch (...)
-                {
+                if (_type != FieldType::FT_BINARY)
                     return T{};
-                }
+                auto bytes = binary();
+                return T(bytes.begin(), bytes.end());
             }
             else if constexpr (is_std_vector<T>::value)
             {
                 using U = typename T::value_type;
-                if (type != FieldType::FT_ARRAY)
+                if (_type != FieldType::FT_ARRAY)
                     return T{};
-                const auto &fv_vector = std::get<std::vector<FieldValue>>(value);
+                auto items = array();
                 T result_vector;
-                result_vector.reserve(fv_vector.size());
-                for (const auto &fv_item : fv_vector)
+                result_vector.reserve(items.size());
+                for (const auto &fv_item : items)
                 {
-                    result_vector.push_back(fv_item.as<U>());
+                    result_vector.push_back(fv_item.template as<U>());
                 }
                 return result_vector;
             }
             else if constexpr (is_std_map<T>::value)
             {
                 using V = typename T::mapped_type;
-                if (type != FieldType::FT_OBJECT)
+                if (_type != FieldType::FT_OBJECT)
                     return T{};
-                const auto &fv_map = std::get<std::unordered_map<std::string, FieldValue>>(value);
                 T result_map;
-                for (const auto &[k, v] : fv_map)
+                for (const auto &[k, v] : object())
                 {
-                    result_map[k] = v.as<V>();
+                    result_map[k] = v.template as<V>();
                 }
                 return result_map;
             }
@@ -361,151 +801,506 @@ namespace QDB
             {
                 using T1 = typename T::first_type;
                 using T2 = typename T::second_type;
-                if (type != FieldType::FT_ARRAY)
+                if (_type != FieldType::FT_ARRAY)
                     return T{};
-                const auto &fv_vector = std::get<std::vector<FieldValue>>(value);
+                auto items = array();
                 T result_pair;
-                if (fv_vector.size() >= 1) result_pair.first = fv_vector[0].as<T1>();
-                if (fv_vector.size() >= 2) result_pair.second = fv_vector[1].as<T2>();
+                if (items.size() >= 1) result_pair.first = items[0].template as<T1>();
+                if (items.size() >= 2) result_pair.second = items[1].template as<T2>();
                 return result_pair;
             }
+            else if constexpr (std::is_same_v<T, std::unordered_map<std::string, FieldValue>>)
+            {
+                if (_type != FieldType::FT_OBJECT)
+                    return T{};
+                T result_map;
+                result_map.reserve(object().size());
+                for (const auto &[k, v] : object())
+                {
+                    result_map[k] = v;
+                }
+                return result_map;
+            }
+            else if constexpr (std::is_same_v<T, FieldMap>)
+            {
+                T result_map;
+                result_map.reserve(object().size());
+                for (const auto &[k, v] : object())
+                {
+                    result_map[k] = v;
+                }
+                return result_map;
+            }
             else if constexpr (has_from_fields<T>::value)
             {
                 // Deserialize nested object
-                if (type != FieldType::FT_OBJECT)
+                if (_type != FieldType::FT_OBJECT)
                     return T{};
-                const auto &map = std::get<std::unordered_map<std::string, FieldValue>>(value);
                 T doc;
-                doc.from_fields(map);
+                doc.from_fields(as<std::unordered_map<std::string, FieldValue>>());
                 return doc;
             }
             else if constexpr (std::is_enum_v<T>)
             {
-                if (type != FieldType::FT_INT_32)
-                    return T{};
-                try
-                {
-                    if (std::holds_alternative<int32_t>(value))
-                    {
-                        return static_cast<T>(std::get<int32_t>(value));
-                    }
-                }
-                catch (...)
-                {
-                }
-                return T{};
+                return (_type == FieldType::FT_INT_32) ? static_cast<T>(_payload.int32) : T{};
             }
             else if constexpr (std::is_same_v<T, std::chrono::system_clock::time_point>)
             {
-                if (type != FieldType::FT_DATE)
-                    return T{};
-                try
-                {
-                    if (std::holds_alternative<bsoncxx::types::b_date>(value))
-                    {
-                        return std::get<bsoncxx::types::b_date>(value);
-                    }
-                }
-                catch (...)
-                {
-                }
-                return T{};
+                return (_type == FieldType::FT_DATE) ? T(std::chrono::milliseconds(_payload.int64)) : T{};
+            }
+            else if constexpr (std::is_same_v<T, bool>)
+            {
+                return (_type == FieldType::FT_BOOLEAN) ? _payload.boolean : T{};
+            }
+            else if constexpr (std::is_same_v<T, int32_t>)
+            {
+                return (_type == FieldType::FT_INT_32) ? _payload.int32 : T{};
+            }
+            else if constexpr (std::is_same_v<T, int64_t>)
+            {
+                return (_type == FieldType::FT_INT_64) ? _payload.int64 : T{};
+            }
+            else if constexpr (std::is_same_v<T, double>)
+            {
+                return (_type == FieldType::FT_DOUBLE) ? _payload.real : T{};
+            }
+            else if constexpr (is_std_string<T>::value)
+            {
+                return T(string_view());
+            }
+            else if constexpr (std::is_same_v<T, bsoncxx::oid>)
+            {
+                return (_type == FieldType::FT_OBJECT_ID) ? bsoncxx::oid(_payload.bytes, bsoncxx::oid::size()) : T{};
+            }
+            else if constexpr (std::is_same_v<T, bsoncxx::types::b_date>)
+            {
+                return (_type == FieldType::FT_DATE) ? T{std::chrono::milliseconds(_payload.int64)} : T{};
+            }
+            else if constexpr (std::is_same_v<T, bsoncxx::types::b_timestamp>)
+            {
+                return (_type == FieldType::FT_TIMESTAMP) ? T{_payload.words[0], _payload.words[1]} : T{};
+            }
+            else if constexpr (std::is_same_v<T, std::nullptr_t>)
+            {
+                return nullptr;
             }
             else
             {
-                try
-                {
-                    if (std::holds_alternative<T>(value))
-                        return std::get<T>(value);
-                }
-                catch (...)
-                {
-                }
-                return T{};
+                static_assert(dependent_false<T>::value, "Type is not supported by QDB::FieldValue::as");
             }
         }
 
-        FieldType type = FieldType::FT_UNDEFINED; ///< The BSON type of the field.
-        FieldVariant value;                       ///< The actual value of the field, stored in a variant.
+        /// @brief Swaps two values without allocating.
+        void swap(FieldValue &other) noexcept
+        {
+            std::swap(_payload, other._payload);
+            std::swap(_type, other._type);
+            std::swap(_small, other._small);
+        }
+
+        friend bool operator==(const FieldValue &lhs, const FieldValue &rhs);
+
+    private:
+        /// @brief How a FieldType is laid out in the payload.
+        enum class Storage : uint8_t
+        {
+            None,
+            Boolean,
+            Int32,
+            Int64,
+            Double,
+            ObjectId,
+            Timestamp,
+            String,
+            Binary,
+            Array,
+            Object,
+        };
+
+        static constexpr Storage storage_of(FieldType field_type)
+        {
+            switch (field_type)
+            {
+            case FieldType::FT_BOOLEAN:
+                return Storage::Boolean;
+            case FieldType::FT_INT_32:
+                return Storage::Int32;
+            case FieldType::FT_INT_64:
+            case FieldType::FT_DATE:
+                return Storage::Int64;
+            case FieldType::FT_DOUBLE:
+                return Storage::Double;
+            case FieldType::FT_OBJECT_ID:
+                return Storage::ObjectId;
+            case FieldType::FT_TIMESTAMP:
+                return Storage::Timestamp;
+            case FieldType::FT_STRING:
+            case FieldType::FT_CODE:
+            case FieldType::FT_BSON_SYMBOL:
+            case FieldType::FT_BSON_REG_EXPR:
+            case FieldType::FT_DECIMAL_128:
+                return Storage::String;
+            case FieldType::FT_BINARY:
+                return Storage::Binary;
+            case FieldType::FT_ARRAY:
+                return Storage::Array;
+            case FieldType::FT_OBJECT:
+                return Storage::Object;
+            default:
+                return Storage::None;
+            }
+        }
+
+        /// @brief Longest string stored without a heap block.
+        static constexpr size_t kInlineCapacity = 16;
+        /// @brief Marker in `_small` for a string stored in a heap block.
+        static constexpr uint8_t kHeapString = 0xFF;
+
+        bool owns_block() const
+        {
+            const Storage storage = storage_of(_type);
+            return storage == Storage::Binary || storage == Storage::Array || storage == Storage::Object ||
+                   (storage == Storage::String && _small == kHeapString);
+        }
+
+        detail::FieldBlock *clone_block() const
+        {
+            switch (storage_of(_type))
+            {
+            case Storage::String:
+                return detail::copy_block<char>(_payload.block);
+            case Storage::Binary:
+                return detail::copy_block<uint8_t>(_payload.block);
+            case Storage::Array:
+                return detail::copy_block<FieldValue>(_payload.block);
+            default:
+                return detail::copy_block<Member>(_payload.block);
+            }
+        }
+
+        void release()
+        {
+            if (!owns_block())
+            {
+                return;
+            }
+            switch (storage_of(_type))
+            {
+            case Storage::String:
+                detail::release_block<char>(_payload.block);
+                break;
+            case Storage::Binary:
+                detail::release_block<uint8_t>(_payload.block);
+                break;
+            case Storage::Array:
+                detail::release_block<FieldValue>(_payload.block);
+                break;
+            default:
+                detail::release_block<Member>(_payload.block);
+                break;
+            }
+            _payload.block = nullptr;
+        }
+
+        template <typename Elem> FieldRange<Elem> range(Storage storage) const
+        {
+            if (storage_of(_type) != storage || !_payload.block)
+            {
+                return {};
+            }
+            auto *data = detail::block_data<std::remove_const_t<Elem>>(_payload.block);
+            return {const_cast<Elem *>(data), _payload.block->size};
+        }
+
+        template <typename Elem> void grow_for_one()
+        {
+            const uint32_t size = _payload.block ? _payload.block->size : 0;
+            const uint32_t capacity = _payload.block ? _payload.block->capacity : 0;
+            if (size == capacity)
+            {
+                _payload.block = detail::reserve_block<Elem>(_payload.block, capacity < 4 ? 4 : capacity * 2);
+            }
+        }
+
+        void init_string(std::string_view text, FieldType field_type)
+        {
+            _type = field_type;
+            if (text.size() <= kInlineCapacity)
+            {
+                _small = static_cast<uint8_t>(text.size());
+                std::memcpy(_payload.bytes, text.data(), text.size());
+            }
+            else
+            {
+                _small = kHeapString;
+                _payload.block = detail::allocate_block<char>(static_cast<uint32_t>(text.size()));
+                std::memcpy(detail::block_data<char>(_payload.block), text.data(), text.size());
+                _payload.block->size = static_cast<uint32_t>(text.size());
+            }
+        }
+
+        /// @brief Initializes an FT_OBJECT from an unordered_map or FieldMap, keeping the map's iteration order.
+        template <typename Map> void init_object(const Map &fields)
+        {
+            _type = FieldType::FT_OBJECT;
+            reserve(fields.size());
+            for (const auto &[key, value] : fields)
+            {
+                emplace_member(key, value);
+            }
+        }
+
+        /// @brief Inline storage for scalars, ObjectIds and short strings, or the heap block otherwise.
+        union Payload
+        {
+            char bytes[kInlineCapacity]; ///< Short strings and ObjectIds. Listed first so `{}` zeroes everything.
+            bool boolean;
+            int32_t int32;
+            int64_t int64; ///< FT_INT_64, and milliseconds since the epoch for FT_DATE.
+            double real;
+            uint32_t words[2]; ///< FT_TIMESTAMP increment and timestamp.
+            detail::FieldBlock *block;
+        } _payload{};
+
+        FieldType _type = FieldType::FT_UNDEFINED; ///< The BSON type of the field.
+        uint8_t _small = 0;                        ///< Inline string length, or kHeapString.
     };
 
-    /// @brief Equality operator for FieldValue.
+    static_assert(sizeof(FieldValue) <= 24, "FieldValue should stay compact");
+
+    /// @brief Equality operator for FieldValue. Object members are compared regardless of order.
     inline bool operator==(const FieldValue &lhs, const FieldValue &rhs)
     {
-        if (lhs.type != rhs.type)
+        if (lhs._type != rhs._type)
+            return false;
+
+        switch (FieldValue::storage_of(lhs._type))
+        {
+        case FieldValue::Storage::None:
+            return true;
+        case FieldValue::Storage::Boolean:
+            return lhs._payload.boolean == rhs._payload.boolean;
+        case FieldValue::Storage::Int32:
+            return lhs._payload.int32 == rhs._payload.int32;
+        case FieldValue::Storage::Int64:
+            return lhs._payload.int64 == rhs._payload.int64;
+        case FieldValue::Storage::Double:
+            return lhs._payload.real == rhs._payload.real;
+        case FieldValue::Storage::ObjectId:
+            return std::memcmp(lhs._payload.bytes, rhs._payload.bytes, bsoncxx::oid::size()) == 0;
+        case FieldValue::Storage::Timestamp:
+            return lhs._payload.words[0] == rhs._payload.words[0] && lhs._payload.words[1] == rhs._payload.words[1];
+        case FieldValue::Storage::String:
+            return lhs.string_view() == rhs.string_view();
+        case FieldValue::Storage::Binary:
+        {
+            auto a = lhs.binary(), b = rhs.binary();
+            return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+        }
+        case FieldValue::Storage::Array:
+        {
+            auto a = lhs.array(), b = rhs.array();
+            return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+        }
+        case FieldValue::Storage::Object:
+        {
+            auto a = lhs.object(), b = rhs.object();
+            if (a.size() != b.size())
+                return false;
+            // Fast path for members in the same order, then fall back to key lookups.
+            if (std::equal(a.begin(), a.end(), b.begin()))
+                return true;
+            for (const auto &[key, value] : a)
+            {
+                const FieldValue *other = rhs.find(key);
+                if (!other || !(*other == value))
+                    return false;
+            }
+            return true;
+        }
+        }
+        return false;
+    }
+
+    inline bool operator!=(const FieldValue &lhs, const FieldValue &rhs) { return !(lhs == rhs); }
+
+    /// @brief An insertion-ordered map of field names to FieldValues, stored as a flat vector of pairs.
+    ///
+    /// Used for query, update and aggregation documents so that BSON keys are emitted in the order they
+    /// were added (deterministic bytes, correct multi-key $sort). Lookups are linear, which is faster than
+    /// hashing for the handful of keys these documents hold.
+    class FieldMap
+    {
+    public:
+        using value_type = FieldValue::Member;
+        using iterator = std::vector<value_type>::iterator;
+        using const_iterator = std::vector<value_type>::const_iterator;
+
+        FieldMap() = default;
+
+        /// @brief Constructs a map from key-value pairs. Later duplicates replace earlier ones.
+        FieldMap(std::initializer_list<value_type> entries)
+        {
+            _entries.reserve(entries.size());
+            for (const auto &entry : entries)
+            {
+                (*this)[entry.first] = entry.second;
+            }
+        }
+
+        /// @brief Gets the value for a key, appending a default-constructed value if it is absent.
+        FieldValue &operator[](std::string_view key)
+        {
+            auto it = find(key);
+            if (it != _entries.end())
+            {
+                return it->second;
+            }
+            _entries.emplace_back(std::string(key), FieldValue{});
+            return _entries.back().second;
+        }
+
+        /// @brief Inserts a key-value pair if the key is absent.
+        /// @return An iterator to the entry for the key, and whether an insertion took place.
+        std::pair<iterator, bool> emplace(std::string key, FieldValue value)
+        {
+            auto it = find(key);
+            if (it != _entries.end())
+            {
+                return {it, false};
+            }
+            _entries.emplace_back(std::move(key), std::move(value));
+            return {std::prev(_entries.end()), true};
+        }
+
+        iterator find(std::string_view key)
+        {
+            return std::find_if(_entries.begin(), _entries.end(), [&](const value_type &entry) { return entry.first == key; });
+        }
+
+        const_iterator find(std::string_view key) const
+        {
+            return std::find_if(_entries.begin(), _entries.end(), [&](const value_type &entry) { return entry.first == key; });
+        }
+
+        size_t count(std::string_view key) const { return find(key) != _entries.end() ? 1 : 0; }
+
+        /// @brief Removes a key, preserving the order of the remaining entries.
+        /// @return The number of entries removed (0 or 1).
+        size_t erase(std::string_view key)
+        {
+            auto it = find(key);
+            if (it == _entries.end())
+            {
+                return 0;
+            }
+            _entries.erase(it);
+            return 1;
+        }
+
+        iterator begin() { return _entries.begin(); }
+        iterator end() { return _entries.end(); }
+        const_iterator begin() const { return _entries.begin(); }
+        const_iterator end() const { return _entries.end(); }
+        size_t size() const { return _entries.size(); }
+        bool empty() const { return _entries.empty(); }
+        void reserve(size_t capacity) { _entries.reserve(capacity); }
+        void clear() { _entries.clear(); }
+
+    private:
+        std::vector<value_type> _entries;
+    };
+
+    /// @brief Equality operator for FieldMap. Like FT_OBJECT values, entries are compared regardless of order.
+    inline bool operator==(const FieldMap &lhs, const FieldMap &rhs)
+    {
+        if (lhs.size() != rhs.size())
             return false;
-        return lhs.value == rhs.value;
+        for (const auto &[key, value] : lhs)
+        {
+            auto it = rhs.find(key);
+            if (it == rhs.end() || it->second != value)
+                return false;
+        }
+        return true;
     }
 
+    inline bool operator!=(const FieldMap &lhs, const FieldMap &rhs) { return !(lhs == rhs); }
+
     //---------------------------------------------------------------
     // Helper functions for converting FieldValue to BSON.
     //---------------------------------------------------------------
     // Forward declarations for recursive calls
-    static void AppendToDocument(bsoncxx::builder::basic::document &doc, const std::string &key, const FieldValue &fv);
-    static void AppendToArray(bsoncxx::builder::basic::array &arr, const FieldValue &fv);
+    static void AppendToDocument(bsoncxx::builder::basic::sub_document &doc, std::string_view key, const FieldValue &fv);
+    static void AppendToArray(bsoncxx::builder::basic::sub_array &arr, const FieldValue &fv);
     template <typename BsonElement> static FieldValue fromBsonElement(const BsonElement &element);
 
     /// @brief Appends a FieldValue to a BSON array builder.
-    static void AppendToArray(bsoncxx::builder::basic::array &arr, const FieldValue &fv)
+    static void AppendToArray(bsoncxx::builder::basic::sub_array &arr, const FieldValue &fv)
     {
         using namespace bsoncxx::builder::basic;
-        switch (fv.type)
+        switch (fv.type())
         {
         case FieldType::FT_BOOLEAN:
-            arr.append(std::get<bool>(fv.value));
+            arr.append(fv.as<bool>());
             break;
         case FieldType::FT_INT_32:
-            arr.append(std::get<int32_t>(fv.value));
+            arr.append(fv.as<int32_t>());
             break;
         case FieldType::FT_INT_64:
-            arr.append(std::get<int64_t>(fv.value));
+            arr.append(fv.as<int64_t>());
             break;
         case FieldType::FT_DOUBLE:
-            arr.append(std::get<double>(fv.value));
+            arr.append(fv.as<double>());
             break;
         case FieldType::FT_NULL:
             arr.append(bsoncxx::types::b_null{});
             break;
         case FieldType::FT_STRING:
-            arr.append(std::get<std::string>(fv.value));
+        {
+            auto text = fv.string_view();
+            arr.append(bsoncxx::types::b_string{bsoncxx::v_noabi::stdx::string_view(text.data(), text.size())});
             break;
+        }
         case FieldType::FT_OBJECT_ID:
-            arr.append(std::get<bsoncxx::oid>(fv.value));
+            arr.append(fv.as<bsoncxx::oid>());
             break;
         case FieldType::FT_DATE:
-            arr.append(std::get<bsoncxx::types::b_date>(fv.value));
+            arr.append(fv.as<bsoncxx::types::b_date>());
             break;
         case FieldType::FT_TIMESTAMP:
-            arr.append(std::get<bsoncxx::types::b_timestamp>(fv.value));
+            arr.append(fv.as<bsoncxx::types::b_timestamp>());
             break;
         case FieldType::FT_BINARY:
         {
-            const auto &vec = std::get<std::vector<uint8_t>>(fv.value);
-            arr.append(
-                bsoncxx::types::b_binary{bsoncxx::binary_sub_type::k_binary, static_cast<uint32_t>(vec.size()), vec.data()});
+            auto bytes = fv.binary();
+            arr.append(bsoncxx::types::b_binary{bsoncxx::binary_sub_type::k_binary, static_cast<uint32_t>(bytes.size()),
+                                                bytes.begin()});
             break;
         }
 
         case FieldType::FT_OBJECT:
         {
-            document sub_doc{};
-            auto map = std::get<std::unordered_map<std::string, FieldValue>>(fv.value);
-            for (const auto &[sub_key, sub_value] : map)
-            {
-                AppendToDocument(sub_doc, sub_key, sub_value);
-            }
-            arr.append(sub_doc.view());
+            arr.append(
+                [&](sub_document sub_doc)
+                {
+                    for (const auto &[sub_key, sub_value] : fv.object())
+                    {
+                        AppendToDocument(sub_doc, sub_key, sub_value);
+                    }
+                });
             break;
         }
         case FieldType::FT_ARRAY:
         {
-            array sub_arr{};
-            auto vec = std::get<std::vector<FieldValue>>(fv.value);
-            for (const auto &item : vec)
-            {
-                AppendToArray(sub_arr, item);
-            }
-            arr.append(sub_arr.view());
+            arr.append(
+                [&](sub_array sub_arr)
+                {
+                    for (const auto &item : fv.array())
+                    {
+                        AppendToArray(sub_arr, item);
+                    }
+                });
             break;
         }
         default:
@@ -515,30 +1310,31 @@ namespace QDB
     }
 
     /// @brief Appends a key-FieldValue pair to a BSON document builder.
-    static void AppendToDocument(bsoncxx::builder::basic::document &doc, const std::string &key, const FieldValue &fv)
+    static void AppendToDocument(bsoncxx::builder::basic::sub_document &doc, std::string_view name, const FieldValue &fv)
     {
         using namespace bsoncxx::builder::basic;
+        const bsoncxx::v_noabi::stdx::string_view key(name.data(), name.size());
 
-        switch (fv.type)
+        switch (fv.type())
         {
         case FieldType::FT_BOOLEAN:
         {
-            doc.append(kvp(key, std::get<bool>(fv.value)));
+            doc.append(kvp(key, fv.as<bool>()));
             break;
         }
         case FieldType::FT_INT_32:
         {
-            doc.append(kvp(key, std::get<int32_t>(fv.value)));
+            doc.append(kvp(key, fv.as<int32_t>()));
             break;
         }
         case FieldType::FT_INT_64:
         {
-            doc.append(kvp(key, std::get<int64_t>(fv.value)));
+            doc.append(kvp(key, fv.as<int64_t>()));
             break;
         }
         case FieldType::FT_DOUBLE:
         {
-            doc.append(kvp(key, std::get<double>(fv.value)));
+            doc.append(kvp(key, fv.as<double>()));
             break;
         }
         case FieldType::FT_NULL:
@@ -548,52 +1344,55 @@ namespace QDB
         }
         case FieldType::FT_STRING:
         {
-            doc.append(kvp(key, std::get<std::string>(fv.value)));
+            auto text = fv.string_view();
+            doc.append(kvp(key, bsoncxx::types::b_string{bsoncxx::v_noabi::stdx::string_view(text.data(), text.size())}));
             break;
         }
         case FieldType::FT_OBJECT_ID:
         {
-            doc.append(kvp(key, std::get<bsoncxx::oid>(fv.value)));
+            doc.append(kvp(key, fv.as<bsoncxx::oid>()));
             break;
         }
         case FieldType::FT_DATE:
         {
-            doc.append(kvp(key, std::get<bsoncxx::types::b_date>(fv.value)));
+            doc.append(kvp(key, fv.as<bsoncxx::types::b_date>()));
             break;
         }
         case FieldType::FT_TIMESTAMP:
         {
-            doc.append(kvp(key, std::get<bsoncxx::types::b_timestamp>(fv.value)));
+            doc.append(kvp(key, fv.as<bsoncxx::types::b_timestamp>()));
             break;
         }
         case FieldType::FT_BINARY:
         {
-            const auto &vec = std::get<std::vector<uint8_t>>(fv.value);
+            auto bytes = fv.binary();
             doc.append(kvp(key, bsoncxx::types::b_binary{bsoncxx::binary_sub_type::k_binary,
-                                                         static_cast<uint32_t>(vec.size()), vec.data()}));
+                                                         static_cast<uint32_t>(bytes.size()), bytes.begin()}));
             break;
         }
 
         case FieldType::FT_OBJECT:
         {
-            document sub_doc{};
-            auto map = std::get<std::unordered_map<std::string, FieldValue>>(fv.value);
-            for (const auto &[sub_key, sub_value] : map)
-            {
-                AppendToDocument(sub_doc, sub_key, sub_value);
-            }
-            doc.append(kvp(key, sub_doc.view()));
+            doc.append(kvp(key,
+                           [&](sub_document sub_doc)
+                           {
+                               for (const auto &[sub_key, sub_value] : fv.object())
+                               {
+                                   AppendToDocument(sub_doc, sub_key, sub_value);
+                               }
+                           }));
             break;
         }
         case FieldType::FT_ARRAY:
         {
-            array sub_arr{};
-            auto vec = std::get<std::vector<FieldValue>>(fv.value);
-            for (const auto &item : vec)
-            {
-                AppendToArray(sub_arr, item);
-            }
-            doc.append(kvp(key, sub_arr.view()));
+            doc.append(kvp(key,
+                           [&](sub_array sub_arr)
+                           {
+                               for (const auto &item : fv.array())
+                               {
+                                   AppendToArray(sub_arr, item);
+                               }
+                           }));
             break;
         }
         default:
@@ -607,78 +1406,317 @@ namespace QDB
     /// @brief Converts any BSON element to a FieldValue.
     template <typename BsonElement> static FieldValue fromBsonElement(const BsonElement &element)
     {
-        FieldValue fv;
         switch (element.type())
         {
         case bsoncxx::type::k_bool:
-            fv.type = FieldType::FT_BOOLEAN;
-            fv.value = element.get_bool().value;
-            break;
+            return FieldValue(static_cast<bool>(element.get_bool().value));
         case bsoncxx::type::k_int32:
-            fv.type = FieldType::FT_INT_32;
-            fv.value = element.get_int32().value;
-            break;
+            return FieldValue(static_cast<int32_t>(element.get_int32().value));
         case bsoncxx::type::k_int64:
-            fv.type = FieldType::FT_INT_64;
-            fv.value = element.get_int64().value;
-            break;
+            return FieldValue(static_cast<int64_t>(element.get_int64().value));
         case bsoncxx::type::k_double:
-            fv.type = FieldType::FT_DOUBLE;
-            fv.value = element.get_double().value;
-            break;
+            return FieldValue(static_cast<double>(element.get_double().value));
         case bsoncxx::type::k_string:
-            fv.type = FieldType::FT_STRING;
-            fv.value = static_cast<std::string>(element.get_string().value);
-            break;
+        {
+            auto text = element.get_string().value;
+            return FieldValue::from_string(std::string_view(text.data(), text.size()));
+        }
         case bsoncxx::type::k_oid:
-            fv.type = FieldType::FT_OBJECT_ID;
-            fv.value = element.get_oid().value;
-            break;
+            return FieldValue(element.get_oid().value);
         case bsoncxx::type::k_date:
-            fv.type = FieldType::FT_DATE;
-            fv.value = element.get_date();
-            break;
+            return FieldValue(element.get_date());
         case bsoncxx::type::k_timestamp:
-            fv.type = FieldType::FT_TIMESTAMP;
-            fv.value = element.get_timestamp();
-            break;
+            return FieldValue(element.get_timestamp());
         case bsoncxx::type::k_binary:
         {
-            fv.type = FieldType::FT_BINARY;
             auto bin = element.get_binary();
-            const uint8_t *ptr = bin.bytes;
-            fv.value = std::vector<uint8_t>(ptr, ptr + bin.size);
-            break;
+            return FieldValue::from_binary(bin.bytes, bin.size);
         }
 
         case bsoncxx::type::k_document:
         {
-            fv.type = FieldType::FT_OBJECT;
-            std::unordered_map<std::string, FieldValue> map;
+            FieldValue fv = FieldValue::make_object();
             for (auto inner_element : element.get_document().value)
             {
-                map[static_cast<std::string>(inner_element.key())] = fromBsonElement(inner_element);
+                auto key = inner_element.key();
+                fv.emplace_member(std::string(key.data(), key.size()), fromBsonElement(inner_element));
             }
-            fv.value = map;
-            break;
+            return fv;
         }
         case bsoncxx::type::k_array:
         {
-            fv.type = FieldType::FT_ARRAY;
-            std::vector<FieldValue> vec;
+            FieldValue fv = FieldValue::make_array();
             for (auto inner_element : element.get_array().value)
             {
-                vec.push_back(fromBsonElement(inner_element));
+                fv.push_back(fromBsonElement(inner_element));
             }
-            fv.value = vec;
-            break;
+            return fv;
         }
         default:
-            fv.type = FieldType::FT_NULL;
-            fv.value = nullptr;
-            break;
+            return FieldValue(nullptr);
+        }
+    }
+
+    //---------------------------------------------------------------
+    // Helper functions for writing C++ values directly to BSON.
+    //---------------------------------------------------------------
+    // These mirror the FieldValue constructors, but append straight into a builder so that
+    // Model schemas can be encoded without materializing an intermediate FieldValue tree.
+    // FieldValue arguments are routed to AppendToDocument/AppendToArray before reaching AppendBsonValue.
+    template <typename T>
+    static void AppendValueToDocument(bsoncxx::builder::basic::sub_document &doc, std::string_view key,
+                                      const T &value);
+    template <typename T> static void AppendValueToArray(bsoncxx::builder::basic::sub_array &arr, const T &value);
+
+    /// @brief Converts a C++ value into its BSON representation and hands it to `sink`.
+    /// @param value The value to encode.
+    /// @param sink A callable taking a single bsoncxx-appendable value (scalar, b_* type or sub-builder callback).
+    template <typename T, typename Sink> static void AppendBsonValue(const T &value, Sink &&sink)
+    {
+        using namespace bsoncxx::builder::basic;
+        using DecayedT = std::decay_t<T>;
+
+        if constexpr (std::is_same_v<DecayedT, bool> || std::is_same_v<DecayedT, int32_t> ||
+                           std::is_same_v<DecayedT, int64_t> || std::is_same_v<DecayedT, double> ||
+                           std::is_same_v<DecayedT, const char *> ||
+                           std::is_same_v<DecayedT, char *> || std::is_same_v<DecayedT, bsoncxx::oid> ||
+                           std::is_same_v<DecayedT, bsoncxx::types::b_date> ||
+                           std::is_same_v<DecayedT, bsoncxx::types::b_timestamp>)
+        {
+            sink(value);
+        }
+        else if constexpr (is_std_string<DecayedT>::value)
+        {
+            sink(bsoncxx::types::b_string{bsoncxx::v_noabi::stdx::string_view(value.data(), value.size())});
+        }
+        else if constexpr (std::is_enum_v<DecayedT>)
+        {
+            sink(static_cast<int32_t>(value));
+        }
+        else if constexpr (std::is_same_v<DecayedT, std::chrono::system_clock::time_point>)
+        {
+            sink(bsoncxx::types::b_date{value});
+        }
+        else if constexpr (std::is_same_v<DecayedT, std::vector<uint8_t>>)
+        {
+            sink(bsoncxx::types::b_binary{bsoncxx::binary_sub_type::k_binary, static_cast<uint32_t>(value.size()),
+                                          value.data()});
+        }
+        else if constexpr (is_std_vector<DecayedT>::value)
+        {
+            sink(
+                [&](sub_array sub)
+                {
+                    for (const auto &item : value)
+                    {
+                        AppendValueToArray(sub, item);
+                    }
+                });
+        }
+        else if constexpr (is_std_map<DecayedT>::value)
+        {
+            sink(
+                [&](sub_document sub)
+                {
+                    for (const auto &[key, item] : value)
+                    {
+                        AppendValueToDocument(sub, key, item);
+                    }
+                });
+        }
+        else if constexpr (is_std_pair<DecayedT>::value)
+        {
+            sink(
+                [&](sub_array sub)
+                {
+                    AppendValueToArray(sub, value.first);
+                    AppendValueToArray(sub, value.second);
+                });
+        }
+        else if constexpr (has_to_bson<DecayedT>::value)
+        {
+            // Nested models write themselves directly into the sub-document.
+            sink([&](sub_document sub) { value.to_bson(sub); });
+        }
+        else if constexpr (has_to_fields<DecayedT>::value)
+        {
+            sink(
+                [&](sub_document sub)
+                {
+                    for (const auto &[key, item] : value.to_fields())
+                    {
+                        AppendToDocument(sub, key, item);
+                    }
+                });
+        }
+        else
+        {
+            static_assert(dependent_false<DecayedT>::value, "Type is not supported by the QDB BSON encoder");
+        }
+    }
+
+    /// @brief Appends a key and a C++ value to a BSON document builder without going through FieldValue.
+    template <typename T>
+    static void AppendValueToDocument(bsoncxx::builder::basic::sub_document &doc, std::string_view key,
+                                      const T &value)
+    {
+        if constexpr (std::is_same_v<std::decay_t<T>, FieldValue>)
+        {
+            AppendToDocument(doc, key, value);
+        }
+        else
+        {
+            // Keys are passed as views so that schema names never need a std::string.
+            const bsoncxx::v_noabi::stdx::string_view bson_key(key.data(), key.size());
+            AppendBsonValue(value, [&](auto &&bson_value)
+                            { doc.append(bsoncxx::builder::basic::kvp(bson_key, std::forward<decltype(bson_value)>(bson_value))); });
+        }
+    }
+
+    /// @brief Appends a C++ value to a BSON array builder without going through FieldValue.
+    template <typename T> static void AppendValueToArray(bsoncxx::builder::basic::sub_array &arr, const T &value)
+    {
+        if constexpr (std::is_same_v<std::decay_t<T>, FieldValue>)
+        {
+            AppendToArray(arr, value);
+        }
+        else
+        {
+            AppendBsonValue(value, [&](auto &&bson_value) { arr.append(std::forward<decltype(bson_value)>(bson_value)); });
+        }
+    }
+
+    //---------------------------------------------------------------
+    // Helper functions for reading BSON directly into C++ values.
+    //---------------------------------------------------------------
+    // These mirror FieldValue::as<T>(): a present element of the wrong BSON type resets the
+    // destination to a default-constructed value. Containers are decoded in place.
+
+    /// @brief Decodes a BSON element (document or array element) straight into a C++ value.
+    /// @param element The bsoncxx element to read.
+    /// @param out The destination value.
+    template <typename BsonElement, typename T> static void ReadBsonElement(const BsonElement &element, T &out)
+    {
+        const auto type = element.type();
+
+        if constexpr (std::is_same_v<T, FieldValue>)
+        {
+            out = fromBsonElement(element);
+        }
+        else if constexpr (std::is_same_v<T, bool>)
+        {
+            out = (type == bsoncxx::type::k_bool) ? element.get_bool().value : T{};
+        }
+        else if constexpr (std::is_same_v<T, int32_t>)
+        {
+            out = (type == bsoncxx::type::k_int32) ? element.get_int32().value : T{};
+        }
+        else if constexpr (std::is_same_v<T, int64_t>)
+        {
+            out = (type == bsoncxx::type::k_int64) ? element.get_int64().value : T{};
+        }
+        else if constexpr (std::is_same_v<T, double>)
+        {
+            out = (type == bsoncxx::type::k_double) ? element.get_double().value : T{};
+        }
+        else if constexpr (is_std_string<T>::value)
+        {
+            if (type == bsoncxx::type::k_string)
+            {
+                auto value = element.get_string().value;
+                out.assign(value.data(), value.size());
+            }
+            else
+            {
+                out.clear();
+            }
+        }
+        else if constexpr (std::is_same_v<T, bsoncxx::oid>)
+        {
+            out = (type == bsoncxx::type::k_oid) ? element.get_oid().value : T{};
+        }
+        else if constexpr (std::is_same_v<T, bsoncxx::types::b_date>)
+        {
+            out = (type == bsoncxx::type::k_date) ? element.get_date() : T{};
+        }
+        else if constexpr (std::is_same_v<T, std::chrono::system_clock::time_point>)
+        {
+            out = (type == bsoncxx::type::k_date) ? T(element.get_date()) : T{};
+        }
+        else if constexpr (std::is_same_v<T, bsoncxx::types::b_timestamp>)
+        {
+            out = (type == bsoncxx::type::k_timestamp) ? element.get_timestamp() : T{};
+        }
+        else if constexpr (std::is_enum_v<T>)
+        {
+            out = (type == bsoncxx::type::k_int32) ? static_cast<T>(element.get_int32().value) : T{};
+        }
+        else if constexpr (std::is_same_v<T, std::vector<uint8_t>>)
+        {
+            out.clear();
+            if (type == bsoncxx::type::k_binary)
+            {
+                auto bin = element.get_binary();
+                out.assign(bin.bytes, bin.bytes + bin.size);
+            }
+        }
+        else if constexpr (is_std_vector<T>::value)
+        {
+            out.clear();
+            if (type == bsoncxx::type::k_array)
+            {
+                for (const auto &inner_element : element.get_array().value)
+                {
+                    out.emplace_back();
+                    ReadBsonElement(inner_element, out.back());
+                }
+            }
+        }
+        else if constexpr (is_std_map<T>::value)
+        {
+            out.clear();
+            if (type == bsoncxx::type::k_document)
+            {
+                for (const auto &inner_element : element.get_document().value)
+                {
+                    ReadBsonElement(inner_element, out[typename T::key_type(inner_element.key())]);
+                }
+            }
+        }
+        else if constexpr (is_std_pair<T>::value)
+        {
+            out = T{};
+            if (type == bsoncxx::type::k_array)
+            {
+                auto array = element.get_array().value;
+                auto it = array.begin();
+                if (it != array.end())
+                {
+                    ReadBsonElement(*it, out.first);
+                    if (++it != array.end())
+                    {
+                        ReadBsonElement(*it, out.second);
+                    }
+                }
+            }
+        }
+        else if constexpr (has_from_bson<T>::value)
+        {
+            // Nested models read their members directly from the sub-document view.
+            out = T{};
+            if (type == bsoncxx::type::k_document)
+            {
+                out.from_bson(element.get_document().value);
+            }
+        }
+        else if constexpr (has_from_fields<T>::value)
+        {
+            out = fromBsonElement(element).template as<T>();
+        }
+        else
+        {
+            static_assert(dependent_false<T>::value, "Type is not supported by the QDB BSON decoder");
         }
-        return fv;
     }
 
-} // namespace QDB
\ No newline at end of file
+} // namespace QDB
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "quickdb/components/exception.h"
+#include "quickdb/components/metrics.h"
 
 #include <bsoncxx/oid.hpp>
 #include <bsoncxx/types.hpp>
@@ -22,8 +23,10 @@ namespace QDB
         /// @brief Constructs a GridFSBucket handler. This is typically created via Database::get_gridfs_bucket().
         /// @param client_entry A unique_ptr to the connection pool entry.
         /// @param bucket The underlying mongocxx bucket handle.
-        GridFSBucket(std::unique_ptr<mongocxx::pool::entry> client_entry, mongocxx::gridfs::bucket bucket)
-            : _client_entry(std::move(client_entry)), _bucket(std::move(bucket))
+        /// @param metrics Where to record uploads, downloads and deletes. Disabled by default.
+        GridFSBucket(std::unique_ptr<mongocxx::pool::entry> client_entry, mongocxx::gridfs::bucket bucket,
+                     CollectionMetrics metrics = {})
+            : _client_entry(std::move(client_entry)), _bucket(std::move(bucket)), _metrics(metrics)
         {
         }
 
@@ -33,6 +36,7 @@ namespace QDB
         /// @return The ObjectId of the newly created file in GridFS.
         bsoncxx::oid upload_from_file(const std::string &filename, const std::string &source_path)
         {
+            auto timer = _metrics.time(OperationKind::kUpload);
             try
             {
                 std::ifstream source_stream(source_path, std::ios::binary);
@@ -46,11 +50,13 @@ namespace QDB
                 while (source_stream.read(buffer, sizeof(buffer)))
                 {
                     uploader.write(reinterpret_cast<const std::uint8_t *>(buffer), source_stream.gcount());
+                    timer.encoded(static_cast<std::size_t>(source_stream.gcount()));
                 }
                 // Write any remaining bytes from the last read
                 if (source_stream.gcount() > 0)
                 {
                     uploader.write(reinterpret_cast<const std::uint8_t *>(buffer), source_stream.gcount());
+                    timer.encoded(static_cast<std::size_t>(source_stream.gcount()));
                 }
 
                 auto result = uploader.close();
@@ -67,6 +73,7 @@ namespace QDB
         /// @param destination_path The local path where the file will be saved.
         void download_to_file(bsoncxx::oid file_id, const std::string &destination_path)
         {
+            auto timer = _metrics.time(OperationKind::kDownload);
             try
             {
                 std::ofstream destination_stream(destination_path, std::ios::binary);
@@ -89,6 +96,7 @@ namespace QDB
                     destination_stream.write(reinterpret_cast<const char *>(buffer), bytes_to_read);
                     bytes_read += bytes_to_read;
                 }
+                timer.decoded(static_cast<std::size_t>(bytes_read));
             }
             catch (const std::exception &e)
             {
@@ -101,6 +109,7 @@ namespace QDB
         /// @param file_id The ObjectId of the file to delete.
         void delete_file(bsoncxx::oid file_id)
         {
+            auto timer = _metrics.time(OperationKind::kDeleteFile);
             try
             {
                 bsoncxx::types::bson_value::value oid_value(bsoncxx::types::b_oid{file_id});
@@ -119,5 +128,8 @@ namespace QDB
 
         /// @brief The bucket handle itself. It is dependent on the client from _client_entry.
         mongocxx::gridfs::bucket _bucket;
+
+        /// @brief Records each transfer under the bucket name.
+        CollectionMetrics _metrics;
     };
 } // namespace QDB
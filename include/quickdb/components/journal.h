@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <bsoncxx/document/value.hpp>
+#include <bsoncxx/document/view.hpp>
+
+namespace QDB
+{
+    /// @brief The outcome of Database::replay_journal().
+    struct JournalReplayResult
+    {
+        /// @brief The number of journaled operations applied by the replay.
+        std::size_t applied = 0;
+        /// @brief The number of inserts that had already reached the server before the crash.
+        std::size_t already_applied = 0;
+        /// @brief Messages of operations the server rejected. They are not retried.
+        std::vector<std::string> errors;
+
+        /// @brief Checks whether every journaled operation was applied.
+        bool ok() const { return errors.empty(); }
+    };
+
+    /// @brief A crash-safe append log in a memory-mapped segment file.
+    ///
+    /// Each record is a BSON document framed by its length and a CRC-32, written into a fixed-size file
+    /// mapped with MAP_SHARED, so an appended record survives a crash of the process as soon as append()
+    /// returns (and a power loss too when `sync` is set, at the cost of an msync per append). A header
+    /// stores where the live records begin: release() advances it once records have been applied, and the
+    /// file is rewound when no live record is left. On open, records are read up to the first empty or
+    /// corrupt frame, which drops a record torn by a crash.
+    ///
+    /// Positions returned by append() are logical and keep increasing when the file is rewound or compacted.
+    /// Only POSIX systems are supported. The class is thread-safe.
+    class Journal
+    {
+    public:
+        /// @brief The default file size of a new journal.
+        static constexpr std::size_t kDefaultCapacity = 64 * 1024 * 1024;
+
+        /// @brief Opens or creates a journal file and reads its live records.
+        /// @param path The file path.
+        /// @param capacity The file size. Zero keeps an existing file's size or uses kDefaultCapacity. An
+        /// existing file is grown if it is smaller, never shrunk.
+        /// @param sync True to msync every append and release, for durability across power loss.
+        /// @throws QDB::Exception if the file cannot be opened, sized or mapped, or is not a journal.
+        explicit Journal(const std::string &path, std::size_t capacity = 0, bool sync = false);
+
+        /// @brief Unmaps and closes the file. Live records stay in it.
+        ~Journal();
+
+        Journal(const Journal &) = delete;
+        Journal &operator=(const Journal &) = delete;
+
+        /// @brief Appends a record.
+        /// @param record The BSON document to store.
+        /// @return The logical position just past the record, for release().
+        /// @throws QDB::Exception if the record does not fit even after compaction. Compaction needs the live
+        /// records to fit in the space already released, so size the journal to at least twice the live data.
+        std::uint64_t append(const bsoncxx::document::view &record);
+
+        /// @brief Drops every record before a position returned by append().
+        /// @param position The logical position up to which records have been applied.
+        void release(std::uint64_t position);
+
+        /// @brief Drops every live record.
+        void clear();
+
+        /// @brief Copies the live records, oldest first.
+        std::vector<bsoncxx::document::value> records() const;
+
+        /// @brief Gets the logical position just past each live record, oldest first, for release().
+        std::vector<std::uint64_t> record_ends() const;
+
+        /// @brief Checks whether the journal holds no live record.
+        bool empty() const;
+
+        /// @brief Gets the file size.
+        std::size_t capacity() const { return _capacity; }
+
+        /// @brief Gets the file path.
+        const std::string &path() const { return _path; }
+
+    private:
+        /// @brief Moves the live records to the start of the file when they fit before their current
+        /// position. Requires the lock.
+        void compact();
+
+        /// @brief Writes the live-begin offset to the header. Requires the lock.
+        void store_begin();
+
+        /// @brief Flushes a byte range of the mapping to disk when `_sync` is set.
+        void sync_range(std::size_t offset, std::size_t length) const;
+
+        std::string _path;
+        std::size_t _capacity = 0;
+        bool _sync = false;
+        int _fd = -1;
+        unsigned char *_data = nullptr;
+
+        mutable std::mutex _mutex;
+        /// @brief The physical offset of the first live record.
+        std::size_t _begin = 0;
+        /// @brief The physical offset just past the last live record.
+        std::size_t _end = 0;
+        /// @brief Logical position minus physical offset.
+        std::uint64_t _shift = 0;
+    };
+} // namespace QDB
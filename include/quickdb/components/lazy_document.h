@@ -0,0 +1,103 @@
+#pragma once
+
+#include "quickdb/components/document.h"
+#include "quickdb/components/exception.h"
+#include "quickdb/components/field.h"
+
+#include <any>
+#include <map>
+#include <string>
+#include <typeindex>
+#include <utility>
+
+#include <bsoncxx/document/value.hpp>
+#include <bsoncxx/document/view.hpp>
+#include <bsoncxx/oid.hpp>
+
+namespace QDB
+{
+    /// @brief A read-only document that keeps the raw BSON returned by the server and decodes fields on demand.
+    ///
+    /// Each field is decoded the first time it is read and cached, so reading a few fields of a large
+    /// document only pays for those fields. Call materialize() to decode the whole document into T.
+    ///
+    /// The getters fill the cache, so a LazyDocument is not thread-safe even through a const reference.
+    /// @tparam T The document type (a subclass of QDB::Document) the BSON represents.
+    template <typename T> class LazyDocument
+    {
+    public:
+        /// @brief Constructs a LazyDocument that owns the given BSON buffer.
+        /// @param value The BSON document returned by the database.
+        explicit LazyDocument(bsoncxx::document::value value) : _value(std::move(value)) {}
+
+        /// @brief Gets a view of the underlying BSON document.
+        bsoncxx::document::view view() const { return _value.view(); }
+
+        /// @brief Gets the document's ObjectId.
+        /// @throws QDB::Exception if the document has no ObjectId `_id`.
+        bsoncxx::oid get_id() const
+        {
+            auto element = _value.view()["_id"];
+            if (!element || element.type() != bsoncxx::type::k_oid)
+            {
+                throw QDB::Exception("Lazy document has no ObjectId _id");
+            }
+            return element.get_oid().value;
+        }
+
+        /// @brief Checks whether the document contains a top-level field.
+        /// @param key The field name.
+        bool has_field(const std::string &key) const { return static_cast<bool>(_value.view()[key]); }
+
+        /// @brief Decodes (on first access) and returns a top-level field.
+        ///
+        /// Decoding follows the same rules as FieldValue::as<V>(): a field of a different BSON type yields
+        /// a default-constructed V. Each (key, V) pair is decoded and cached separately.
+        /// @tparam V The C++ type to decode into.
+        /// @param key The field name.
+        /// @return A reference to the cached value, valid for the lifetime of this LazyDocument.
+        /// @throws QDB::Exception if the field does not exist.
+        template <typename V> const V &get(const std::string &key) const
+        {
+            const auto cache_key = std::make_pair(key, std::type_index(typeid(V)));
+            if (auto it = _cache.find(cache_key); it != _cache.end())
+            {
+                return *std::any_cast<V>(&it->second);
+            }
+
+            auto element = _value.view()[key];
+            if (!element)
+            {
+                throw QDB::Exception("Field not found in lazy document: " + key);
+            }
+
+            V decoded{};
+            ReadBsonElement(element, decoded);
+            auto it = _cache.emplace(cache_key, std::any(std::move(decoded))).first;
+            return *std::any_cast<V>(&it->second);
+        }
+
+        /// @brief Decodes the whole document into T.
+        /// @return The fully deserialized document.
+        T materialize() const
+        {
+            T doc;
+            auto view = _value.view();
+            if (auto id = view["_id"]; id && id.type() == bsoncxx::type::k_oid)
+            {
+                doc._id = id.get_oid().value;
+            }
+            doc.from_bson(view);
+            return doc;
+        }
+
+    private:
+        /// @brief The raw BSON document owned by this object.
+        bsoncxx::document::value _value;
+
+        /// @brief Fields decoded so far, keyed by field name and type. Entries are never replaced, and the
+        /// map's nodes do not move, so references returned by get() stay valid.
+        mutable std::map<std::pair<std::string, std::type_index>, std::any> _cache;
+    };
+
+} // namespace QDB
@@ -0,0 +1,288 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <bsoncxx/document/value.hpp>
+#include <bsoncxx/document/view.hpp>
+
+namespace QDB
+{
+    /// @brief The operations a MetricsRegistry records, per collection.
+    enum class OperationKind : std::uint8_t
+    {
+        kCreateOne,
+        kCreateMany,
+        kFindOne,
+        kFindMany,
+        kFindOneLazy,
+        kFindManyLazy,
+        kFindStream,
+        kUpdateOne,
+        kUpdateMany,
+        kDeleteOne,
+        kDeleteMany,
+        kCountDocuments,
+        kAggregate,
+        kAggregateStream,
+        kFindOneAndUpdate,
+        kFindOneAndReplace,
+        kFindOneAndDelete,
+        kBulkWrite,
+        kWatch,
+        kCreateIndex,
+        kDropIndex,
+        kListIndexes,
+        kPoolAcquire, ///< Waiting for a pooled client.
+        kUpload,      ///< GridFS; the collection is the bucket name.
+        kDownload,    ///< GridFS; the collection is the bucket name.
+        kDeleteFile,  ///< GridFS; the collection is the bucket name.
+        kTransaction, ///< Database::with_transaction(), under an empty database and collection name.
+        kPing         ///< Database::ping(), under the "admin" database.
+    };
+
+    /// @brief The number of OperationKind values.
+    inline constexpr std::size_t kOperationCount = static_cast<std::size_t>(OperationKind::kPing) + 1;
+
+    /// @brief Gets the snake_case name of an operation, e.g. "find_many".
+    const char *operation_name(OperationKind operation);
+
+    /// @brief What one call measured. Filled in by OperationTimer.
+    struct OperationSample
+    {
+        std::chrono::nanoseconds latency{0};
+        bool failed = false;
+        std::uint64_t documents = 0;
+        std::uint64_t bytes_encoded = 0;
+        std::uint64_t bytes_decoded = 0;
+        std::chrono::nanoseconds encode_time{0};
+        std::chrono::nanoseconds decode_time{0};
+    };
+
+    /// @brief The merged counters of one operation on one collection.
+    struct OperationStats
+    {
+        std::string database;
+        std::string collection;
+        OperationKind operation = OperationKind::kFindOne;
+
+        /// @brief Completed calls, including failed ones.
+        std::uint64_t calls = 0;
+        /// @brief Calls that threw.
+        std::uint64_t errors = 0;
+        /// @brief Documents returned by reads, including cache hits, or sent by inserts and bulk writes.
+        std::uint64_t documents = 0;
+        /// @brief BSON bytes encoded from the documents, filters and updates sent.
+        std::uint64_t bytes_encoded = 0;
+        /// @brief BSON bytes of the documents received.
+        std::uint64_t bytes_decoded = 0;
+
+        /// @brief The sum of all call latencies.
+        std::chrono::nanoseconds total_time{0};
+        /// @brief Time spent encoding documents, filters and updates, included in total_time.
+        std::chrono::nanoseconds encode_time{0};
+        /// @brief Time spent decoding results into documents, included in total_time.
+        std::chrono::nanoseconds decode_time{0};
+
+        /// @brief Latency percentiles: the upper bound of the histogram bucket holding the percentile, which is
+        /// at most 1/8 above the true value, capped at max.
+        std::chrono::nanoseconds p50{0};
+        std::chrono::nanoseconds p99{0};
+        std::chrono::nanoseconds p999{0};
+        std::chrono::nanoseconds max{0};
+
+        /// @brief Gets the mean latency.
+        std::chrono::nanoseconds mean() const
+        {
+            return calls == 0 ? std::chrono::nanoseconds(0) : total_time / static_cast<std::int64_t>(calls);
+        }
+
+        /// @brief Gets the time left after encoding and decoding: driver, network and server time.
+        std::chrono::nanoseconds server_time() const { return total_time - encode_time - decode_time; }
+    };
+
+    /// @brief A point-in-time copy of a MetricsRegistry.
+    struct MetricsSnapshot
+    {
+        /// @brief Every operation called at least once, ordered by database, collection and operation.
+        std::vector<OperationStats> operations;
+
+        /// @brief Finds the counters of one operation.
+        /// @return The counters, or null if the operation was never called on the collection.
+        const OperationStats *find(const std::string &database, const std::string &collection,
+                                   OperationKind operation) const;
+
+        /// @brief Renders one line per operation, for logs.
+        std::string to_text() const;
+
+        /// @brief Renders `{"operations": [...]}` with one object per operation. Times are in nanoseconds.
+        std::string to_json() const;
+    };
+
+    class MetricsRegistry;
+
+    /// @brief Measures one call and records it when destroyed.
+    ///
+    /// A call is counted as failed when the timer is destroyed by a propagating exception. A timer from a
+    /// disabled CollectionMetrics does nothing and reads no clocks.
+    class OperationTimer
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /// @brief Starts timing. A null registry disables the timer.
+        OperationTimer(MetricsRegistry *registry, std::size_t series)
+            : _registry(registry), _series(series), _exceptions(std::uncaught_exceptions())
+        {
+            if (_registry)
+            {
+                _start = Clock::now();
+            }
+        }
+
+        /// @brief Records the call.
+        ~OperationTimer();
+
+        OperationTimer(const OperationTimer &) = delete;
+        OperationTimer &operator=(const OperationTimer &) = delete;
+
+        /// @brief Runs an encoder that returns a BSON document to send, recording its time and size.
+        template <typename Encode> bsoncxx::document::value encode(Encode &&encode)
+        {
+            if (!_registry)
+            {
+                return encode();
+            }
+            const auto start = Clock::now();
+            bsoncxx::document::value value = encode();
+            _sample.encode_time += Clock::now() - start;
+            _sample.bytes_encoded += value.view().length();
+            return value;
+        }
+
+        /// @brief Runs a decoder for one received document, recording its time and size.
+        template <typename Decode> decltype(auto) decode(const bsoncxx::document::view &view, Decode &&decode)
+        {
+            if (!_registry)
+            {
+                return decode();
+            }
+            _sample.bytes_decoded += view.length();
+            const auto start = Clock::now();
+            if constexpr (std::is_void_v<decltype(decode())>)
+            {
+                decode();
+                _sample.decode_time += Clock::now() - start;
+            }
+            else
+            {
+                auto document = decode();
+                _sample.decode_time += Clock::now() - start;
+                return document;
+            }
+        }
+
+        /// @brief Counts BSON bytes sent that were encoded outside encode(), e.g. a prebuilt pipeline.
+        void encoded(std::size_t bytes) { _sample.bytes_encoded += bytes; }
+
+        /// @brief Counts the BSON bytes of a document received but not decoded, e.g. kept as raw BSON.
+        void decoded(std::size_t bytes) { _sample.bytes_decoded += bytes; }
+
+        /// @brief Counts documents returned to the caller, or sent by an insert.
+        void documents(std::uint64_t count) { _sample.documents += count; }
+
+        /// @brief Drops the measurement, e.g. when the call turns out to be recorded by another timer.
+        void discard() { _registry = nullptr; }
+
+    private:
+        MetricsRegistry *_registry;
+        std::size_t _series;
+        int _exceptions;
+        Clock::time_point _start;
+        OperationSample _sample;
+    };
+
+    /// @brief A collection's handle into a MetricsRegistry. Cheap to copy; default-constructed, it is disabled.
+    class CollectionMetrics
+    {
+    public:
+        CollectionMetrics() = default;
+
+        /// @brief Constructed by MetricsRegistry::collection().
+        CollectionMetrics(MetricsRegistry *registry, std::size_t index) : _registry(registry), _index(index) {}
+
+        /// @brief Starts timing an operation on the collection.
+        OperationTimer time(OperationKind operation) const
+        {
+            return OperationTimer(_registry, _index * kOperationCount + static_cast<std::size_t>(operation));
+        }
+
+        /// @brief Gets the registry, or null when disabled.
+        MetricsRegistry *registry() const { return _registry; }
+
+    private:
+        MetricsRegistry *_registry = nullptr;
+        std::size_t _index = 0;
+    };
+
+    /// @brief Per-operation call counts, errors, latency histograms and byte counts, owned by a Database.
+    ///
+    /// Each thread records into its own shard with plain relaxed stores, so recording never takes a lock
+    /// or contends with other threads; snapshot() merges the shards. A shard is created the first time a
+    /// thread records, and kept (with its counts) until the registry is destroyed. Up to 1024 collections are
+    /// tracked; calls on further collections are not recorded.
+    class MetricsRegistry
+    {
+    public:
+        MetricsRegistry();
+        ~MetricsRegistry();
+
+        MetricsRegistry(const MetricsRegistry &) = delete;
+        MetricsRegistry &operator=(const MetricsRegistry &) = delete;
+
+        /// @brief Gets the handle that records operations on a collection. Takes a lock; resolve it once per
+        /// handle, not per call.
+        /// @param database The database name.
+        /// @param collection The collection name.
+        CollectionMetrics collection(const std::string &database, const std::string &collection);
+
+        /// @brief Records a call. Lock-free.
+        /// @param series The collection index times kOperationCount plus the operation.
+        /// @param sample What the call measured.
+        void record(std::size_t series, const OperationSample &sample);
+
+        /// @brief Merges every thread's shard. Calls still recording may be partly included.
+        MetricsSnapshot snapshot() const;
+
+        /// @brief The most collections a registry tracks.
+        static constexpr std::size_t kMaxCollections = 1024;
+
+    private:
+        struct Cell;
+        struct Shard;
+
+        /// @brief Gets the calling thread's shard, creating it on first use.
+        Shard &local_shard();
+
+        /// @brief Distinguishes registries in the threads' shard caches, since addresses are reused.
+        const std::uint64_t _uid;
+
+        mutable std::mutex _mutex;
+        /// @brief The index of each collection, by (database, collection).
+        std::map<std::pair<std::string, std::string>, std::size_t> _indexes;
+        /// @brief The names of each collection, by index.
+        std::vector<std::pair<std::string, std::string>> _names;
+        /// @brief Each recording thread's shard, by thread id.
+        std::map<std::thread::id, std::unique_ptr<Shard>> _shards;
+    };
+} // namespace QDB
@@ -2,14 +2,27 @@
 
 #include "quickdb/components/aggregation.h"
 #include "quickdb/components/field.h"
+#include "quickdb/components/query_shape.h"
 
 #include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/concatenate.hpp>
+#include <mongocxx/options/aggregate.hpp>
+#include <mongocxx/options/bulk_write.hpp>
+#include <mongocxx/options/change_stream.hpp>
 #include <mongocxx/options/find.hpp>
 #include <mongocxx/options/find_one_and_delete.hpp>
 #include <mongocxx/options/find_one_and_replace.hpp>
 #include <mongocxx/options/find_one_and_update.hpp>
+#include <mongocxx/options/insert.hpp>
 #include <mongocxx/options/update.hpp>
+#include <mongocxx/write_concern.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <optional>
+#include <string>
+#include <utility>
 
 namespace QDB
 {
@@ -21,6 +34,28 @@ namespace QDB
     {
     public:
         FindOptions() = default;
+        FindOptions(FindOptions &&) = default;
+        FindOptions &operator=(FindOptions &&) = default;
+
+        /// @brief Copies the options, including the sort specification (e.g. to hand them to an async task).
+        FindOptions(const FindOptions &other)
+            : _projection_builder(other._projection_builder), _limit(other._limit), _skip(other._skip),
+              _batch_size(other._batch_size), _max_await_time(other._max_await_time),
+              _schema_projection(other._schema_projection), _prefetch_depth(other._prefetch_depth),
+              _decode_threads(other._decode_threads)
+        {
+            _sort_builder.append(bsoncxx::builder::concatenate(other._sort_builder.view()));
+        }
+
+        FindOptions &operator=(const FindOptions &other)
+        {
+            if (this != &other)
+            {
+                FindOptions copy(other);
+                *this = std::move(copy);
+            }
+            return *this;
+        }
 
         /// @brief Adds a sort criterion to the query options.
         /// @param key The field to sort by.
@@ -59,6 +94,119 @@ namespace QDB
             return *this;
         }
 
+        /// @brief Sets the number of documents the server returns per batch.
+        ///
+        /// Mostly useful with find_stream(): smaller batches lower peak memory and return the first
+        /// document sooner, larger batches reduce round trips on long scans.
+        /// @param size The number of documents per batch.
+        /// @return A reference to the current object for chaining.
+        FindOptions &batch_size(int32_t size)
+        {
+            _batch_size = size;
+            return *this;
+        }
+
+        /// @brief Sets how long the server waits for new documents before answering a getMore on a
+        /// tailable-await cursor.
+        /// @param max_await The maximum wait per getMore.
+        /// @return A reference to the current object for chaining.
+        FindOptions &max_await_time(std::chrono::milliseconds max_await)
+        {
+            _max_await_time = max_await;
+            return *this;
+        }
+
+        /// @brief Reads and decodes results on a background thread, up to `depth` batches ahead of the caller.
+        ///
+        /// Applies to find_many() and find_stream(). The worker fetches the next batch and decodes it while
+        /// the caller processes the current one; a bounded queue stops it from running further ahead. The
+        /// collection must not be used for other operations until the results have been consumed.
+        /// @param depth The number of decoded batches that may be buffered. Zero disables prefetching.
+        /// @return A reference to the current object for chaining.
+        FindOptions &prefetch(std::size_t depth = 2)
+        {
+            _prefetch_depth = depth;
+            return *this;
+        }
+
+        /// @brief Gets the number of batches to prefetch (zero when prefetching is off).
+        std::size_t prefetch_depth() const { return _prefetch_depth; }
+
+        /// @brief Decodes results on `threads` worker threads instead of the calling thread.
+        ///
+        /// Applies to find_many() and find_stream(). A background reader copies each batch's raw BSON off
+        /// the cursor and the workers decode whole batches in parallel; results keep the cursor's order.
+        /// Worth enabling for large, decode-heavy result sets. The collection must not be used for other
+        /// operations until the results have been consumed.
+        /// @param threads The number of decode threads. Zero or one decodes on a single thread.
+        /// @return A reference to the current object for chaining.
+        FindOptions &decode_threads(std::size_t threads)
+        {
+            _decode_threads = threads;
+            return *this;
+        }
+
+        /// @brief Gets the number of decode threads.
+        std::size_t get_decode_threads() const { return _decode_threads; }
+
+        /// @brief Gets the configured batch size, if any.
+        std::optional<int32_t> get_batch_size() const { return _batch_size; }
+
+        /// @brief Gets the configured skip, if any.
+        std::optional<int64_t> get_skip() const { return _skip; }
+
+        /// @brief Renders the options that affect which documents are returned (projection, sort, limit and
+        /// skip) in canonical form. The sort keeps its order. See canonical_document().
+        /// @param mode Whether literal values are kept or replaced by `?`.
+        /// @return The canonical form.
+        std::string canonical(ShapeMode mode = ShapeMode::kWithValues) const
+        {
+            using bsoncxx::builder::basic::kvp;
+            bsoncxx::builder::basic::document builder;
+            if (_projection_builder)
+            {
+                builder.append(kvp("projection", _projection_builder->view()));
+            }
+            if (_schema_projection)
+            {
+                builder.append(kvp("schemaProjection", true));
+            }
+            if (!_sort_builder.view().empty())
+            {
+                builder.append(kvp("sort", _sort_builder.view()));
+            }
+            if (_limit.has_value())
+            {
+                builder.append(kvp("limit", _limit.value()));
+            }
+            if (_skip.has_value())
+            {
+                builder.append(kvp("skip", _skip.value()));
+            }
+            return canonical_document(builder.view(), mode);
+        }
+
+        /// @brief Gets a 64-bit hash of canonical().
+        std::uint64_t hash(ShapeMode mode = ShapeMode::kWithValues) const { return shape_hash(canonical(mode)); }
+
+        /// @brief Requests only the fields declared by the document type's schema (QDB::Model types only).
+        ///
+        /// The projection is derived from `Derived::schema` and cached per type. It is ignored when an
+        /// explicit projection() is set, and for document types that do not declare a schema.
+        /// @param enabled True to project by schema.
+        /// @return A reference to the current object for chaining.
+        FindOptions &schema_projection(bool enabled = true)
+        {
+            _schema_projection = enabled;
+            return *this;
+        }
+
+        /// @brief Checks whether schema projection has been requested.
+        bool uses_schema_projection() const { return _schema_projection; }
+
+        /// @brief Checks whether an explicit projection has been set.
+        bool has_projection() const { return _projection_builder.has_value(); }
+
         /// @brief Gets the underlying mongocxx::options::find object.
         /// @return The configured mongocxx::options::find object.
         mongocxx::options::find to_mongocxx() const
@@ -80,6 +228,14 @@ namespace QDB
             {
                 opts.projection(_projection_builder->view());
             }
+            if (_batch_size.has_value())
+            {
+                opts.batch_size(_batch_size.value());
+            }
+            if (_max_await_time.has_value())
+            {
+                opts.max_await_time(_max_await_time.value());
+            }
             return opts;
         }
 
@@ -92,6 +248,111 @@ namespace QDB
         std::optional<int64_t> _limit;
         /// @brief Optional number of documents to skip.
         std::optional<int64_t> _skip;
+        /// @brief Optional number of documents per server batch.
+        std::optional<int32_t> _batch_size;
+        /// @brief Optional maximum wait per getMore on tailable-await cursors.
+        std::optional<std::chrono::milliseconds> _max_await_time;
+        /// @brief Whether to project by the document type's schema.
+        bool _schema_projection = false;
+        /// @brief The number of decoded batches to buffer on a background thread.
+        std::size_t _prefetch_depth = 0;
+        /// @brief The number of threads decoding results.
+        std::size_t _decode_threads = 1;
+    };
+
+    /// @brief A class for specifying options for aggregation operations.
+    class AggregateOptions
+    {
+    public:
+        AggregateOptions() = default;
+
+        /// @brief Sets the number of documents the server returns per batch.
+        /// @param size The number of documents per batch.
+        /// @return A reference to the current object for chaining.
+        AggregateOptions &batch_size(int32_t size)
+        {
+            _batch_size = size;
+            return *this;
+        }
+
+        /// @brief Sets how long the server waits for new documents before answering a getMore
+        /// (for pipelines that produce a tailable cursor, e.g. $changeStream).
+        /// @param max_await The maximum wait per getMore.
+        /// @return A reference to the current object for chaining.
+        AggregateOptions &max_await_time(std::chrono::milliseconds max_await)
+        {
+            _max_await_time = max_await;
+            return *this;
+        }
+
+        /// @brief Allows pipeline stages to write temporary files when they exceed the memory limit.
+        /// @param allow True to allow disk use.
+        /// @return A reference to the current object for chaining.
+        AggregateOptions &allow_disk_use(bool allow)
+        {
+            _allow_disk_use = allow;
+            return *this;
+        }
+
+        /// @brief Reads and decodes results on a background thread, up to `depth` batches ahead of the caller.
+        /// See FindOptions::prefetch().
+        /// @param depth The number of decoded batches that may be buffered. Zero disables prefetching.
+        /// @return A reference to the current object for chaining.
+        AggregateOptions &prefetch(std::size_t depth = 2)
+        {
+            _prefetch_depth = depth;
+            return *this;
+        }
+
+        /// @brief Gets the number of batches to prefetch (zero when prefetching is off).
+        std::size_t prefetch_depth() const { return _prefetch_depth; }
+
+        /// @brief Decodes results on `threads` worker threads. See FindOptions::decode_threads().
+        /// @param threads The number of decode threads. Zero or one decodes on a single thread.
+        /// @return A reference to the current object for chaining.
+        AggregateOptions &decode_threads(std::size_t threads)
+        {
+            _decode_threads = threads;
+            return *this;
+        }
+
+        /// @brief Gets the number of decode threads.
+        std::size_t get_decode_threads() const { return _decode_threads; }
+
+        /// @brief Gets the configured batch size, if any.
+        std::optional<int32_t> get_batch_size() const { return _batch_size; }
+
+        /// @brief Gets the underlying mongocxx::options::aggregate object.
+        /// @return The configured mongocxx::options::aggregate object.
+        mongocxx::options::aggregate to_mongocxx() const
+        {
+            mongocxx::options::aggregate opts{};
+            if (_batch_size.has_value())
+            {
+                opts.batch_size(_batch_size.value());
+            }
+            if (_max_await_time.has_value())
+            {
+                opts.max_await_time(_max_await_time.value());
+            }
+            if (_allow_disk_use.has_value())
+            {
+                opts.allow_disk_use(_allow_disk_use.value());
+            }
+            return opts;
+        }
+
+    private:
+        /// @brief Optional number of documents per server batch.
+        std::optional<int32_t> _batch_size;
+        /// @brief Optional maximum wait per getMore.
+        std::optional<std::chrono::milliseconds> _max_await_time;
+        /// @brief Optional flag allowing stages to spill to disk.
+        std::optional<bool> _allow_disk_use;
+        /// @brief The number of decoded batches to buffer on a background thread.
+        std::size_t _prefetch_depth = 0;
+        /// @brief The number of threads decoding results.
+        std::size_t _decode_threads = 1;
     };
 
     /// @brief A class for specifying options for update operations.
@@ -126,6 +387,601 @@ namespace QDB
         std::optional<bool> _upsert;
     };
 
+    /// @brief A class for specifying options for insert operations (create_one / create_many).
+    class InsertOptions
+    {
+    public:
+        InsertOptions() = default;
+
+        /// @brief Sends each document's client-side ObjectId instead of letting the server assign one.
+        ///
+        /// A document's `_id` is generated when it is constructed; it is sent as the first field, so no
+        /// server reply is needed to learn it. Retrying the same document object is idempotent (a retried
+        /// insert fails with a duplicate key instead of creating a second copy), and unacknowledged inserts
+        /// know their ids.
+        /// @param enabled True to generate ids client-side.
+        /// @return A reference to the current object for chaining.
+        InsertOptions &generate_ids(bool enabled = true)
+        {
+            _generate_ids = enabled;
+            return *this;
+        }
+
+        /// @brief Sends the insert with an unacknowledged (w:0) write concern.
+        ///
+        /// The call returns as soon as the write is sent and server-side errors are not reported. Combine
+        /// with generate_ids() to know the inserted ids.
+        /// @param enabled True for an unacknowledged write.
+        /// @return A reference to the current object for chaining.
+        InsertOptions &unacknowledged(bool enabled = true)
+        {
+            _unacknowledged = enabled;
+            return *this;
+        }
+
+        /// @brief Sets whether a multi-document insert stops at the first error (the default).
+        /// @param is_ordered True for ordered inserts.
+        /// @return A reference to the current object for chaining.
+        InsertOptions &ordered(bool is_ordered)
+        {
+            _ordered = is_ordered;
+            return *this;
+        }
+
+        /// @brief Checks whether ids are generated client-side.
+        bool generates_ids() const { return _generate_ids; }
+
+        /// @brief Checks whether the write is unacknowledged.
+        bool is_unacknowledged() const { return _unacknowledged; }
+
+        /// @brief Gets the underlying mongocxx::options::insert object.
+        /// @return The configured mongocxx::options::insert object.
+        mongocxx::options::insert to_mongocxx() const
+        {
+            mongocxx::options::insert opts{};
+            if (_unacknowledged)
+            {
+                mongocxx::write_concern concern{};
+                concern.acknowledge_level(mongocxx::write_concern::level::k_unacknowledged);
+                opts.write_concern(concern);
+            }
+            if (_ordered.has_value())
+            {
+                opts.ordered(_ordered.value());
+            }
+            return opts;
+        }
+
+    private:
+        /// @brief Whether ids are generated client-side.
+        bool _generate_ids = false;
+        /// @brief Whether the write is unacknowledged.
+        bool _unacknowledged = false;
+        /// @brief Optional flag for ordered multi-document inserts.
+        std::optional<bool> _ordered;
+    };
+
+    /// @brief A class for specifying options for pipelined inserts (see SharedCollection::create_many_pipelined).
+    class PipelinedInsertOptions
+    {
+    public:
+        PipelinedInsertOptions() = default;
+
+        /// @brief Sets the number of documents sent per insert_many batch.
+        /// @param size The number of documents per batch (defaults to 1000).
+        /// @return A reference to the current object for chaining.
+        PipelinedInsertOptions &chunk_size(std::size_t size)
+        {
+            _chunk_size = size == 0 ? 1 : size;
+            return *this;
+        }
+
+        /// @brief Sets the maximum number of batches in flight at once. Each in-flight batch uses its own
+        /// pooled connection and worker thread.
+        /// @param count The maximum number of concurrent batches (defaults to 4).
+        /// @return A reference to the current object for chaining.
+        PipelinedInsertOptions &max_in_flight(std::size_t count)
+        {
+            _max_in_flight = count == 0 ? 1 : count;
+            return *this;
+        }
+
+        /// @brief Gets the number of documents per batch.
+        std::size_t get_chunk_size() const { return _chunk_size; }
+
+        /// @brief Gets the maximum number of concurrent batches.
+        std::size_t get_max_in_flight() const { return _max_in_flight; }
+
+    private:
+        /// @brief The number of documents per batch.
+        std::size_t _chunk_size = 1000;
+        /// @brief The maximum number of concurrent batches.
+        std::size_t _max_in_flight = 4;
+    };
+
+    /// @brief A class for specifying options for bulk writes (see BulkWriter).
+    class BulkWriteOptions
+    {
+    public:
+        /// @brief The server's maxWriteBatchSize: the most operations one write command may carry.
+        static constexpr std::size_t kMaxWriteBatchSize = 100000;
+        /// @brief The server's maxMessageSizeBytes: the largest message one write command may use.
+        static constexpr std::size_t kMaxMessageSizeBytes = 48000000;
+
+        BulkWriteOptions() = default;
+
+        /// @brief Sets whether operations run in order, stopping at the first error (the default).
+        /// Unordered writes let the server apply operations in any order and continue past errors,
+        /// which gives the highest throughput.
+        /// @param is_ordered True for ordered execution, false for unordered.
+        /// @return A reference to the current object for chaining.
+        BulkWriteOptions &ordered(bool is_ordered)
+        {
+            _ordered = is_ordered;
+            return *this;
+        }
+
+        /// @brief Lets the write bypass the collection's schema validation.
+        /// @param bypass True to bypass document validation.
+        /// @return A reference to the current object for chaining.
+        BulkWriteOptions &bypass_document_validation(bool bypass)
+        {
+            _bypass_document_validation = bypass;
+            return *this;
+        }
+
+        /// @brief Caps the number of operations sent per write command (at most kMaxWriteBatchSize).
+        /// @param max_ops The maximum number of operations per batch.
+        /// @return A reference to the current object for chaining.
+        BulkWriteOptions &max_batch_ops(std::size_t max_ops)
+        {
+            _max_batch_ops = max_ops;
+            return *this;
+        }
+
+        /// @brief Caps the estimated BSON bytes sent per write command (at most kMaxMessageSizeBytes).
+        /// @param max_bytes The maximum number of bytes per batch.
+        /// @return A reference to the current object for chaining.
+        BulkWriteOptions &max_batch_bytes(std::size_t max_bytes)
+        {
+            _max_batch_bytes = max_bytes;
+            return *this;
+        }
+
+        /// @brief Checks whether operations run in order.
+        bool is_ordered() const { return _ordered; }
+
+        /// @brief Gets the effective operation limit per batch.
+        std::size_t batch_ops() const
+        {
+            return _max_batch_ops == 0 ? kMaxWriteBatchSize : std::min(_max_batch_ops, kMaxWriteBatchSize);
+        }
+
+        /// @brief Gets the effective byte limit per batch.
+        std::size_t batch_bytes() const
+        {
+            return _max_batch_bytes == 0 ? kMaxMessageSizeBytes : std::min(_max_batch_bytes, kMaxMessageSizeBytes);
+        }
+
+        /// @brief Gets the underlying mongocxx::options::bulk_write object.
+        /// @return The configured mongocxx::options::bulk_write object.
+        mongocxx::options::bulk_write to_mongocxx() const
+        {
+            mongocxx::options::bulk_write opts{};
+            opts.ordered(_ordered);
+            if (_bypass_document_validation.has_value())
+            {
+                opts.bypass_document_validation(_bypass_document_validation.value());
+            }
+            return opts;
+        }
+
+    private:
+        /// @brief Whether operations run in order.
+        bool _ordered = true;
+        /// @brief Optional flag to bypass document validation.
+        std::optional<bool> _bypass_document_validation;
+        /// @brief The operation limit per batch (zero = the server's limit).
+        std::size_t _max_batch_ops = 0;
+        /// @brief The byte limit per batch (zero = the server's limit).
+        std::size_t _max_batch_bytes = 0;
+    };
+
+    /// @brief A class for specifying options for a ResultCache.
+    class ResultCacheOptions
+    {
+    public:
+        ResultCacheOptions() = default;
+
+        /// @brief Sets how long a result may be served after it was computed.
+        /// @param ttl The time to live (defaults to 5 seconds).
+        /// @return A reference to the current object for chaining.
+        ResultCacheOptions &ttl(std::chrono::milliseconds ttl)
+        {
+            _ttl = ttl;
+            return *this;
+        }
+
+        /// @brief Sets the maximum number of cached results. The least recently used are evicted first.
+        /// @param entries The capacity (defaults to 1000).
+        /// @return A reference to the current object for chaining.
+        ResultCacheOptions &max_entries(std::size_t entries)
+        {
+            _max_entries = entries;
+            return *this;
+        }
+
+        /// @brief Gets the time to live.
+        std::chrono::milliseconds get_ttl() const { return _ttl; }
+
+        /// @brief Gets the capacity.
+        std::size_t get_max_entries() const { return _max_entries; }
+
+    private:
+        /// @brief The time to live.
+        std::chrono::milliseconds _ttl{5000};
+        /// @brief The capacity.
+        std::size_t _max_entries = 1000;
+    };
+
+    /// @brief A class for specifying options for a DocumentCache.
+    class CacheOptions
+    {
+    public:
+        CacheOptions() = default;
+
+        /// @brief Sets the maximum number of cached documents. The least recently used are evicted first.
+        /// @param entries The capacity (defaults to 10000).
+        /// @return A reference to the current object for chaining.
+        CacheOptions &max_entries(std::size_t entries)
+        {
+            _max_entries = entries;
+            return *this;
+        }
+
+        /// @brief Sets how long a cached document may be served after it was read.
+        /// @param ttl The time to live (defaults to 60 seconds).
+        /// @return A reference to the current object for chaining.
+        CacheOptions &ttl(std::chrono::milliseconds ttl)
+        {
+            _ttl = ttl;
+            return *this;
+        }
+
+        /// @brief Sets the number of independently locked shards.
+        /// @param shards The shard count (defaults to 16).
+        /// @return A reference to the current object for chaining.
+        CacheOptions &shards(std::size_t shards)
+        {
+            _shards = shards == 0 ? 1 : shards;
+            return *this;
+        }
+
+        /// @brief Sets whether a change stream evicts documents changed by other clients.
+        ///
+        /// Change streams need a replica set or sharded cluster. Without one, writes made elsewhere are only
+        /// picked up when entries expire.
+        /// @param enabled True to watch the collection (the default).
+        /// @return A reference to the current object for chaining.
+        CacheOptions &watch_changes(bool enabled)
+        {
+            _watch_changes = enabled;
+            return *this;
+        }
+
+        /// @brief Sets how long to wait before reopening a failed change stream.
+        /// @param interval The retry interval (defaults to 1 second).
+        /// @return A reference to the current object for chaining.
+        CacheOptions &retry_interval(std::chrono::milliseconds interval)
+        {
+            _retry_interval = interval;
+            return *this;
+        }
+
+        /// @brief Gets the capacity.
+        std::size_t get_max_entries() const { return _max_entries; }
+
+        /// @brief Gets the time to live.
+        std::chrono::milliseconds get_ttl() const { return _ttl; }
+
+        /// @brief Gets the shard count.
+        std::size_t get_shards() const { return _shards; }
+
+        /// @brief Checks whether a change stream evicts changed documents.
+        bool watches_changes() const { return _watch_changes; }
+
+        /// @brief Gets the change stream retry interval.
+        std::chrono::milliseconds get_retry_interval() const { return _retry_interval; }
+
+    private:
+        /// @brief The capacity.
+        std::size_t _max_entries = 10000;
+        /// @brief The time to live.
+        std::chrono::milliseconds _ttl{60000};
+        /// @brief The shard count.
+        std::size_t _shards = 16;
+        /// @brief Whether a change stream evicts changed documents.
+        bool _watch_changes = true;
+        /// @brief The change stream retry interval.
+        std::chrono::milliseconds _retry_interval{1000};
+    };
+
+    /// @brief A class for specifying options for a BatchLoader.
+    class BatchLoaderOptions
+    {
+    public:
+        BatchLoaderOptions() = default;
+
+        /// @brief Sets how long the first id of a batch waits for others to join it.
+        /// @param window The collection window (defaults to 2 milliseconds).
+        /// @return A reference to the current object for chaining.
+        BatchLoaderOptions &window(std::chrono::microseconds window)
+        {
+            _window = window;
+            return *this;
+        }
+
+        /// @brief Sets the number of distinct ids that sends a batch before its window ends.
+        /// @param size The maximum batch size (defaults to 100).
+        /// @return A reference to the current object for chaining.
+        BatchLoaderOptions &max_batch_size(std::size_t size)
+        {
+            _max_batch_size = size == 0 ? 1 : size;
+            return *this;
+        }
+
+        /// @brief Gets the collection window.
+        std::chrono::microseconds get_window() const { return _window; }
+
+        /// @brief Gets the maximum batch size.
+        std::size_t get_max_batch_size() const { return _max_batch_size; }
+
+    private:
+        /// @brief The collection window.
+        std::chrono::microseconds _window{2000};
+        /// @brief The maximum batch size.
+        std::size_t _max_batch_size = 100;
+    };
+
+    /// @brief A class for specifying options for a WriteBuffer.
+    class WriteBufferOptions
+    {
+    public:
+        WriteBufferOptions() = default;
+
+        /// @brief Sets the number of buffered operations that triggers a flush.
+        /// @param count The operation count threshold (defaults to 1000).
+        /// @return A reference to the current object for chaining.
+        WriteBufferOptions &max_documents(std::size_t count)
+        {
+            _max_documents = count == 0 ? 1 : count;
+            return *this;
+        }
+
+        /// @brief Sets the estimated BSON bytes of buffered operations that trigger a flush.
+        /// @param bytes The byte threshold (defaults to 4 MiB).
+        /// @return A reference to the current object for chaining.
+        WriteBufferOptions &max_bytes(std::size_t bytes)
+        {
+            _max_bytes = bytes == 0 ? 1 : bytes;
+            return *this;
+        }
+
+        /// @brief Sets the longest an operation may wait in the buffer before a flush is started.
+        /// @param delay The maximum delay (defaults to one second).
+        /// @return A reference to the current object for chaining.
+        WriteBufferOptions &max_delay(std::chrono::milliseconds delay)
+        {
+            _max_delay = delay;
+            return *this;
+        }
+
+        /// @brief Bounds the memory held by buffered and in-flight operations. When the bound is reached,
+        /// new operations block until a flush completes.
+        /// @param bytes The maximum estimated bytes (defaults to 64 MiB).
+        /// @return A reference to the current object for chaining.
+        WriteBufferOptions &max_pending_bytes(std::size_t bytes)
+        {
+            _max_pending_bytes = bytes == 0 ? 1 : bytes;
+            return *this;
+        }
+
+        /// @brief Sets the options of the bulk writes used to flush.
+        ///
+        /// Ordered by default, so an update is applied after the inserts buffered before it; an error stops
+        /// the rest of its flush, and those operations are reported as not executed. Set ordered(false) for
+        /// independent writes, such as inserts only, to let the server apply them in any order and continue
+        /// past errors.
+        /// @param options The bulk write options.
+        /// @return A reference to the current object for chaining.
+        WriteBufferOptions &bulk_options(const BulkWriteOptions &options)
+        {
+            _bulk_options = options;
+            return *this;
+        }
+
+        /// @brief Journals every operation to a local memory-mapped file before it is accepted, so buffered
+        /// writes survive a crash of the process (see Journal). Replay the file with Database::replay_journal()
+        /// before creating the buffer. While the server is unreachable, journaled flushes are retried
+        /// instead of dropped.
+        /// @param path The journal file path. Empty disables journaling (the default).
+        /// @param sync True to also msync each operation, which survives power loss but is much slower.
+        /// @return A reference to the current object for chaining.
+        WriteBufferOptions &journal(std::string path, bool sync = false)
+        {
+            _journal_path = std::move(path);
+            _journal_sync = sync;
+            return *this;
+        }
+
+        /// @brief Sets how long a journaled buffer waits before retrying a flush that could not reach the server.
+        /// @param interval The retry interval (defaults to one second).
+        /// @return A reference to the current object for chaining.
+        WriteBufferOptions &retry_interval(std::chrono::milliseconds interval)
+        {
+            _retry_interval = interval;
+            return *this;
+        }
+
+        /// @brief Gets the operation count that triggers a flush.
+        std::size_t get_max_documents() const { return _max_documents; }
+
+        /// @brief Gets the byte size that triggers a flush.
+        std::size_t get_max_bytes() const { return _max_bytes; }
+
+        /// @brief Gets the maximum time an operation waits before a flush.
+        std::chrono::milliseconds get_max_delay() const { return _max_delay; }
+
+        /// @brief Gets the bound on buffered and in-flight bytes.
+        std::size_t get_max_pending_bytes() const { return _max_pending_bytes; }
+
+        /// @brief Gets the options of the flushing bulk writes.
+        const BulkWriteOptions &get_bulk_options() const { return _bulk_options; }
+
+        /// @brief Gets the journal file path, or an empty string when journaling is off.
+        const std::string &get_journal_path() const { return _journal_path; }
+
+        /// @brief Checks whether each journaled operation is synced to disk.
+        bool is_journal_synced() const { return _journal_sync; }
+
+        /// @brief Gets the interval between retries of unreachable journaled flushes.
+        std::chrono::milliseconds get_retry_interval() const { return _retry_interval; }
+
+    private:
+        /// @brief The operation count that triggers a flush.
+        std::size_t _max_documents = 1000;
+        /// @brief The byte size that triggers a flush.
+        std::size_t _max_bytes = 4 * 1024 * 1024;
+        /// @brief The maximum time an operation waits before a flush.
+        std::chrono::milliseconds _max_delay{1000};
+        /// @brief The bound on buffered and in-flight bytes.
+        std::size_t _max_pending_bytes = 64 * 1024 * 1024;
+        /// @brief The options of the flushing bulk writes.
+        BulkWriteOptions _bulk_options;
+        /// @brief The journal file path, empty when journaling is off.
+        std::string _journal_path;
+        /// @brief Whether each journaled operation is synced to disk.
+        bool _journal_sync = false;
+        /// @brief The interval between retries of unreachable journaled flushes.
+        std::chrono::milliseconds _retry_interval{1000};
+    };
+
+    /// @brief Which full document a change stream attaches to update events.
+    enum class FullDocument
+    {
+        kDefault,       ///< Only inserts and replaces carry the full document.
+        kUpdateLookup,  ///< Updates carry the current version of the document, looked up when the event is read.
+        kWhenAvailable, ///< Updates carry the post-image when the collection records one (MongoDB 6.0+).
+        kRequired       ///< Like kWhenAvailable, but the stream fails when a post-image is missing.
+    };
+
+    /// @brief A class for specifying options for Collection::watch().
+    class ChangeStreamOptions
+    {
+    public:
+        ChangeStreamOptions() = default;
+
+        /// @brief Sets which full document update events carry.
+        /// @param mode The full document mode, e.g. FullDocument::kUpdateLookup.
+        /// @return A reference to the current object for chaining.
+        ChangeStreamOptions &full_document(FullDocument mode)
+        {
+            _full_document = mode;
+            return *this;
+        }
+
+        /// @brief Resumes a stream after the event a resume token was taken from.
+        /// @param token A token from ChangeStream::resume_token() or ChangeEvent::resume_token.
+        /// @return A reference to the current object for chaining.
+        ChangeStreamOptions &resume_after(const bsoncxx::document::view &token)
+        {
+            _resume_after = bsoncxx::document::value(token);
+            _start_after.reset();
+            return *this;
+        }
+
+        /// @brief Like resume_after(), but also accepts the token of an invalidate event (MongoDB 4.2+).
+        /// @param token The resume token.
+        /// @return A reference to the current object for chaining.
+        ChangeStreamOptions &start_after(const bsoncxx::document::view &token)
+        {
+            _start_after = bsoncxx::document::value(token);
+            _resume_after.reset();
+            return *this;
+        }
+
+        /// @brief Sets the number of events the server returns per batch.
+        /// @param size The batch size.
+        /// @return A reference to the current object for chaining.
+        ChangeStreamOptions &batch_size(int32_t size)
+        {
+            _batch_size = size;
+            return *this;
+        }
+
+        /// @brief Sets how long the server waits for new events before returning an empty batch.
+        /// @param max_await The maximum wait per batch.
+        /// @return A reference to the current object for chaining.
+        ChangeStreamOptions &max_await_time(std::chrono::milliseconds max_await)
+        {
+            _max_await_time = max_await;
+            return *this;
+        }
+
+        /// @brief Gets the full document mode.
+        FullDocument get_full_document() const { return _full_document; }
+
+        /// @brief Gets the underlying mongocxx::options::change_stream object.
+        /// @return The configured mongocxx::options::change_stream object. It refers to this object's tokens.
+        mongocxx::options::change_stream to_mongocxx() const
+        {
+            mongocxx::options::change_stream opts{};
+            switch (_full_document)
+            {
+            case FullDocument::kUpdateLookup:
+                opts.full_document("updateLookup");
+                break;
+            case FullDocument::kWhenAvailable:
+                opts.full_document("whenAvailable");
+                break;
+            case FullDocument::kRequired:
+                opts.full_document("required");
+                break;
+            case FullDocument::kDefault:
+                break;
+            }
+            if (_resume_after)
+            {
+                opts.resume_after(_resume_after->view());
+            }
+            if (_start_after)
+            {
+                opts.start_after(_start_after->view());
+            }
+            if (_batch_size.has_value())
+            {
+                opts.batch_size(_batch_size.value());
+            }
+            if (_max_await_time.has_value())
+            {
+                opts.max_await_time(_max_await_time.value());
+            }
+            return opts;
+        }
+
+    private:
+        /// @brief The full document mode.
+        FullDocument _full_document = FullDocument::kDefault;
+        /// @brief The token to resume after, if any.
+        std::optional<bsoncxx::document::value> _resume_after;
+        /// @brief The token to start after, if any.
+        std::optional<bsoncxx::document::value> _start_after;
+        /// @brief Optional number of events per server batch.
+        std::optional<int32_t> _batch_size;
+        /// @brief Optional maximum wait per batch.
+        std::optional<std::chrono::milliseconds> _max_await_time;
+    };
+
     /// @brief Specifies whether a find-and-modify operation should return the document
     /// from before the modification or after.
     enum class ReturnDocument
@@ -194,4 +1050,83 @@ namespace QDB
         std::optional<ReturnDocument> _return_document;
     };
 
+    /// @brief A class for specifying options for a SlowOperationLog.
+    class SlowLogOptions
+    {
+    public:
+        SlowLogOptions() = default;
+
+        /// @brief Sets the file the log is appended to.
+        /// @param path The file path. It is created if missing.
+        /// @return A reference to the current object for chaining.
+        SlowLogOptions &path(std::string path)
+        {
+            _path = std::move(path);
+            return *this;
+        }
+
+        /// @brief Sets the duration from which a command is logged.
+        /// @param threshold The threshold (defaults to 100 ms). Zero logs every command.
+        /// @return A reference to the current object for chaining.
+        SlowLogOptions &threshold(std::chrono::microseconds threshold)
+        {
+            _threshold = threshold;
+            return *this;
+        }
+
+        /// @brief Sets whether failed commands are logged however fast they were.
+        /// @param enabled True to log every failure (the default).
+        /// @return A reference to the current object for chaining.
+        SlowLogOptions &log_failures(bool enabled)
+        {
+            _log_failures = enabled;
+            return *this;
+        }
+
+        /// @brief Sets how many commands may wait to be written. Further slow commands are dropped and counted.
+        /// @param commands The capacity, rounded up to a power of two (defaults to 4096).
+        /// @return A reference to the current object for chaining.
+        SlowLogOptions &capacity(std::size_t commands)
+        {
+            _capacity = commands == 0 ? 1 : commands;
+            return *this;
+        }
+
+        /// @brief Sets how often the background thread writes waiting commands to the file.
+        /// @param interval The flush interval (defaults to 200 ms).
+        /// @return A reference to the current object for chaining.
+        SlowLogOptions &flush_interval(std::chrono::milliseconds interval)
+        {
+            _flush_interval = interval;
+            return *this;
+        }
+
+        /// @brief Gets the file path.
+        const std::string &get_path() const { return _path; }
+
+        /// @brief Gets the threshold.
+        std::chrono::microseconds get_threshold() const { return _threshold; }
+
+        /// @brief Checks whether every failure is logged.
+        bool logs_failures() const { return _log_failures; }
+
+        /// @brief Gets the capacity.
+        std::size_t get_capacity() const { return _capacity; }
+
+        /// @brief Gets the flush interval.
+        std::chrono::milliseconds get_flush_interval() const { return _flush_interval; }
+
+    private:
+        /// @brief The file path.
+        std::string _path;
+        /// @brief The duration from which a command is logged.
+        std::chrono::microseconds _threshold{100000};
+        /// @brief Whether every failure is logged.
+        bool _log_failures = true;
+        /// @brief The number of commands that may wait to be written.
+        std::size_t _capacity = 4096;
+        /// @brief The flush interval.
+        std::chrono::milliseconds _flush_interval{200};
+    };
+
 } // namespace QDB
@@ -1,7 +1,11 @@
 #pragma once
 
 #include "quickdb/components/field.h"
+#include "quickdb/components/query_shape.h"
 
+#include <cstdint>
+#include <optional>
+#include <string>
 #include <vector>
 
 namespace QDB
@@ -251,7 +255,7 @@ namespace QDB
         Query &regex(const std::string &field, const std::string &pattern, const std::string &options = "")
         {
             // BSON format for regex is a nested document: { field: { $regex: 'pattern', $options: 'i' } }
-            std::unordered_map<std::string, FieldValue> regex_map;
+            FieldMap regex_map;
             regex_map["$regex"] = FieldValue(pattern);
             if (!options.empty())
             {
@@ -267,7 +271,7 @@ namespace QDB
         Query &text(const std::string &search_term)
         {
             // BSON format for text search: { $text: { $search: "term" } }
-            std::unordered_map<std::string, FieldValue> text_search_map;
+            FieldMap text_search_map;
             text_search_map["$search"] = FieldValue(search_term);
             _query_map["$text"] = FieldValue(text_search_map);
             return *this;
@@ -275,7 +279,40 @@ namespace QDB
 
         /// @brief Gets the underlying field map representing the query.
         /// @return A constant reference to the query's field map.
-        const std::unordered_map<std::string, FieldValue> &get_fields() const { return _query_map; }
+        const FieldMap &get_fields() const { return _query_map; }
+
+        /// @brief Renders the filter in canonical form, with keys in a normalized order. See canonical_document().
+        /// @param mode Whether literal values are kept or replaced by `?`.
+        /// @return The canonical form. Queries with equal forms select the same documents (kWithValues) or
+        /// have the same shape (kRedacted).
+        std::string canonical(ShapeMode mode = ShapeMode::kWithValues) const
+        {
+            bsoncxx::builder::basic::document builder;
+            for (const auto &[key, value] : _query_map)
+            {
+                AppendToDocument(builder, key, value);
+            }
+            return canonical_document(builder.view(), mode);
+        }
+
+        /// @brief Gets a 64-bit hash of canonical().
+        std::uint64_t hash(ShapeMode mode = ShapeMode::kWithValues) const { return shape_hash(canonical(mode)); }
+
+        /// @brief Gets the id of a query built by by_id().
+        /// @return The ObjectId if the query is exactly `{_id: <ObjectId>}`, std::nullopt otherwise.
+        std::optional<bsoncxx::oid> id_value() const
+        {
+            if (_query_map.size() != 1)
+            {
+                return std::nullopt;
+            }
+            auto it = _query_map.find("_id");
+            if (it == _query_map.end() || it->second.type() != FieldType::FT_OBJECT_ID)
+            {
+                return std::nullopt;
+            }
+            return it->second.as<bsoncxx::oid>();
+        }
 
     private:
         /// @brief Adds a simple key-value condition to the query map.
@@ -291,22 +328,21 @@ namespace QDB
         {
             // [FIX] This logic now correctly merges operator conditions instead of overwriting them.
             auto it = _query_map.find(field);
-            if (it != _query_map.end() && it->second.type == FieldType::FT_OBJECT)
+            if (it != _query_map.end() && it->second.type() == FieldType::FT_OBJECT)
             {
                 // If the field already has an operator, add the new one to the existing sub-document.
-                auto &map = std::get<std::unordered_map<std::string, FieldValue>>(it->second.value);
-                map[op] = fv;
+                it->second.set_member(op, fv);
             }
             else
             {
                 // Otherwise, create a new sub-document for the operator.
-                std::unordered_map<std::string, FieldValue> condition_map = {{op, fv}};
+                FieldMap condition_map = {{op, fv}};
                 _query_map[field] = FieldValue(condition_map);
             }
         }
 
         /// @brief The internal map holding the query conditions.
-        std::unordered_map<std::string, FieldValue> _query_map;
+        FieldMap _query_map;
     };
 
 } // namespace QDB
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <bsoncxx/array/view.hpp>
+#include <bsoncxx/document/view.hpp>
+
+namespace QDB
+{
+    /// @brief Whether a canonical form keeps literal values.
+    enum class ShapeMode
+    {
+        kWithValues, ///< Literals are kept, so equal forms select the same documents (result caching).
+        kRedacted    ///< Literals become `?`, so equal forms share a query shape (logging, metrics).
+    };
+
+    /// @brief Renders a filter, or any BSON document, in a canonical text form.
+    ///
+    /// Key order is normalized where it cannot change the result: the keys of the root document, of operator
+    /// documents (whose keys all start with `$`), and of `$match` and `$elemMatch` filters are sorted. Other
+    /// documents keep their order, because MongoDB compares embedded documents and applies sort specifications
+    /// in order. Arrays always keep their order. Scalars carry their BSON type, so `1`, `1L`, `1.0` and `"1"`
+    /// render differently. In kRedacted mode, scalars become `?` and arrays of scalars become `[?]`.
+    /// @param document The document to render.
+    /// @param mode Whether literal values are kept.
+    /// @param sort_root_keys False to keep the root document's key order too.
+    /// @return The canonical form.
+    std::string canonical_document(const bsoncxx::document::view &document, ShapeMode mode, bool sort_root_keys = true);
+
+    /// @brief Renders a BSON array, such as an aggregation pipeline, in canonical form. See canonical_document().
+    /// @param array The array to render.
+    /// @param mode Whether literal values are kept.
+    /// @return The canonical form.
+    std::string canonical_array(const bsoncxx::array::view &array, ShapeMode mode);
+
+    /// @brief Hashes a canonical form to 64 bits (FNV-1a).
+    /// @param canonical A string returned by canonical_document() or canonical_array().
+    /// @return The hash.
+    std::uint64_t shape_hash(std::string_view canonical);
+} // namespace QDB
@@ -2,14 +2,132 @@
 
 #include "quickdb/components/document.h"
 #include "quickdb/components/field.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 namespace QDB
 {
+    /// @brief Computes the 64-bit FNV-1a hash of a field name. Usable in constant expressions.
+    /// @param name The field name.
+    /// @return The hash value.
+    constexpr uint64_t field_hash(std::string_view name)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (char c : name)
+        {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    /// @brief Describes one member visited by a Model schema.
+    struct FieldDescriptor
+    {
+        /// @brief Decodes a BSON element into the member located at `target`.
+        using ReadFn = void (*)(const bsoncxx::document::element &element, void *target);
+
+        /// @brief The field name, owned so that FieldValue map lookups need no temporary string.
+        std::string name;
+        /// @brief field_hash() of the name.
+        uint64_t hash = 0;
+        /// @brief Byte offset of the member within the model object.
+        std::ptrdiff_t offset = 0;
+        /// @brief Type-specific decoder for the member.
+        ReadFn read = nullptr;
+    };
+
+    /// @brief The per-type table of schema fields, in schema order, with a hash index for key lookups.
+    class FieldKeyTable
+    {
+    public:
+        /// @brief Returned by find() when the key is not part of the schema.
+        static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+        /// @brief Appends a field. Call build_index() once all fields are added.
+        void add(std::string_view name, std::ptrdiff_t offset, FieldDescriptor::ReadFn read)
+        {
+            _fields.push_back(FieldDescriptor{std::string(name), field_hash(name), offset, read});
+        }
+
+        /// @brief Marks the table as unusable for offset-based decoding (a visited member is not inside the object).
+        void set_addressable(bool addressable) { _addressable = addressable; }
+
+        /// @brief Builds the open-addressing index over the field hashes.
+        void build_index()
+        {
+            size_t capacity = 4;
+            while (capacity < _fields.size() * 2)
+            {
+                capacity *= 2;
+            }
+            _slots.assign(capacity, 0);
+            for (size_t i = 0; i < _fields.size(); ++i)
+            {
+                size_t slot = static_cast<size_t>(_fields[i].hash) & (capacity - 1);
+                while (_slots[slot] != 0)
+                {
+                    slot = (slot + 1) & (capacity - 1);
+                }
+                _slots[slot] = static_cast<uint32_t>(i + 1);
+            }
+        }
+
+        /// @brief Finds the index of a field by name.
+        /// @param name The key to look up.
+        /// @param hint The index most likely to match (the one after the previous match), checked first.
+        /// @return The field index, or npos if the key is not part of the schema.
+        size_t find(std::string_view name, size_t hint = 0) const
+        {
+            const uint64_t hash = field_hash(name);
+            if (hint < _fields.size() && _fields[hint].hash == hash && _fields[hint].name == name)
+            {
+                return hint;
+            }
+            if (_slots.empty())
+            {
+                return npos;
+            }
+
+            const size_t mask = _slots.size() - 1;
+            for (size_t slot = static_cast<size_t>(hash) & mask; _slots[slot] != 0; slot = (slot + 1) & mask)
+            {
+                const FieldDescriptor &field = _fields[_slots[slot] - 1];
+                if (field.hash == hash && field.name == name)
+                {
+                    return _slots[slot] - 1;
+                }
+            }
+            return npos;
+        }
+
+        /// @brief Gets the descriptor at the given schema index.
+        const FieldDescriptor &operator[](size_t index) const { return _fields[index]; }
+
+        /// @brief Gets the number of fields in the schema.
+        size_t size() const { return _fields.size(); }
+
+        /// @brief Checks whether every member lives inside the model object, allowing offset-based decoding.
+        bool addressable() const { return _addressable; }
+
+    private:
+        std::vector<FieldDescriptor> _fields;
+        /// @brief Hash index: each slot holds a field index + 1, or 0 when empty.
+        std::vector<uint32_t> _slots;
+        bool _addressable = true;
+    };
+
     /**
      * @brief A template base class that uses a static schema method to implement serialization automatically.
      * * @tparam Derived The class inheriting from Model (CRTP pattern).
+     *
+     * from_bson() decodes through a FieldKeyTable captured once per type from a default-constructed probe, so
+     * `Derived::schema` must visit the same fields on every call. The other methods use the names it passes.
      */
     template <typename Derived> class Model : public Document
     {
@@ -23,7 +141,8 @@ namespace QDB
             std::unordered_map<std::string, FieldValue> fields;
 
             // Visitor lambda: Takes a name and a value, converts value to FieldValue, and stores it.
-            auto serializer = [&](const std::string &name, const auto &value) { fields[name] = FieldValue(value); };
+            auto serializer = [&](std::string_view name, const auto &value)
+            { fields[std::string(name)] = FieldValue(value); };
 
             // Call the static schema method of the Derived class
             // We cast *this to const Derived& because we are serializing (reading) the data.
@@ -32,6 +151,19 @@ namespace QDB
             return fields;
         }
 
+        /**
+         * @brief Serializes the object straight into a BSON builder using the defined schema.
+         * Unlike to_fields(), this does not build a FieldValue map or copy any member or key.
+         * @param builder The BSON (sub-)document builder to append to.
+         */
+        void to_bson(bsoncxx::builder::basic::sub_document &builder) const override
+        {
+            // Visitor lambda: Takes a name and a value and appends the value to the builder.
+            auto encoder = [&](std::string_view name, const auto &value) { AppendValueToDocument(builder, name, value); };
+
+            Derived::schema(static_cast<const Derived &>(*this), encoder);
+        }
+
         /**
          * @brief Deserializes a map of FieldValues into the object using the defined schema.
          * @param fields The map of fields from the database.
@@ -40,9 +172,9 @@ namespace QDB
         {
             // Visitor lambda: Takes a name and a reference to a class member.
             // Finds the name in the map and populates the member.
-            auto deserializer = [&](const std::string &name, auto &member)
+            auto deserializer = [&](std::string_view name, auto &member)
             {
-                auto it = fields.find(name);
+                auto it = fields.find(std::string(name));
                 if (it != fields.end())
                 {
                     // Use the helper as<T>() method from FieldValue to convert safely.
@@ -54,5 +186,113 @@ namespace QDB
             // We cast *this to Derived& because we are deserializing (writing) to the data.
             Derived::schema(static_cast<Derived &>(*this), deserializer);
         }
+
+        /**
+         * @brief Deserializes a BSON view straight into the object's members using the defined schema.
+         * The view is walked once; each key is looked up in the key table and decoded into its member.
+         * Elements that are not part of the schema (including _id) are skipped without being decoded.
+         * @param view The BSON document from the database.
+         */
+        void from_bson(const bsoncxx::document::view &view) override
+        {
+            const FieldKeyTable &keys = key_table();
+            if (!keys.addressable())
+            {
+                from_bson_by_schema(view);
+                return;
+            }
+
+            char *base = reinterpret_cast<char *>(static_cast<Derived *>(this));
+            size_t next = 0;
+            for (const auto &element : view)
+            {
+                auto key = element.key();
+                const size_t index = keys.find(std::string_view(key.data(), key.size()), next);
+                if (index == FieldKeyTable::npos)
+                {
+                    continue;
+                }
+                keys[index].read(element, base + keys[index].offset);
+                next = index + 1;
+            }
+        }
+
+        /**
+         * @brief Gets the table of schema fields for this type, built once on first use.
+         * @return The cached FieldKeyTable.
+         */
+        static const FieldKeyTable &key_table()
+        {
+            static const FieldKeyTable table = []()
+            {
+                FieldKeyTable result;
+                Derived probe{};
+                const char *base = reinterpret_cast<const char *>(&probe);
+
+                auto collector = [&](std::string_view name, auto &member)
+                {
+                    using MemberT = std::decay_t<decltype(member)>;
+                    const std::ptrdiff_t offset = reinterpret_cast<const char *>(&member) - base;
+                    if (offset < 0 || offset + sizeof(MemberT) > sizeof(Derived))
+                    {
+                        result.set_addressable(false);
+                    }
+                    result.add(name, offset, [](const bsoncxx::document::element &element, void *target)
+                               { ReadBsonElement(element, *static_cast<MemberT *>(target)); });
+                };
+
+                Derived::schema(probe, collector);
+                result.build_index();
+                return result;
+            }();
+            return table;
+        }
+
+        /**
+         * @brief Gets a projection that selects exactly the fields declared by the schema.
+         * The document is built once per type on first use and cached for the lifetime of the program.
+         * Collection applies it when FindOptions::schema_projection() is enabled.
+         * @return A BSON document of the form { field: 1, ... }.
+         */
+        static const bsoncxx::document::value &schema_projection()
+        {
+            static const bsoncxx::document::value projection = []()
+            {
+                const FieldKeyTable &keys = key_table();
+                bsoncxx::builder::basic::document builder;
+                for (size_t i = 0; i < keys.size(); ++i)
+                {
+                    builder.append(bsoncxx::builder::basic::kvp(keys[i].name, 1));
+                }
+                return builder.extract();
+            }();
+            return projection;
+        }
+
+    private:
+        /**
+         * @brief Schema-driven fallback for from_bson() when members cannot be located by offset.
+         * Assumes schema order and falls back to a key lookup for out-of-order or missing keys.
+         * @param view The BSON document from the database.
+         */
+        void from_bson_by_schema(const bsoncxx::document::view &view)
+        {
+            auto it = view.begin();
+            auto decoder = [&](std::string_view name, auto &member)
+            {
+                const bsoncxx::v_noabi::stdx::string_view key(name.data(), name.size());
+                if (it == view.end() || it->key() != key)
+                {
+                    it = view.find(key);
+                }
+                if (it != view.end())
+                {
+                    ReadBsonElement(*it, member);
+                    ++it;
+                }
+            };
+
+            Derived::schema(static_cast<Derived &>(*this), decoder);
+        }
     };
-} // namespace QDB
\ No newline at end of file
+} // namespace QDB
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "quickdb/components/options.h"
+#include "quickdb/components/query_shape.h"
+
+#include <any>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <utility>
+
+namespace QDB
+{
+    /// @brief Counters of a ResultCache.
+    struct ResultCacheStats
+    {
+        /// @brief Calls served from the cache.
+        std::uint64_t hits = 0;
+        /// @brief Calls that went to the server.
+        std::uint64_t misses = 0;
+        /// @brief Results dropped for capacity or because they expired.
+        std::uint64_t evictions = 0;
+        /// @brief Results dropped by invalidate() or clear().
+        std::uint64_t invalidations = 0;
+        /// @brief The number of cached results.
+        std::size_t size = 0;
+
+        /// @brief Gets the fraction of calls served from the cache.
+        double hit_ratio() const { return hits + misses == 0 ? 0.0 : static_cast<double>(hits) / (hits + misses); }
+    };
+
+    /// @brief A client-side TTL cache of query results, for expensive reads that may be slightly stale.
+    ///
+    /// Results are keyed by a scope naming the collection and the 64-bit hash of the call's canonical form
+    /// (see Query::canonical()); the full canonical form is compared on a hit, so hash collisions cannot return
+    /// another query's result. Attach it with Collection::with_result_cache() or
+    /// SharedCollection::with_result_cache() to cache find_many(), count_documents() and aggregate(). A
+    /// result is served until its TTL expires or a write through an attached handle invalidates its scope;
+    /// writes made elsewhere show up once the TTL expires. One cache can serve many collections. It is
+    /// thread-safe.
+    class ResultCache
+    {
+    public:
+        /// @brief Constructs an empty cache.
+        /// @param options The TTL and capacity.
+        explicit ResultCache(const ResultCacheOptions &options = ResultCacheOptions{}) : _options(options) {}
+
+        ResultCache(const ResultCache &) = delete;
+        ResultCache &operator=(const ResultCache &) = delete;
+
+        /// @brief Returns a cached result, or computes and caches it.
+        ///
+        /// Concurrent misses on one key each compute the result.
+        /// @tparam R The result type. It must be copyable and is part of the key.
+        /// @param scope The collection the result belongs to, e.g. "db.collection".
+        /// @param canonical The canonical form of the call, including everything that affects its result.
+        /// @param compute Computes the result on a miss. Its exceptions propagate and nothing is cached.
+        /// @return A copy of the result.
+        template <typename R, typename Compute>
+        R get_or_compute(const std::string &scope, const std::string &canonical, Compute &&compute)
+        {
+            // The result type is part of the key, so a hit always holds an R.
+            const std::string key = canonical + '#' + typeid(R).name();
+            const std::uint64_t hash = shape_hash(key);
+            std::uint64_t ticket = 0;
+            if (std::shared_ptr<const std::any> cached = lookup(scope, hash, key, ticket))
+            {
+                return std::any_cast<const R &>(*cached);
+            }
+            R result = compute();
+            store(scope, hash, key, std::make_shared<const std::any>(result), ticket);
+            return result;
+        }
+
+        /// @brief Drops every result of a scope, and keeps results computed concurrently from being cached.
+        /// @param scope The collection whose data changed.
+        void invalidate(const std::string &scope);
+
+        /// @brief Drops every result.
+        void clear();
+
+        /// @brief Gets the hit, miss and eviction counters.
+        ResultCacheStats stats() const;
+
+        /// @brief Gets the options the cache was created with.
+        const ResultCacheOptions &options() const { return _options; }
+
+    private:
+        using Key = std::pair<std::string, std::uint64_t>;
+
+        /// @brief A cached result.
+        struct Entry
+        {
+            std::string canonical;
+            std::shared_ptr<const std::any> value;
+            std::chrono::steady_clock::time_point expires;
+            /// @brief The entry's position in _lru.
+            std::list<Key>::iterator position;
+        };
+
+        /// @brief Finds a live result. On a miss, stores the scope's generation in `ticket`.
+        std::shared_ptr<const std::any> lookup(const std::string &scope, std::uint64_t hash,
+                                               const std::string &canonical, std::uint64_t &ticket);
+
+        /// @brief Caches a result unless its scope was invalidated since the miss.
+        void store(const std::string &scope, std::uint64_t hash, const std::string &canonical,
+                   std::shared_ptr<const std::any> value, std::uint64_t ticket);
+
+        /// @brief Removes an entry. Requires the lock.
+        void erase(std::map<Key, Entry>::iterator it);
+
+        ResultCacheOptions _options;
+
+        mutable std::mutex _mutex;
+        std::map<Key, Entry> _entries;
+        /// @brief Keys, most recently used first.
+        std::list<Key> _lru;
+        /// @brief Per scope, incremented by every invalidation, to reject results computed before it.
+        std::map<std::string, std::uint64_t> _generations;
+        ResultCacheStats _stats;
+    };
+} // namespace QDB
@@ -0,0 +1,493 @@
+#pragma once
+
+#include "quickdb/components/collection.h"
+#include "quickdb/components/exception.h"
+#include "quickdb/components/executor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <mongocxx/pool.hpp>
+
+namespace QDB
+{
+    /// @brief A lightweight, copyable and thread-safe handle to a collection.
+    ///
+    /// Unlike Collection<T>, which pins one pooled client for its whole lifetime, a SharedCollection only
+    /// stores the pool and the collection's name. Each call acquires a client from the pool, performs the
+    /// operation and returns the client when it completes, so any number of threads can share one handle
+    /// while using at most one connection each at a time. When the pool is exhausted, calls wait for a
+    /// client to be returned.
+    ///
+    /// Operations that need one connection across several calls (streams, lazy documents, cursors) should
+    /// go through lease(). Transactional work should use Database::get_collection(session, ...), since a
+    /// session is bound to the client it was started on. The Database must outlive every handle.
+    ///
+    /// The `*_async` methods run the same operations on the Database's Executor and return a std::future.
+    /// Each task leases its own client, so independent operations issued together run concurrently.
+    /// @tparam T A class that inherits from QDB::Document.
+    template <typename T> class SharedCollection
+    {
+        static_assert(std::is_base_of_v<Document, T>, "Template argument T must be a subclass of QDB::Document");
+
+    public:
+        /// @brief Constructs a shared handle.
+        /// @param pool The connection pool to lease clients from.
+        /// @param db_name The name of the database.
+        /// @param collection_name The name of the collection.
+        /// @param executor The worker pool for `*_async` methods, or nullptr if they are not used.
+        /// @param metrics Where calls and pool waits are recorded. Disabled by default.
+        SharedCollection(mongocxx::pool &pool, std::string db_name, std::string collection_name,
+                         Executor *executor = nullptr, CollectionMetrics metrics = CollectionMetrics{})
+            : _pool(&pool), _db_name(std::move(db_name)), _collection_name(std::move(collection_name)),
+              _executor(executor), _metrics(metrics)
+        {
+        }
+
+        /// @brief Acquires a pooled client and returns a Collection that holds it until destroyed.
+        ///
+        /// Use this for work that spans several calls on one connection, such as find_stream().
+        /// @return A Collection that returns its client to the pool when it is destroyed.
+        /// @throws QDB::Exception if a client cannot be acquired.
+        Collection<T> lease() const
+        {
+            try
+            {
+                std::unique_ptr<mongocxx::pool::entry> client_entry;
+                {
+                    auto timer = _metrics.time(OperationKind::kPoolAcquire);
+                    client_entry = std::make_unique<mongocxx::pool::entry>(_pool->acquire());
+                }
+                auto collection_handle = (*(*client_entry))[_db_name][_collection_name];
+                Collection<T> collection(std::move(client_entry), std::move(collection_handle));
+                collection.with_cache(_cache);
+                collection.with_metrics(_metrics);
+                if (_result_cache)
+                {
+                    collection.with_result_cache(_result_cache, _db_name + "." + _collection_name);
+                }
+                return collection;
+            }
+            catch (const std::exception &e)
+            {
+                throw QDB::Exception("Failed to lease a client for collection '" + _collection_name +
+                                     "': " + std::string(e.what()));
+            }
+        }
+
+        /// @brief Gets the database name.
+        const std::string &db_name() const { return _db_name; }
+
+        /// @brief Gets the collection name.
+        const std::string &collection_name() const { return _collection_name; }
+
+        /// @brief Gets the worker pool used by the `*_async` methods, or nullptr if there is none.
+        Executor *executor() const { return _executor; }
+
+        /// @brief Returns a handle whose find_one() lookups by id go through a new read-through cache.
+        ///
+        /// The cache is shared by copies of the returned handle and by the Collections they lease. See
+        /// DocumentCache for how it stays coherent.
+        /// @param options The capacity, TTL, shard count and change stream settings.
+        SharedCollection with_cache(const CacheOptions &options = CacheOptions{}) const
+        {
+            return with_cache(std::make_shared<DocumentCache<T>>(*_pool, _db_name, _collection_name, options));
+        }
+
+        /// @brief Returns a handle that uses an existing cache, or none when `cache` is null.
+        SharedCollection with_cache(std::shared_ptr<DocumentCache<T>> cache) const
+        {
+            SharedCollection copy(*this);
+            copy._cache = std::move(cache);
+            return copy;
+        }
+
+        /// @brief Gets the attached cache, or null.
+        const std::shared_ptr<DocumentCache<T>> &cache() const { return _cache; }
+
+        /// @brief Returns a handle whose find_many(), count_documents() and aggregate() results are cached.
+        ///
+        /// Results are scoped to "database.collection", so one cache can serve every collection. See
+        /// Collection::with_result_cache().
+        /// @param cache The cache, or null to detach it.
+        SharedCollection with_result_cache(std::shared_ptr<ResultCache> cache) const
+        {
+            SharedCollection copy(*this);
+            copy._result_cache = std::move(cache);
+            return copy;
+        }
+
+        /// @brief Gets the attached result cache, or null.
+        const std::shared_ptr<ResultCache> &result_cache() const { return _result_cache; }
+
+        /// @brief Creates a single document. See Collection::create_one().
+        int64_t create_one(T &doc) const { return lease().create_one(doc); }
+
+        /// @brief Creates a single document with insert options. See Collection::create_one().
+        int64_t create_one(T &doc, const InsertOptions &options) const { return lease().create_one(doc, options); }
+
+        /// @brief Creates multiple documents. See Collection::create_many().
+        int64_t create_many(std::vector<T> &docs) const { return lease().create_many(docs); }
+
+        /// @brief Creates multiple documents with insert options. See Collection::create_many().
+        int64_t create_many(std::vector<T> &docs, const InsertOptions &options) const
+        {
+            return lease().create_many(docs, options);
+        }
+
+        /// @brief Inserts a large vector of documents as concurrent insert_many batches.
+        ///
+        /// Up to `max_in_flight` worker threads each lease one pooled client and repeatedly take the next
+        /// chunk of `chunk_size` documents, encode it and send it. While one worker waits on the server,
+        /// the others are encoding or sending the following chunks, so at most `max_in_flight` batches
+        /// and connections are in use at once. Inserted ids are written back into `docs`. Batches may be
+        /// applied out of order relative to each other; each batch is applied in order.
+        /// @param docs The documents to insert.
+        /// @param options Chunk size and concurrency limits.
+        /// @param insert_options Options applied to every batch. With generate_ids(), each document's own id is
+        /// sent and the per-batch id maps are not read.
+        /// @return The number of documents inserted.
+        /// @throws QDB::Exception if a batch fails. No new batches are started after a failure; batches
+        /// already sent keep their documents and ids.
+        int64_t create_many_pipelined(std::vector<T> &docs,
+                                      const PipelinedInsertOptions &options = PipelinedInsertOptions{},
+                                      const InsertOptions &insert_options = InsertOptions{}) const
+        {
+            if (docs.empty())
+            {
+                return 0;
+            }
+
+            const std::size_t chunk_size = options.get_chunk_size();
+            const std::size_t chunk_count = (docs.size() + chunk_size - 1) / chunk_size;
+            const std::size_t worker_count = std::min(options.get_max_in_flight(), chunk_count);
+
+            std::atomic<std::size_t> next_chunk{0};
+            std::atomic<int64_t> inserted{0};
+            std::atomic<bool> failed{false};
+            std::mutex error_mutex;
+            std::string error_message;
+
+            auto worker = [&]
+            {
+                try
+                {
+                    Collection<T> collection = lease();
+                    for (std::size_t chunk = next_chunk++; chunk < chunk_count && !failed; chunk = next_chunk++)
+                    {
+                        const std::size_t begin = chunk * chunk_size;
+                        const std::size_t end = std::min(docs.size(), begin + chunk_size);
+                        inserted += collection.create_many(docs.begin() + static_cast<std::ptrdiff_t>(begin),
+                                                           docs.begin() + static_cast<std::ptrdiff_t>(end),
+                                                           insert_options);
+                    }
+                }
+                catch (const std::exception &e)
+                {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!failed.exchange(true))
+                    {
+                        error_message = e.what();
+                    }
+                }
+            };
+
+            std::vector<std::thread> workers;
+            workers.reserve(worker_count - 1);
+            for (std::size_t i = 1; i < worker_count; ++i)
+            {
+                try
+                {
+                    workers.emplace_back(worker);
+                }
+                catch (const std::system_error &)
+                {
+                    // Carry on with the workers that did start.
+                    break;
+                }
+            }
+            // The calling thread is one of the workers.
+            worker();
+            for (auto &thread : workers)
+            {
+                thread.join();
+            }
+
+            if (failed)
+            {
+                throw QDB::Exception("Pipelined insert failed after " + std::to_string(inserted.load()) +
+                                     " documents: " + error_message);
+            }
+            return inserted;
+        }
+
+        /// @brief Finds a single document. See Collection::find_one().
+        std::optional<T> find_one(const Query &query, const FindOptions &options = FindOptions{}) const
+        {
+            if constexpr (std::is_copy_constructible_v<T>)
+            {
+                // Serve cache hits without leasing a client.
+                std::optional<bsoncxx::oid> id;
+                if (_cache && DocumentCache<T>::serves(options) && (id = query.id_value()))
+                {
+                    std::uint64_t ticket = 0;
+                    auto timer = _metrics.time(OperationKind::kFindOne);
+                    if (auto hit = _cache->get(*id, &ticket))
+                    {
+                        timer.documents(1);
+                        return hit;
+                    }
+                    // The leased Collection records the lookup.
+                    timer.discard();
+                    Collection<T> collection = lease();
+                    collection.with_cache(nullptr);
+                    std::optional<T> found = collection.find_one(query, options);
+                    if (found)
+                    {
+                        _cache->put(*found, ticket);
+                    }
+                    return found;
+                }
+            }
+            return lease().find_one(query, options);
+        }
+
+        /// @brief Finds all documents matching the query. See Collection::find_many().
+        std::vector<T> find_many(const Query &query, const FindOptions &options = FindOptions{}) const
+        {
+            return lease().find_many(query, options);
+        }
+
+        /// @brief Finds all documents matching the query into a memory resource. See Collection::find_many().
+        std::pmr::vector<T> find_many(const Query &query, const FindOptions &options,
+                                      std::pmr::memory_resource *resource) const
+        {
+            return lease().find_many(query, options, resource);
+        }
+
+        /// @brief Finds a single document without decoding it. See Collection::find_one_lazy().
+        std::optional<LazyDocument<T>> find_one_lazy(const Query &query, const FindOptions &options = FindOptions{}) const
+        {
+            return lease().find_one_lazy(query, options);
+        }
+
+        /// @brief Finds all matching documents without decoding them. See Collection::find_many_lazy().
+        std::vector<LazyDocument<T>> find_many_lazy(const Query &query, const FindOptions &options = FindOptions{}) const
+        {
+            return lease().find_many_lazy(query, options);
+        }
+
+        /// @brief Updates the first matching document. See Collection::update_one().
+        int64_t update_one(const Query &filter_query, const Update &update_doc,
+                           const UpdateOptions &options = UpdateOptions{}) const
+        {
+            return lease().update_one(filter_query, update_doc, options);
+        }
+
+        /// @brief Updates all matching documents. See Collection::update_many().
+        int64_t update_many(const Query &filter_query, const Update &update_doc,
+                            const UpdateOptions &options = UpdateOptions{}) const
+        {
+            return lease().update_many(filter_query, update_doc, options);
+        }
+
+        /// @brief Deletes the first matching document. See Collection::delete_one().
+        int64_t delete_one(const Query &query) const { return lease().delete_one(query); }
+
+        /// @brief Deletes all matching documents. See Collection::delete_many().
+        int64_t delete_many(const Query &query) const { return lease().delete_many(query); }
+
+        /// @brief Counts matching documents. See Collection::count_documents().
+        int64_t count_documents(const Query &query = Query{}) const { return lease().count_documents(query); }
+
+        /// @brief Executes an aggregation pipeline. See Collection::aggregate().
+        template <typename ResultType = T> std::vector<ResultType> aggregate(const Aggregation &aggregation) const
+        {
+            return lease().template aggregate<ResultType>(aggregation);
+        }
+
+        /// @brief Executes an aggregation pipeline with options. See Collection::aggregate().
+        template <typename ResultType = T>
+        std::vector<ResultType> aggregate(const Aggregation &aggregation, const AggregateOptions &options) const
+        {
+            return lease().template aggregate<ResultType>(aggregation, options);
+        }
+
+        /// @brief Atomically finds and updates a document. See Collection::find_one_and_update().
+        std::optional<T> find_one_and_update(const Query &query, const Update &update,
+                                             const FindAndModifyOptions &options = FindAndModifyOptions{}) const
+        {
+            return lease().find_one_and_update(query, update, options);
+        }
+
+        /// @brief Atomically finds and replaces a document. See Collection::find_one_and_replace().
+        std::optional<T> find_one_and_replace(const Query &query, const T &replacement,
+                                              const FindAndModifyOptions &options = FindAndModifyOptions{}) const
+        {
+            return lease().find_one_and_replace(query, replacement, options);
+        }
+
+        /// @brief Atomically finds and deletes a document. See Collection::find_one_and_delete().
+        std::optional<T> find_one_and_delete(const Query &query,
+                                             const FindAndModifyOptions &options = FindAndModifyOptions{}) const
+        {
+            return lease().find_one_and_delete(query, options);
+        }
+
+        /// @brief Creates a single-field index. See Collection::create_index().
+        std::string create_index(const std::string &field, bool ascending = true, bool unique = false) const
+        {
+            return lease().create_index(field, ascending, unique);
+        }
+
+        /// @brief Creates a compound index. See Collection::create_compound_index().
+        std::string create_compound_index(const std::vector<std::pair<std::string, bool>> &fields) const
+        {
+            return lease().create_compound_index(fields);
+        }
+
+        /// @brief Creates a text index. See Collection::create_text_index().
+        std::string create_text_index(const std::vector<std::string> &fields) const
+        {
+            return lease().create_text_index(fields);
+        }
+
+        /// @brief Drops an index by name. See Collection::drop_index().
+        void drop_index(const std::string &index_name) const { lease().drop_index(index_name); }
+
+        /// @brief Lists the names of all indexes. See Collection::list_indexes().
+        std::vector<std::string> list_indexes() const { return lease().list_indexes(); }
+
+        /// @brief Asynchronously finds a single document. See find_one().
+        std::future<std::optional<T>> find_one_async(Query query, FindOptions options = FindOptions{}) const
+        {
+            return async([query = std::move(query), options = std::move(options)](Collection<T> &collection)
+                         { return collection.find_one(query, options); });
+        }
+
+        /// @brief Asynchronously finds all documents matching the query. See find_many().
+        std::future<std::vector<T>> find_many_async(Query query, FindOptions options = FindOptions{}) const
+        {
+            return async([query = std::move(query), options = std::move(options)](Collection<T> &collection)
+                         { return collection.find_many(query, options); });
+        }
+
+        /// @brief Asynchronously creates a single document. See create_one().
+        /// `doc` is read and its `_id` written by the task, so it must stay alive and untouched until the
+        /// future is ready.
+        std::future<int64_t> create_one_async(T &doc, InsertOptions options = InsertOptions{}) const
+        {
+            return async([&doc, options](Collection<T> &collection) { return collection.create_one(doc, options); });
+        }
+
+        /// @brief Asynchronously creates multiple documents. See create_many().
+        /// `docs` must stay alive and untouched until the future is ready.
+        std::future<int64_t> create_many_async(std::vector<T> &docs, InsertOptions options = InsertOptions{}) const
+        {
+            return async([&docs, options](Collection<T> &collection) { return collection.create_many(docs, options); });
+        }
+
+        /// @brief Asynchronously updates the first matching document. See update_one().
+        std::future<int64_t> update_one_async(Query filter_query, Update update_doc,
+                                              UpdateOptions options = UpdateOptions{}) const
+        {
+            return async([filter_query = std::move(filter_query), update_doc = std::move(update_doc),
+                          options](Collection<T> &collection)
+                         { return collection.update_one(filter_query, update_doc, options); });
+        }
+
+        /// @brief Asynchronously updates all matching documents. See update_many().
+        std::future<int64_t> update_many_async(Query filter_query, Update update_doc,
+                                               UpdateOptions options = UpdateOptions{}) const
+        {
+            return async([filter_query = std::move(filter_query), update_doc = std::move(update_doc),
+                          options](Collection<T> &collection)
+                         { return collection.update_many(filter_query, update_doc, options); });
+        }
+
+        /// @brief Asynchronously deletes the first matching document. See delete_one().
+        std::future<int64_t> delete_one_async(Query query) const
+        {
+            return async([query = std::move(query)](Collection<T> &collection) { return collection.delete_one(query); });
+        }
+
+        /// @brief Asynchronously deletes all matching documents. See delete_many().
+        std::future<int64_t> delete_many_async(Query query) const
+        {
+            return async([query = std::move(query)](Collection<T> &collection) { return collection.delete_many(query); });
+        }
+
+        /// @brief Asynchronously counts matching documents. See count_documents().
+        std::future<int64_t> count_documents_async(Query query = Query{}) const
+        {
+            return async([query = std::move(query)](Collection<T> &collection)
+                         { return collection.count_documents(query); });
+        }
+
+        /// @brief Asynchronously executes an aggregation pipeline. See aggregate().
+        template <typename ResultType = T>
+        std::future<std::vector<ResultType>> aggregate_async(Aggregation aggregation,
+                                                             AggregateOptions options = AggregateOptions{}) const
+        {
+            return async([aggregation = std::move(aggregation), options](Collection<T> &collection)
+                         { return collection.template aggregate<ResultType>(aggregation, options); });
+        }
+
+        /// @brief Runs `operation` on the executor with a leased Collection and returns its future.
+        ///
+        /// This is the building block of the `*_async` methods and can run any sequence of calls on one
+        /// leased connection.
+        /// @param operation A callable taking `Collection<T>&`.
+        /// @return A std::future for the callable's result. Exceptions are stored in the future.
+        /// @throws QDB::Exception if the handle has no executor.
+        template <typename Operation>
+        std::future<std::invoke_result_t<Operation &, Collection<T> &>> async(Operation operation) const
+        {
+            if (_executor == nullptr)
+            {
+                throw QDB::Exception("Collection handle '" + _collection_name + "' has no executor for async operations");
+            }
+            return _executor->submit([self = *this, operation = std::move(operation)]() mutable
+                                     {
+                                         Collection<T> collection = self.lease();
+                                         return operation(collection);
+                                     });
+        }
+
+    private:
+        /// @brief The connection pool owned by the Database. Never null.
+        mongocxx::pool *_pool;
+
+        /// @brief The database name.
+        std::string _db_name;
+
+        /// @brief The collection name.
+        std::string _collection_name;
+
+        /// @brief The worker pool for async operations, owned by the Database. May be null.
+        Executor *_executor;
+
+        /// @brief Where calls are recorded.
+        CollectionMetrics _metrics;
+
+        /// @brief The read-through cache for lookups by id. May be null.
+        std::shared_ptr<DocumentCache<T>> _cache;
+
+        /// @brief The result cache for find_many(), count_documents() and aggregate(). May be null.
+        std::shared_ptr<ResultCache> _result_cache;
+    };
+
+} // namespace QDB
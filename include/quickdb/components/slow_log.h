@@ -0,0 +1,132 @@
+#pragma once
+
+#include "quickdb/components/options.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include <bsoncxx/document/value.hpp>
+#include <mongocxx/options/apm.hpp>
+
+namespace QDB
+{
+    /// @brief A command that crossed the threshold of a SlowOperationLog, or failed.
+    struct SlowCommand
+    {
+        /// @brief When the command finished.
+        std::chrono::system_clock::time_point time;
+        /// @brief The command name, e.g. "find" or "aggregate".
+        std::string command_name;
+        std::string database;
+        /// @brief The collection the command targets, if any.
+        std::string collection;
+        /// @brief The server that ran it, as "host:port".
+        std::string server;
+        std::chrono::microseconds duration{0};
+        /// @brief The BSON size of the reply, or of the failure document.
+        std::size_t reply_bytes = 0;
+        bool failed = false;
+        /// @brief The server error code of a failure, or 0 for client-side errors.
+        std::int32_t error_code = 0;
+        /// @brief The server's name for the error code, e.g. "DuplicateKey". The error message is not kept,
+        /// because it can quote the values involved.
+        std::string error_name;
+        /// @brief The command without session fields, keeping the first statement of a batch. It is redacted
+        /// before it is written.
+        std::optional<bsoncxx::document::value> command;
+    };
+
+    /// @brief Logs slow and failed commands from the driver's command monitoring (APM) events.
+    ///
+    /// attach() registers command started, succeeded and failed callbacks. A command that takes at least
+    /// SlowLogOptions::threshold(), or fails, is pushed into a bounded lock-free ring buffer, and a background
+    /// thread appends it to the log file as one JSON object per line: time, command, database, collection,
+    /// server, duration, reply size, error code and the redacted command shape (see canonical_document()), so
+    /// literal values never reach the file. Recording never blocks the command: when the ring is full the
+    /// command is dropped and counted.
+    ///
+    /// Each started command is summarized on its thread until it finishes, which costs a copy of its
+    /// top-level fields (only the first document of an insert, update or delete batch). Database creates
+    /// and attaches a log when constructed with SlowLogOptions. The log must outlive the pool it is attached to.
+    class SlowOperationLog
+    {
+    public:
+        /// @brief Opens the log file and starts the background writer.
+        /// @param options The file, threshold and buffer size.
+        /// @throws QDB::Exception if the file cannot be opened.
+        explicit SlowOperationLog(const SlowLogOptions &options);
+
+        /// @brief Writes every waiting command and stops the background writer.
+        ~SlowOperationLog();
+
+        SlowOperationLog(const SlowOperationLog &) = delete;
+        SlowOperationLog &operator=(const SlowOperationLog &) = delete;
+
+        /// @brief Registers the command monitoring callbacks. Pass the result to the client or pool options.
+        /// @param apm The APM options to add the callbacks to. Callbacks already set for commands are replaced.
+        void attach(mongocxx::options::apm &apm);
+
+        /// @brief Queues a command to be written. Lock-free.
+        /// @param command The command. Its shape is rendered by the background writer.
+        /// @return False if the ring buffer was full and the command was dropped.
+        bool record(SlowCommand command);
+
+        /// @brief Waits until every command queued before the call is written to the file.
+        void flush();
+
+        /// @brief Gets the number of commands written.
+        std::uint64_t logged() const { return _logged.load(std::memory_order_relaxed); }
+
+        /// @brief Gets the number of commands dropped because the ring buffer was full.
+        std::uint64_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+        /// @brief Gets the options the log was created with.
+        const SlowLogOptions &options() const { return _options; }
+
+    private:
+        /// @brief A ring buffer slot. Its sequence tells producers and the writer whose turn it is.
+        struct Slot
+        {
+            std::atomic<std::uint64_t> sequence{0};
+            SlowCommand command;
+        };
+
+        /// @brief Writes waiting commands until stopped.
+        void run();
+
+        /// @brief Writes every command in the ring buffer. Called by the writer thread only.
+        void drain();
+
+        SlowLogOptions _options;
+        std::ofstream _file;
+
+        std::unique_ptr<Slot[]> _slots;
+        std::size_t _mask;
+        /// @brief The next position producers claim.
+        alignas(64) std::atomic<std::uint64_t> _tail{0};
+        /// @brief The next position the writer reads. Written by the writer thread only.
+        alignas(64) std::atomic<std::uint64_t> _head{0};
+
+        std::atomic<std::uint64_t> _logged{0};
+        std::atomic<std::uint64_t> _dropped{0};
+
+        std::mutex _mutex;
+        /// @brief Wakes the writer to stop or flush.
+        std::condition_variable _wake;
+        /// @brief Signals flush() callers that the writer drained.
+        std::condition_variable _drained;
+        /// @brief The position flush() callers wait for. Guarded by _mutex.
+        std::uint64_t _flush_target = 0;
+        bool _stopping = false;
+        std::thread _writer;
+    };
+} // namespace QDB
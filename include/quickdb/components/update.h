@@ -3,8 +3,6 @@
 #include "quickdb/components/field.h"
 
 #include <string>
-#include <unordered_map>
-#include <variant>
 #include <vector>
 
 namespace QDB
@@ -38,7 +36,7 @@ namespace QDB
         /// @param values A vector of values to append to the array.
         template <typename T> Update &push_each(const std::string &field, const std::vector<T> &values)
         {
-            std::unordered_map<std::string, FieldValue> each_map;
+            FieldMap each_map;
             each_map["$each"] = FieldValue(values);
             add_operator_field("$push", field, FieldValue(each_map));
             return *this;
@@ -58,7 +56,7 @@ namespace QDB
         /// @param values A vector of values to remove from the array.
         template <typename T> Update &pull_each(const std::string &field, const std::vector<T> &values)
         {
-            std::unordered_map<std::string, FieldValue> each_map;
+            FieldMap each_map;
             each_map["$each"] = FieldValue(values);
             add_operator_field("$pull", field, FieldValue(each_map));
             return *this;
@@ -93,7 +91,7 @@ namespace QDB
                 // For safety, you might want to throw an exception for invalid operations
                 return *this;
             }
-            std::unordered_map<std::string, FieldValue> bit_op_map = {{operation, FieldValue(value)}};
+            FieldMap bit_op_map = {{operation, FieldValue(value)}};
             add_operator_field("$bit", field, FieldValue(bit_op_map));
             return *this;
         }
@@ -170,7 +168,7 @@ namespace QDB
         }
 
         /// @brief Gets the underlying field map representing the update document.
-        const std::unordered_map<std::string, FieldValue> &get_fields() const { return _update_map; }
+        const FieldMap &get_fields() const { return _update_map; }
 
     private:
         /// @brief Helper function to construct the nested update document structure.
@@ -182,20 +180,19 @@ namespace QDB
             auto it = _update_map.find(op);
             if (it == _update_map.end())
             {
-                _update_map.emplace(op, FieldValue(std::unordered_map<std::string, FieldValue>{{field, fv}}));
+                _update_map.emplace(op, FieldValue(FieldMap{{field, fv}}));
             }
             else
             {
-                if (std::holds_alternative<std::unordered_map<std::string, FieldValue>>(it->second.value))
+                if (it->second.type() == FieldType::FT_OBJECT)
                 {
-                    auto &existing_map = std::get<std::unordered_map<std::string, FieldValue>>(it->second.value);
-                    existing_map[field] = fv;
+                    it->second.set_member(field, fv);
                 }
             }
         }
 
         /// @brief The internal map holding the update operations.
-        std::unordered_map<std::string, FieldValue> _update_map;
+        FieldMap _update_map;
     };
 
 } // namespace QDB
@@ -0,0 +1,373 @@
+#pragma once
+
+#include "quickdb/components/bulk_writer.h"
+#include "quickdb/components/exception.h"
+#include "quickdb/components/journal.h"
+#include "quickdb/components/options.h"
+#include "quickdb/components/query.h"
+#include "quickdb/components/shared_collection.h"
+#include "quickdb/components/update.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/kvp.hpp>
+#include <bsoncxx/document/value.hpp>
+#include <mongocxx/collection.hpp>
+
+namespace QDB
+{
+    /// @brief Describes a WriteBuffer flush that did not fully succeed.
+    struct WriteBufferError
+    {
+        /// @brief A description of the failure.
+        std::string message;
+        /// @brief The number of operations in the flush.
+        std::size_t operation_count = 0;
+        /// @brief The per-operation outcome. Empty when the flush failed before the server replied.
+        BulkWriteResult result;
+    };
+
+    /// @brief A write-behind buffer that batches inserts and updates into bulk writes.
+    ///
+    /// Operations are encoded on the calling thread and queued. A background thread sends them with one
+    /// BulkWriter per flush as soon as the buffer holds WriteBufferOptions::max_documents() operations or
+    /// max_bytes() bytes, or its oldest operation has waited max_delay(). Memory is bounded: when buffered
+    /// plus in-flight operations reach max_pending_bytes(), new operations block until a flush completes.
+    ///
+    /// Failures never propagate to the writing threads. They are reported to the error handler, which runs
+    /// on the background thread. Each flush leases its own pooled client, so the buffer can be shared by
+    /// any number of threads. The destructor flushes whatever is left. The Database must outlive the buffer.
+    ///
+    /// With WriteBufferOptions::journal(), each operation is appended to a Journal before the call that
+    /// queued it returns, and released once its flush has reached the server. A flush that cannot reach the
+    /// server is retried until it does, or until the buffer is destroyed, in which case the unsent
+    /// operations stay in the journal for Database::replay_journal(). Delivery is then at-least-once.
+    /// @tparam T A class that inherits from QDB::Document.
+    template <typename T> class WriteBuffer
+    {
+        static_assert(std::is_base_of_v<Document, T>, "Template argument T must be a subclass of QDB::Document");
+
+    public:
+        /// @brief A callback invoked on the background thread for every flush that did not fully succeed.
+        using ErrorHandler = std::function<void(const WriteBufferError &)>;
+
+        /// @brief Constructs a buffer and starts its background thread.
+        /// @param collection The collection to write to.
+        /// @param options Flush thresholds, the memory bound and bulk write options.
+        /// @param on_error Called for failed flushes. It should not throw.
+        explicit WriteBuffer(SharedCollection<T> collection, const WriteBufferOptions &options = WriteBufferOptions{},
+                             ErrorHandler on_error = ErrorHandler{})
+            : _collection(std::move(collection)), _options(options), _on_error(std::move(on_error)),
+              _pending(mongocxx::collection{}, options.get_bulk_options())
+        {
+            if (!_options.get_journal_path().empty())
+            {
+                // Compaction needs the live records to fit in released space, hence the headroom.
+                const std::size_t capacity = std::max(Journal::kDefaultCapacity, 4 * _options.get_max_pending_bytes());
+                _journal = std::make_unique<Journal>(_options.get_journal_path(), capacity, _options.is_journal_synced());
+                if (!_journal->empty())
+                {
+                    throw QDB::Exception("Journal '" + _options.get_journal_path() +
+                                         "' holds operations that were never written; call "
+                                         "Database::replay_journal() before creating the buffer");
+                }
+            }
+            _flusher = std::thread([this] { run(); });
+        }
+
+        /// @brief Flushes every buffered operation, then stops the background thread.
+        ~WriteBuffer()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stopping = true;
+            }
+            _wake.notify_all();
+            _flusher.join();
+        }
+
+        WriteBuffer(const WriteBuffer &) = delete;
+        WriteBuffer &operator=(const WriteBuffer &) = delete;
+
+        /// @brief Buffers an insert. A new ObjectId is assigned to `doc` immediately.
+        /// @param doc The document to insert. It is encoded before this call returns.
+        /// @return A reference to this buffer for chaining.
+        WriteBuffer &insert(T &doc)
+        {
+            BulkWriter<T> staged(mongocxx::collection{}, _options.get_bulk_options());
+            staged.insert(doc);
+            return enqueue(std::move(staged));
+        }
+
+        /// @brief Buffers an update of the first document matching `filter`.
+        /// @param filter The selection criteria.
+        /// @param update The modifications to apply.
+        /// @param upsert True to insert a document when nothing matches.
+        /// @return A reference to this buffer for chaining.
+        WriteBuffer &update_one(const Query &filter, const Update &update, bool upsert = false)
+        {
+            BulkWriter<T> staged(mongocxx::collection{}, _options.get_bulk_options());
+            staged.update_one(filter, update, upsert);
+            return enqueue(std::move(staged));
+        }
+
+        /// @brief Buffers an update of every document matching `filter`.
+        /// @param filter The selection criteria.
+        /// @param update The modifications to apply.
+        /// @param upsert True to insert a document when nothing matches.
+        /// @return A reference to this buffer for chaining.
+        WriteBuffer &update_many(const Query &filter, const Update &update, bool upsert = false)
+        {
+            BulkWriter<T> staged(mongocxx::collection{}, _options.get_bulk_options());
+            staged.update_many(filter, update, upsert);
+            return enqueue(std::move(staged));
+        }
+
+        /// @brief Buffers an update of the first document matching `filter`, inserting one if none matches.
+        /// @return A reference to this buffer for chaining.
+        WriteBuffer &upsert(const Query &filter, const Update &update) { return update_one(filter, update, true); }
+
+        /// @brief Sends every operation buffered before this call and waits until they have been written.
+        ///
+        /// Failures are reported to the error handler, not thrown.
+        void flush()
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            const std::uint64_t target = _enqueued;
+            _flush_target = std::max(_flush_target, target);
+            _wake.notify_all();
+            _progress.wait(lock, [&] { return _completed >= target; });
+        }
+
+        /// @brief Gets the number of operations buffered or being written.
+        std::size_t pending() const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return static_cast<std::size_t>(_enqueued - _completed);
+        }
+
+        /// @brief Gets the number of operations that failed or were not executed so far.
+        std::size_t failed_count() const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _failed;
+        }
+
+    private:
+        /// @brief Whether a flush reached the server, and how many of its operations failed.
+        struct WriteOutcome
+        {
+            bool delivered = false;
+            std::size_t failed = 0;
+        };
+
+        /// @brief Moves one staged operation into the buffer, waiting while the memory bound is reached.
+        /// @throws QDB::Exception if the operation cannot be journaled. It is not queued in that case.
+        WriteBuffer &enqueue(BulkWriter<T> staged)
+        {
+            const std::size_t bytes = staged.queued_bytes();
+            std::optional<bsoncxx::document::value> record;
+            if (_journal)
+            {
+                using bsoncxx::builder::basic::kvp;
+                record = bsoncxx::builder::basic::make_document(kvp("db", _collection.db_name()),
+                                                                kvp("collection", _collection.collection_name()),
+                                                                kvp("op", staged.export_operation(0)));
+            }
+
+            std::unique_lock<std::mutex> lock(_mutex);
+            // An operation larger than the bound is still admitted once nothing else is held.
+            auto has_room = [&]
+            {
+                const std::size_t held = _pending.queued_bytes() + _in_flight_bytes;
+                return held == 0 || held + bytes <= _options.get_max_pending_bytes();
+            };
+            if (!has_room())
+            {
+                // Flush now rather than at the deadline: a writer is waiting for memory.
+                ++_blocked_writers;
+                _wake.notify_all();
+                _progress.wait(lock, has_room);
+                --_blocked_writers;
+            }
+
+            if (record)
+            {
+                // Appended under the buffer's lock so journal order matches flush order.
+                _journal_end = _journal->append(record->view());
+            }
+            const bool was_empty = _pending.empty();
+            if (was_empty)
+            {
+                _oldest = std::chrono::steady_clock::now();
+            }
+            _pending.append(std::move(staged));
+            ++_enqueued;
+            if (was_empty || threshold_reached())
+            {
+                // The first operation starts the background thread's max_delay timer.
+                _wake.notify_all();
+            }
+            return *this;
+        }
+
+        /// @brief Checks whether the buffered operations reach a size threshold. Requires the lock.
+        bool threshold_reached() const
+        {
+            return _pending.size() >= _options.get_max_documents() || _pending.queued_bytes() >= _options.get_max_bytes();
+        }
+
+        /// @brief The background loop: waits for a threshold, a deadline, a flush request or shutdown.
+        void run()
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            for (;;)
+            {
+                _wake.wait(lock, [&] { return _stopping || !_pending.empty(); });
+                if (_pending.empty())
+                {
+                    return;
+                }
+                _wake.wait_until(lock, _oldest + _options.get_max_delay(),
+                                 [&]
+                                 {
+                                     return _stopping || _flush_target > _completed || _blocked_writers > 0 ||
+                                            threshold_reached();
+                                 });
+
+                BulkWriter<T> batch(mongocxx::collection{}, _options.get_bulk_options());
+                batch.append(std::move(_pending));
+                const std::size_t count = batch.size();
+                const std::uint64_t journal_end = _journal_end;
+                _in_flight_bytes = batch.queued_bytes();
+
+                lock.unlock();
+                WriteOutcome outcome = write(batch);
+                while (!outcome.delivered && _journal)
+                {
+                    // Journaled operations are kept through outages; retry until shutdown.
+                    lock.lock();
+                    const bool stopping = _wake.wait_for(lock, _options.get_retry_interval(), [&] { return _stopping; });
+                    lock.unlock();
+                    if (stopping)
+                    {
+                        break;
+                    }
+                    outcome = write(batch);
+                }
+                if (outcome.delivered && _journal)
+                {
+                    _journal->release(journal_end);
+                }
+                lock.lock();
+
+                _in_flight_bytes = 0;
+                _completed += count;
+                if (!outcome.delivered && _journal)
+                {
+                    // Shutting down while the server is unreachable: everything left stays in the journal.
+                    _completed += _pending.size();
+                    _pending.clear();
+                    _progress.notify_all();
+                    return;
+                }
+                _failed += outcome.failed;
+                _progress.notify_all();
+            }
+        }
+
+        /// @brief Sends one batch and reports any failure.
+        /// @param batch The operations. Kept for a retry when journaling, consumed otherwise.
+        WriteOutcome write(BulkWriter<T> &batch)
+        {
+            const std::size_t count = batch.size();
+            WriteOutcome outcome;
+            WriteBufferError error;
+            error.operation_count = count;
+            try
+            {
+                Collection<T> collection = _collection.lease();
+                BulkWriter<T> writer = collection.bulk_writer(_options.get_bulk_options());
+                writer.append(_journal ? BulkWriter<T>(batch) : std::move(batch));
+                error.result = writer.execute();
+                outcome.delivered = true;
+                if (error.result.ok())
+                {
+                    return outcome;
+                }
+                error.message = "Buffered bulk write reported errors";
+            }
+            catch (const std::exception &e)
+            {
+                error.message = "Failed to flush write buffer: " + std::string(e.what());
+            }
+
+            outcome.failed = outcome.delivered ? 0 : count;
+            for (const auto &op : error.result.operations)
+            {
+                outcome.failed += op.ok() ? 0 : 1;
+            }
+            if (_on_error)
+            {
+                try
+                {
+                    _on_error(error);
+                }
+                catch (...)
+                {
+                    // The handler must not stop the background thread.
+                }
+            }
+            return outcome;
+        }
+
+        /// @brief The collection flushes are written to.
+        SharedCollection<T> _collection;
+        /// @brief Thresholds, memory bound and bulk write options.
+        WriteBufferOptions _options;
+        /// @brief Called for failed flushes.
+        ErrorHandler _on_error;
+
+        mutable std::mutex _mutex;
+        /// @brief Wakes the background thread.
+        std::condition_variable _wake;
+        /// @brief Signals completed flushes to blocked writers and flush() callers.
+        std::condition_variable _progress;
+        /// @brief The buffered operations. Staging only: it is never executed itself.
+        BulkWriter<T> _pending;
+        /// @brief When the oldest buffered operation was queued.
+        std::chrono::steady_clock::time_point _oldest;
+        /// @brief The bytes of the batch being written.
+        std::size_t _in_flight_bytes = 0;
+        /// @brief The number of operations ever queued.
+        std::uint64_t _enqueued = 0;
+        /// @brief The number of operations whose flush has completed.
+        std::uint64_t _completed = 0;
+        /// @brief flush() waits until _completed reaches this count.
+        std::uint64_t _flush_target = 0;
+        /// @brief The number of operations that failed or were not executed.
+        std::size_t _failed = 0;
+        /// @brief The number of writers waiting for memory.
+        std::size_t _blocked_writers = 0;
+        bool _stopping = false;
+        /// @brief The journal, when enabled.
+        std::unique_ptr<Journal> _journal;
+        /// @brief The journal position just past the last buffered operation.
+        std::uint64_t _journal_end = 0;
+        /// @brief The background thread. Declared last so it starts after every other member exists.
+        std::thread _flusher;
+    };
+} // namespace QDB
@@ -1,9 +1,21 @@
 #pragma once
 
+#include "quickdb/components/batch_loader.h"
+#include "quickdb/components/change_stream.h"
 #include "quickdb/components/collection.h" // Note: May need forward declarations to avoid circular includes
+#include "quickdb/components/coroutine.h"
+#include "quickdb/components/document_cache.h"
 #include "quickdb/components/exception.h"
+#include "quickdb/components/executor.h"
 #include "quickdb/components/gridfs.h"
+#include "quickdb/components/journal.h"
+#include "quickdb/components/metrics.h"
+#include "quickdb/components/query_shape.h"
 #include "quickdb/components/reflection.h"
+#include "quickdb/components/result_cache.h"
+#include "quickdb/components/shared_collection.h"
+#include "quickdb/components/slow_log.h"
+#include "quickdb/components/write_buffer.h"
 
 #include <cstdint>
 #include <memory>
@@ -28,6 +40,15 @@ namespace QDB
         /// @param uri The MongoDB connection URI.
         Database(const std::string &uri);
 
+        /// @brief Constructor that also logs slow and failed commands to a file.
+        ///
+        /// The log is attached to the connection pool's command monitoring, so it sees every command sent
+        /// through this Database. See SlowOperationLog.
+        /// @param uri The MongoDB connection URI.
+        /// @param slow_log The log file, threshold and buffer size.
+        /// @throws QDB::Exception if the URI is invalid or the log file cannot be opened.
+        Database(const std::string &uri, const SlowLogOptions &slow_log);
+
         /// @brief Constructor for authenticated connections.
         /// This constructor builds the URI string for you.
         /// @param user The username for authentication.
@@ -39,6 +60,19 @@ namespace QDB
         Database(const std::string &user, const std::string &pass, const std::string &host = "localhost",
                  std::uint16_t port = 27017, const std::string &auth_db = "admin", std::uint32_t max_pool_size = 50);
 
+        /// @brief Constructor for authenticated connections that also logs slow and failed commands to a file.
+        /// See Database(const std::string &, const SlowLogOptions &).
+        /// @param user The username for authentication.
+        /// @param pass The password for authentication.
+        /// @param host The database host.
+        /// @param port The database port.
+        /// @param auth_db The authentication database.
+        /// @param max_pool_size The maximum size of the connection pool.
+        /// @param slow_log The log file, threshold and buffer size.
+        /// @throws QDB::Exception if the URI is invalid or the log file cannot be opened.
+        Database(const std::string &user, const std::string &pass, const std::string &host, std::uint16_t port,
+                 const std::string &auth_db, std::uint32_t max_pool_size, const SlowLogOptions &slow_log);
+
         ~Database();
 
         // Disable copy and move semantics to ensure single ownership of the connection.
@@ -54,15 +88,39 @@ namespace QDB
         /// @return A type-safe Collection object.
         template <typename T> Collection<T> get_collection(const std::string &db_name, const std::string &collection_name)
         {
-            auto client_entry = std::make_unique<mongocxx::pool::entry>(m_pool->acquire());
+            CollectionMetrics metrics = m_metrics->collection(db_name, collection_name);
+            std::unique_ptr<mongocxx::pool::entry> client_entry;
+            {
+                auto timer = metrics.time(OperationKind::kPoolAcquire);
+                client_entry = std::make_unique<mongocxx::pool::entry>(m_pool->acquire());
+            }
             auto collection_handle = (*(*client_entry))[db_name][collection_name];
-            return Collection<T>(std::move(client_entry), collection_handle);
+            Collection<T> collection(std::move(client_entry), collection_handle);
+            collection.with_metrics(metrics);
+            return collection;
         }
 
         template <typename T> Collection<T> get_collection(mongocxx::client_session &session, const std::string &db_name, const std::string &collection_name)
         {
             auto collection_handle = session.client()[db_name][collection_name];
-            return Collection<T>(nullptr, collection_handle);
+            Collection<T> collection(nullptr, collection_handle);
+            collection.with_metrics(m_metrics->collection(db_name, collection_name));
+            return collection;
+        }
+
+        /// @brief The factory method for getting a copyable, thread-safe collection handle.
+        ///
+        /// Unlike get_collection(), no client is held by the handle: each operation leases one from the
+        /// pool and returns it when done. The handle must not outlive this Database.
+        /// @tparam T The Document subclass for this collection.
+        /// @param db_name The name of the database.
+        /// @param collection_name The name of the collection.
+        /// @return A SharedCollection that can be copied and used from any thread.
+        template <typename T>
+        SharedCollection<T> get_shared_collection(const std::string &db_name, const std::string &collection_name)
+        {
+            return SharedCollection<T>(*m_pool, db_name, collection_name, m_executor.get(),
+                                       m_metrics->collection(db_name, collection_name));
         }
 
         /// @brief Executes a series of operations within a transaction.
@@ -84,6 +142,32 @@ namespace QDB
         /// @return A GridFSBucket object for file operations.
         GridFSBucket get_gridfs_bucket(const std::string &db_name, const std::string &bucket_name = "fs");
 
+        /// @brief Applies the operations left in a WriteBuffer journal by a crash or shutdown, then empties it.
+        ///
+        /// Call it at startup, before creating the WriteBuffer that uses the journal. Operations are applied
+        /// in journal order. Inserts that had already reached the server before the crash are counted as
+        /// already applied. Other operations the server rejects are reported and dropped. Operations are
+        /// released from the journal as they are applied, so if the server becomes unreachable partway, the
+        /// rest stays in the journal and a later replay resumes from there.
+        /// @param path The journal file. A missing file is treated as empty.
+        /// @return The number of operations applied and any rejections.
+        /// @throws QDB::Exception if the journal cannot be read or the server cannot be reached.
+        JournalReplayResult replay_journal(const std::string &path);
+
+        /// @brief Gets the worker pool that runs the `*_async` operations of SharedCollection handles.
+        /// Its threads start on first use. It can also run application tasks that use the database.
+        Executor &executor() { return *m_executor; }
+
+        /// @brief Gets the registry that records every operation on handles created by this Database.
+        ///
+        /// Call counts, errors, latency percentiles, documents and bytes are kept per database, collection
+        /// and operation. Use `metrics().snapshot().to_text()` or `to_json()` to export them.
+        MetricsRegistry &metrics() { return *m_metrics; }
+
+        /// @brief Gets the slow operation log.
+        /// @return The log, or null if this Database was constructed without SlowLogOptions.
+        SlowOperationLog *slow_log() { return m_slow_log.get(); }
+
         /// @brief Pings the database to verify the connection.
         /// @throws QDB::Exception if the ping command fails.
         void ping();
@@ -93,7 +177,16 @@ namespace QDB
         /// @return A reference to the mongocxx::instance.
         static mongocxx::instance &get_instance();
 
+        /// @brief The operation metrics. Declared first so it outlives everything that records into it.
+        std::unique_ptr<MetricsRegistry> m_metrics = std::make_unique<MetricsRegistry>();
+
+        /// @brief The slow operation log, or null. Declared before m_pool so it outlives the pool's callbacks.
+        std::unique_ptr<SlowOperationLog> m_slow_log;
+
         /// @brief The connection pool.
         std::unique_ptr<mongocxx::pool> m_pool;
+
+        /// @brief The worker pool for async operations. Declared after m_pool so it is stopped first.
+        std::unique_ptr<Executor> m_executor = std::make_unique<Executor>();
     };
 } // namespace QDB
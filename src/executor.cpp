@@ -0,0 +1,85 @@
+#include "quickdb/components/executor.h"
+
+#include <algorithm>
+
+namespace QDB
+{
+    namespace
+    {
+        // The executor whose worker is running on this thread, if any.
+        thread_local const Executor *current_executor = nullptr;
+    } // namespace
+
+    Executor::Executor(std::size_t threads, std::size_t queue_capacity)
+        : _thread_count(threads != 0 ? threads : std::max<std::size_t>(2, std::thread::hardware_concurrency())),
+          _queue_capacity(std::max<std::size_t>(1, queue_capacity))
+    {
+    }
+
+    Executor::~Executor()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _not_empty.notify_all();
+        _not_full.notify_all();
+        for (auto &worker : _workers)
+        {
+            worker.join();
+        }
+    }
+
+    void Executor::post(std::function<void()> task)
+    {
+        std::call_once(_started, [this] { start(); });
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_tasks.size() >= _queue_capacity && on_worker_thread())
+        {
+            // Waiting here could deadlock if every worker did the same; run the task on this worker instead.
+            lock.unlock();
+            task();
+            return;
+        }
+        _not_full.wait(lock, [this] { return _stopping || _tasks.size() < _queue_capacity; });
+        _tasks.push_back(std::move(task));
+        // Notify under the lock: once a task runs, a caller may destroy the executor, so this thread must
+        // not touch the condition variable after releasing the mutex.
+        _not_empty.notify_one();
+    }
+
+    void Executor::start()
+    {
+        _workers.reserve(_thread_count);
+        for (std::size_t i = 0; i < _thread_count; ++i)
+        {
+            _workers.emplace_back([this] { run(); });
+        }
+    }
+
+    void Executor::run()
+    {
+        current_executor = this;
+        for (;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _not_empty.wait(lock, [this] { return _stopping || !_tasks.empty(); });
+                if (_tasks.empty())
+                {
+                    // Only reached when stopping: queued tasks are drained first.
+                    return;
+                }
+                task = std::move(_tasks.front());
+                _tasks.pop_front();
+            }
+            _not_full.notify_one();
+            task();
+        }
+    }
+
+    bool Executor::on_worker_thread() const { return current_executor == this; }
+
+} // namespace QDB
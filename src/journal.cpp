@@ -0,0 +1,305 @@
+#include "quickdb/components/journal.h"
+#include "quickdb/components/exception.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace QDB
+{
+    namespace
+    {
+        // File layout: a fixed header, then records of [u32 payload length][u32 CRC-32 of payload][BSON payload].
+        // A zero length marks the end of the records.
+        constexpr std::uint32_t kMagic = 0x4A424451; // "QDBJ"
+        constexpr std::uint32_t kVersion = 1;
+        constexpr std::size_t kHeaderSize = 64;
+        constexpr std::size_t kMagicOffset = 0;
+        constexpr std::size_t kVersionOffset = 4;
+        constexpr std::size_t kBeginOffset = 8;
+        constexpr std::size_t kFrameSize = 8;
+        constexpr std::size_t kMinBsonSize = 5;
+
+        std::array<std::uint32_t, 256> make_crc_table()
+        {
+            std::array<std::uint32_t, 256> table{};
+            for (std::uint32_t i = 0; i < 256; ++i)
+            {
+                std::uint32_t crc = i;
+                for (int bit = 0; bit < 8; ++bit)
+                {
+                    crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+                }
+                table[i] = crc;
+            }
+            return table;
+        }
+
+        std::uint32_t crc32(const unsigned char *data, std::size_t length)
+        {
+            static const std::array<std::uint32_t, 256> table = make_crc_table();
+            std::uint32_t crc = 0xFFFFFFFFu;
+            for (std::size_t i = 0; i < length; ++i)
+            {
+                crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+            }
+            return crc ^ 0xFFFFFFFFu;
+        }
+
+        template <typename U> U load(const unsigned char *at)
+        {
+            U value;
+            std::memcpy(&value, at, sizeof(U));
+            return value;
+        }
+
+        template <typename U> void store(unsigned char *at, U value) { std::memcpy(at, &value, sizeof(U)); }
+
+        std::string errno_message(const std::string &what, const std::string &path)
+        {
+            return what + " '" + path + "': " + std::system_category().message(errno);
+        }
+    } // namespace
+
+#if defined(_WIN32)
+
+    Journal::Journal(const std::string &path, std::size_t, bool) : _path(path)
+    {
+        throw QDB::Exception("Journal '" + path + "': memory-mapped journals are only supported on POSIX systems");
+    }
+
+    Journal::~Journal() = default;
+
+    void Journal::sync_range(std::size_t, std::size_t) const {}
+
+#else
+
+    Journal::Journal(const std::string &path, std::size_t capacity, bool sync) : _path(path), _sync(sync)
+    {
+        _fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (_fd < 0)
+        {
+            throw QDB::Exception(errno_message("Failed to open journal", path));
+        }
+
+        try
+        {
+            struct stat info;
+            if (::fstat(_fd, &info) != 0)
+            {
+                throw QDB::Exception(errno_message("Failed to stat journal", path));
+            }
+            const std::size_t existing = static_cast<std::size_t>(info.st_size);
+            const std::size_t requested = capacity != 0 ? capacity : (existing != 0 ? existing : kDefaultCapacity);
+            _capacity = std::max({existing, requested, kHeaderSize + kFrameSize + kMinBsonSize});
+            if (_capacity != existing && ::ftruncate(_fd, static_cast<off_t>(_capacity)) != 0)
+            {
+                throw QDB::Exception(errno_message("Failed to size journal", path));
+            }
+
+            void *mapping = ::mmap(nullptr, _capacity, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+            if (mapping == MAP_FAILED)
+            {
+                throw QDB::Exception(errno_message("Failed to map journal", path));
+            }
+            _data = static_cast<unsigned char *>(mapping);
+
+            if (existing == 0 || load<std::uint32_t>(_data + kMagicOffset) == 0)
+            {
+                store(_data + kMagicOffset, kMagic);
+                store(_data + kVersionOffset, kVersion);
+                store(_data + kBeginOffset, static_cast<std::uint64_t>(kHeaderSize));
+                sync_range(0, kHeaderSize);
+            }
+            else if (load<std::uint32_t>(_data + kMagicOffset) != kMagic ||
+                     load<std::uint32_t>(_data + kVersionOffset) != kVersion)
+            {
+                throw QDB::Exception("File '" + path + "' is not a QuickDB journal");
+            }
+
+            // Scan the records from the stored begin offset up to the first empty or corrupt frame.
+            const auto stored_begin = load<std::uint64_t>(_data + kBeginOffset);
+            _begin = stored_begin >= kHeaderSize && stored_begin <= _capacity ? static_cast<std::size_t>(stored_begin)
+                                                                              : kHeaderSize;
+            _end = _begin;
+            while (_end + kFrameSize <= _capacity)
+            {
+                const auto length = load<std::uint32_t>(_data + _end);
+                if (length < kMinBsonSize || length > _capacity - _end - kFrameSize)
+                {
+                    break;
+                }
+                const unsigned char *payload = _data + _end + kFrameSize;
+                if (load<std::int32_t>(payload) != static_cast<std::int32_t>(length) ||
+                    load<std::uint32_t>(_data + _end + 4) != crc32(payload, length))
+                {
+                    break;
+                }
+                _end += kFrameSize + length;
+            }
+            _shift = 0;
+        }
+        catch (...)
+        {
+            if (_data != nullptr)
+            {
+                ::munmap(_data, _capacity);
+            }
+            ::close(_fd);
+            throw;
+        }
+    }
+
+    Journal::~Journal()
+    {
+        if (_data != nullptr)
+        {
+            ::msync(_data, _capacity, MS_ASYNC);
+            ::munmap(_data, _capacity);
+        }
+        if (_fd >= 0)
+        {
+            ::close(_fd);
+        }
+    }
+
+    void Journal::sync_range(std::size_t offset, std::size_t length) const
+    {
+        if (!_sync || length == 0)
+        {
+            return;
+        }
+        // msync needs a page-aligned start address.
+        const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        const std::size_t aligned = offset - offset % page;
+        ::msync(_data + aligned, length + (offset - aligned), MS_SYNC);
+    }
+
+#endif
+
+    std::uint64_t Journal::append(const bsoncxx::document::view &record)
+    {
+        const std::size_t length = record.length();
+        const std::size_t needed = kFrameSize + length;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_end + needed > _capacity)
+        {
+            compact();
+            if (_end + needed > _capacity)
+            {
+                throw QDB::Exception("Journal '" + _path + "' is full (" + std::to_string(_end - _begin) +
+                                     " of " + std::to_string(_capacity) + " bytes live)");
+            }
+        }
+
+        // Write the payload and checksum before the length, which is what makes the record visible.
+        unsigned char *frame = _data + _end;
+        std::memcpy(frame + kFrameSize, record.data(), length);
+        store(frame + 4, crc32(frame + kFrameSize, length));
+        store(frame, static_cast<std::uint32_t>(length));
+        sync_range(_end, needed);
+        _end += needed;
+        return _end + _shift;
+    }
+
+    void Journal::release(std::uint64_t position)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (position <= _begin + _shift)
+        {
+            return;
+        }
+        _begin = static_cast<std::size_t>(std::min<std::uint64_t>(position - _shift, _end));
+        store_begin();
+        if (_begin == _end)
+        {
+            // Nothing live is left: rewind. The header already points past every record, so zeroing the used
+            // region (which keeps stale frames from being read after the rewind) is safe at any point.
+            std::memset(_data + kHeaderSize, 0, _end - kHeaderSize);
+            sync_range(kHeaderSize, _end - kHeaderSize);
+            _shift += _end - kHeaderSize;
+            _begin = _end = kHeaderSize;
+            store_begin();
+        }
+    }
+
+    void Journal::clear()
+    {
+        std::uint64_t end_position;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            end_position = _end + _shift;
+        }
+        release(end_position);
+    }
+
+    std::vector<bsoncxx::document::value> Journal::records() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<bsoncxx::document::value> result;
+        for (std::size_t offset = _begin; offset < _end;)
+        {
+            const auto length = load<std::uint32_t>(_data + offset);
+            result.emplace_back(bsoncxx::document::view(_data + offset + kFrameSize, length));
+            offset += kFrameSize + length;
+        }
+        return result;
+    }
+
+    std::vector<std::uint64_t> Journal::record_ends() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<std::uint64_t> result;
+        for (std::size_t offset = _begin; offset < _end;)
+        {
+            offset += kFrameSize + load<std::uint32_t>(_data + offset);
+            result.push_back(offset + _shift);
+        }
+        return result;
+    }
+
+    bool Journal::empty() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _begin == _end;
+    }
+
+    void Journal::compact()
+    {
+        const std::size_t live = _end - _begin;
+        // Only compact when the copy and its end marker fit before the originals, so the originals stay
+        // intact until the header points at the copy and a crash at any step loses nothing.
+        if (kHeaderSize + live + sizeof(std::uint32_t) > _begin)
+        {
+            return;
+        }
+        const std::size_t old_end = _end;
+        std::memcpy(_data + kHeaderSize, _data + _begin, live);
+        store(_data + kHeaderSize + live, std::uint32_t{0});
+        sync_range(kHeaderSize, live + sizeof(std::uint32_t));
+
+        _shift += _begin - kHeaderSize;
+        _begin = kHeaderSize;
+        _end = kHeaderSize + live;
+        store_begin();
+
+        std::memset(_data + _end, 0, old_end - _end);
+        sync_range(_end, old_end - _end);
+    }
+
+    void Journal::store_begin()
+    {
+        store(_data + kBeginOffset, static_cast<std::uint64_t>(_begin));
+        sync_range(kBeginOffset, sizeof(std::uint64_t));
+    }
+} // namespace QDB
@@ -0,0 +1,468 @@
+#include "quickdb/components/metrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+
+namespace QDB
+{
+    namespace
+    {
+        // Latencies are bucketed log-linearly: 8 buckets per power of two, from 1ns to 2^40ns (about 18 minutes).
+        constexpr int kSubBucketBits = 3;
+        constexpr std::uint64_t kSubBuckets = 1u << kSubBucketBits;
+        constexpr int kMaxExponent = 39;
+        constexpr std::size_t kBuckets = kSubBuckets + (kMaxExponent - kSubBucketBits + 1) * kSubBuckets;
+
+        int floor_log2(std::uint64_t value)
+        {
+            int exponent = 0;
+            for (int shift = 32; shift > 0; shift >>= 1)
+            {
+                if (value >> shift)
+                {
+                    value >>= shift;
+                    exponent += shift;
+                }
+            }
+            return exponent;
+        }
+
+        std::size_t bucket_of(std::uint64_t nanoseconds)
+        {
+            if (nanoseconds < kSubBuckets)
+            {
+                return static_cast<std::size_t>(nanoseconds);
+            }
+            const int exponent = floor_log2(nanoseconds);
+            if (exponent > kMaxExponent)
+            {
+                return kBuckets - 1;
+            }
+            const std::uint64_t sub_bucket = (nanoseconds >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+            return static_cast<std::size_t>((exponent - kSubBucketBits + 1) * kSubBuckets + sub_bucket);
+        }
+
+        std::uint64_t bucket_upper_bound(std::size_t bucket)
+        {
+            if (bucket < kSubBuckets)
+            {
+                return bucket;
+            }
+            const int shift = static_cast<int>(bucket / kSubBuckets) - 1;
+            const std::uint64_t lower = (kSubBuckets + bucket % kSubBuckets) << shift;
+            return lower + (std::uint64_t{1} << shift) - 1;
+        }
+
+        /// @brief Adds to a counter only its owning thread writes; cheaper than an atomic read-modify-write.
+        void bump(std::atomic<std::uint64_t> &counter, std::uint64_t amount)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+
+        std::atomic<std::uint64_t> next_registry_uid{1};
+
+        /// @brief The shards this thread recently recorded into, by registry uid.
+        struct CachedShard
+        {
+            std::uint64_t uid;
+            void *shard;
+        };
+        thread_local std::vector<CachedShard> cached_shards;
+
+        /// @brief The most registries a thread remembers its shard for. Older entries are found again by thread
+        /// id under the registry's lock.
+        constexpr std::size_t kCachedShards = 8;
+
+        std::string format_duration(std::chrono::nanoseconds duration)
+        {
+            const double ns = static_cast<double>(duration.count());
+            char buffer[32];
+            if (ns < 1e3)
+                std::snprintf(buffer, sizeof(buffer), "%.0fns", ns);
+            else if (ns < 1e6)
+                std::snprintf(buffer, sizeof(buffer), "%.1fus", ns / 1e3);
+            else if (ns < 1e9)
+                std::snprintf(buffer, sizeof(buffer), "%.2fms", ns / 1e6);
+            else
+                std::snprintf(buffer, sizeof(buffer), "%.2fs", ns / 1e9);
+            return buffer;
+        }
+
+        void append_json_string(std::string &out, const std::string &text)
+        {
+            out += '"';
+            for (const char c : text)
+            {
+                if (c == '"' || c == '\\')
+                {
+                    out += '\\';
+                    out += c;
+                }
+                else if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                    out += escaped;
+                }
+                else
+                {
+                    out += c;
+                }
+            }
+            out += '"';
+        }
+    } // namespace
+
+    const char *operation_name(OperationKind operation)
+    {
+        switch (operation)
+        {
+        case OperationKind::kCreateOne:
+            return "create_one";
+        case OperationKind::kCreateMany:
+            return "create_many";
+        case OperationKind::kFindOne:
+            return "find_one";
+        case OperationKind::kFindMany:
+            return "find_many";
+        case OperationKind::kFindOneLazy:
+            return "find_one_lazy";
+        case OperationKind::kFindManyLazy:
+            return "find_many_lazy";
+        case OperationKind::kFindStream:
+            return "find_stream";
+        case OperationKind::kUpdateOne:
+            return "update_one";
+        case OperationKind::kUpdateMany:
+            return "update_many";
+        case OperationKind::kDeleteOne:
+            return "delete_one";
+        case OperationKind::kDeleteMany:
+            return "delete_many";
+        case OperationKind::kCountDocuments:
+            return "count_documents";
+        case OperationKind::kAggregate:
+            return "aggregate";
+        case OperationKind::kAggregateStream:
+            return "aggregate_stream";
+        case OperationKind::kFindOneAndUpdate:
+            return "find_one_and_update";
+        case OperationKind::kFindOneAndReplace:
+            return "find_one_and_replace";
+        case OperationKind::kFindOneAndDelete:
+            return "find_one_and_delete";
+        case OperationKind::kBulkWrite:
+            return "bulk_write";
+        case OperationKind::kWatch:
+            return "watch";
+        case OperationKind::kCreateIndex:
+            return "create_index";
+        case OperationKind::kDropIndex:
+            return "drop_index";
+        case OperationKind::kListIndexes:
+            return "list_indexes";
+        case OperationKind::kPoolAcquire:
+            return "pool_acquire";
+        case OperationKind::kUpload:
+            return "upload";
+        case OperationKind::kDownload:
+            return "download";
+        case OperationKind::kDeleteFile:
+            return "delete_file";
+        case OperationKind::kTransaction:
+            return "transaction";
+        case OperationKind::kPing:
+            return "ping";
+        }
+        return "unknown";
+    }
+
+    OperationTimer::~OperationTimer()
+    {
+        if (!_registry)
+        {
+            return;
+        }
+        _sample.latency = Clock::now() - _start;
+        _sample.failed = std::uncaught_exceptions() > _exceptions;
+        _registry->record(_series, _sample);
+    }
+
+    /// @brief One operation's counters in one thread's shard. Only the owning thread writes them.
+    struct MetricsRegistry::Cell
+    {
+        std::atomic<std::uint64_t> calls{0};
+        std::atomic<std::uint64_t> errors{0};
+        std::atomic<std::uint64_t> documents{0};
+        std::atomic<std::uint64_t> bytes_encoded{0};
+        std::atomic<std::uint64_t> bytes_decoded{0};
+        std::atomic<std::uint64_t> total_ns{0};
+        std::atomic<std::uint64_t> encode_ns{0};
+        std::atomic<std::uint64_t> decode_ns{0};
+        std::atomic<std::uint64_t> max_ns{0};
+        std::atomic<std::uint64_t> buckets[kBuckets]{};
+    };
+
+    /// @brief One thread's cells. Rows and cells are allocated by the owning thread on first use and published
+    /// with a release store, so snapshot() can read them without a lock.
+    struct MetricsRegistry::Shard
+    {
+        struct Row
+        {
+            std::atomic<Cell *> cells[kOperationCount]{};
+        };
+
+        std::atomic<Row *> rows[kMaxCollections]{};
+
+        ~Shard()
+        {
+            for (auto &slot : rows)
+            {
+                Row *row = slot.load(std::memory_order_relaxed);
+                if (!row)
+                {
+                    continue;
+                }
+                for (auto &cell : row->cells)
+                {
+                    delete cell.load(std::memory_order_relaxed);
+                }
+                delete row;
+            }
+        }
+    };
+
+    MetricsRegistry::MetricsRegistry() : _uid(next_registry_uid.fetch_add(1, std::memory_order_relaxed)) {}
+
+    MetricsRegistry::~MetricsRegistry() = default;
+
+    CollectionMetrics MetricsRegistry::collection(const std::string &database, const std::string &collection)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto key = std::make_pair(database, collection);
+        if (auto it = _indexes.find(key); it != _indexes.end())
+        {
+            return CollectionMetrics(this, it->second);
+        }
+        if (_names.size() == kMaxCollections)
+        {
+            return CollectionMetrics();
+        }
+        const std::size_t index = _names.size();
+        _names.push_back(key);
+        _indexes.emplace(std::move(key), index);
+        return CollectionMetrics(this, index);
+    }
+
+    MetricsRegistry::Shard &MetricsRegistry::local_shard()
+    {
+        for (const CachedShard &cached : cached_shards)
+        {
+            if (cached.uid == _uid)
+            {
+                return *static_cast<Shard *>(cached.shard);
+            }
+        }
+        Shard *shard;
+        {
+            // A thread id is reused only after its thread has exited, so a shard keeps a single writer.
+            std::lock_guard<std::mutex> lock(_mutex);
+            std::unique_ptr<Shard> &owned = _shards[std::this_thread::get_id()];
+            if (!owned)
+            {
+                owned = std::make_unique<Shard>();
+            }
+            shard = owned.get();
+        }
+        if (cached_shards.size() == kCachedShards)
+        {
+            cached_shards.erase(cached_shards.begin());
+        }
+        cached_shards.push_back(CachedShard{_uid, shard});
+        return *shard;
+    }
+
+    void MetricsRegistry::record(std::size_t series, const OperationSample &sample)
+    {
+        const std::size_t index = series / kOperationCount;
+        if (index >= kMaxCollections)
+        {
+            return;
+        }
+        Shard &shard = local_shard();
+        Shard::Row *row = shard.rows[index].load(std::memory_order_acquire);
+        if (!row)
+        {
+            row = new Shard::Row();
+            shard.rows[index].store(row, std::memory_order_release);
+        }
+        auto &slot = row->cells[series % kOperationCount];
+        Cell *cell = slot.load(std::memory_order_acquire);
+        if (!cell)
+        {
+            cell = new Cell();
+            slot.store(cell, std::memory_order_release);
+        }
+
+        const auto latency = static_cast<std::uint64_t>(std::max<std::int64_t>(0, sample.latency.count()));
+        bump(cell->calls, 1);
+        bump(cell->errors, sample.failed ? 1 : 0);
+        bump(cell->documents, sample.documents);
+        bump(cell->bytes_encoded, sample.bytes_encoded);
+        bump(cell->bytes_decoded, sample.bytes_decoded);
+        bump(cell->total_ns, latency);
+        bump(cell->encode_ns, static_cast<std::uint64_t>(sample.encode_time.count()));
+        bump(cell->decode_ns, static_cast<std::uint64_t>(sample.decode_time.count()));
+        bump(cell->buckets[bucket_of(latency)], 1);
+        if (latency > cell->max_ns.load(std::memory_order_relaxed))
+        {
+            cell->max_ns.store(latency, std::memory_order_relaxed);
+        }
+    }
+
+    MetricsSnapshot MetricsRegistry::snapshot() const
+    {
+        MetricsSnapshot snapshot;
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<std::uint64_t> buckets(kBuckets);
+        for (const auto &[name, index] : _indexes)
+        {
+            for (std::size_t op = 0; op < kOperationCount; ++op)
+            {
+                OperationStats stats;
+                std::uint64_t total_ns = 0, encode_ns = 0, decode_ns = 0, max_ns = 0;
+                std::fill(buckets.begin(), buckets.end(), 0);
+                for (const auto &[thread, shard] : _shards)
+                {
+                    const Shard::Row *row = shard->rows[index].load(std::memory_order_acquire);
+                    const Cell *cell = row ? row->cells[op].load(std::memory_order_acquire) : nullptr;
+                    if (!cell)
+                    {
+                        continue;
+                    }
+                    stats.calls += cell->calls.load(std::memory_order_relaxed);
+                    stats.errors += cell->errors.load(std::memory_order_relaxed);
+                    stats.documents += cell->documents.load(std::memory_order_relaxed);
+                    stats.bytes_encoded += cell->bytes_encoded.load(std::memory_order_relaxed);
+                    stats.bytes_decoded += cell->bytes_decoded.load(std::memory_order_relaxed);
+                    total_ns += cell->total_ns.load(std::memory_order_relaxed);
+                    encode_ns += cell->encode_ns.load(std::memory_order_relaxed);
+                    decode_ns += cell->decode_ns.load(std::memory_order_relaxed);
+                    max_ns = std::max(max_ns, cell->max_ns.load(std::memory_order_relaxed));
+                    for (std::size_t bucket = 0; bucket < kBuckets; ++bucket)
+                    {
+                        buckets[bucket] += cell->buckets[bucket].load(std::memory_order_relaxed);
+                    }
+                }
+                if (stats.calls == 0)
+                {
+                    continue;
+                }
+
+                stats.database = name.first;
+                stats.collection = name.second;
+                stats.operation = static_cast<OperationKind>(op);
+                stats.total_time = std::chrono::nanoseconds(total_ns);
+                stats.encode_time = std::chrono::nanoseconds(encode_ns);
+                stats.decode_time = std::chrono::nanoseconds(decode_ns);
+                stats.max = std::chrono::nanoseconds(max_ns);
+
+                // The bucket counts may be read a little ahead of or behind `calls`, so rank against their sum.
+                std::uint64_t counted = 0;
+                for (const std::uint64_t count : buckets)
+                {
+                    counted += count;
+                }
+                auto percentile = [&](double quantile)
+                {
+                    const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(quantile * counted + 0.999));
+                    std::uint64_t seen = 0;
+                    for (std::size_t bucket = 0; bucket < kBuckets; ++bucket)
+                    {
+                        seen += buckets[bucket];
+                        if (seen >= rank)
+                        {
+                            return std::chrono::nanoseconds(std::min(bucket_upper_bound(bucket), max_ns));
+                        }
+                    }
+                    return stats.max;
+                };
+                stats.p50 = percentile(0.5);
+                stats.p99 = percentile(0.99);
+                stats.p999 = percentile(0.999);
+                snapshot.operations.push_back(std::move(stats));
+            }
+        }
+        return snapshot;
+    }
+
+    const OperationStats *MetricsSnapshot::find(const std::string &database, const std::string &collection,
+                                                OperationKind operation) const
+    {
+        for (const auto &stats : operations)
+        {
+            if (stats.operation == operation && stats.database == database && stats.collection == collection)
+            {
+                return &stats;
+            }
+        }
+        return nullptr;
+    }
+
+    std::string MetricsSnapshot::to_text() const
+    {
+        std::string out;
+        for (const auto &stats : operations)
+        {
+            std::string name = stats.database;
+            if (!stats.collection.empty())
+            {
+                name += "." + stats.collection;
+            }
+            out += (name.empty() ? "*" : name) + " " + operation_name(stats.operation) +
+                   " calls=" + std::to_string(stats.calls) + " errors=" + std::to_string(stats.errors) +
+                   " p50=" + format_duration(stats.p50) + " p99=" + format_duration(stats.p99) +
+                   " p999=" + format_duration(stats.p999) + " max=" + format_duration(stats.max) +
+                   " mean=" + format_duration(stats.mean()) + " total=" + format_duration(stats.total_time) +
+                   " encode=" + format_duration(stats.encode_time) + " decode=" + format_duration(stats.decode_time) +
+                   " docs=" + std::to_string(stats.documents) + " bytes_out=" + std::to_string(stats.bytes_encoded) +
+                   " bytes_in=" + std::to_string(stats.bytes_decoded) + "\n";
+        }
+        return out;
+    }
+
+    std::string MetricsSnapshot::to_json() const
+    {
+        std::string out = "{\"operations\":[";
+        bool first = true;
+        for (const auto &stats : operations)
+        {
+            if (!first)
+            {
+                out += ',';
+            }
+            first = false;
+            out += "{\"database\":";
+            append_json_string(out, stats.database);
+            out += ",\"collection\":";
+            append_json_string(out, stats.collection);
+            out += ",\"operation\":\"" + std::string(operation_name(stats.operation)) + "\"";
+            out += ",\"calls\":" + std::to_string(stats.calls);
+            out += ",\"errors\":" + std::to_string(stats.errors);
+            out += ",\"documents\":" + std::to_string(stats.documents);
+            out += ",\"bytes_encoded\":" + std::to_string(stats.bytes_encoded);
+            out += ",\"bytes_decoded\":" + std::to_string(stats.bytes_decoded);
+            out += ",\"total_ns\":" + std::to_string(stats.total_time.count());
+            out += ",\"encode_ns\":" + std::to_string(stats.encode_time.count());
+            out += ",\"decode_ns\":" + std::to_string(stats.decode_time.count());
+            out += ",\"p50_ns\":" + std::to_string(stats.p50.count());
+            out += ",\"p99_ns\":" + std::to_string(stats.p99.count());
+            out += ",\"p999_ns\":" + std::to_string(stats.p999.count());
+            out += ",\"max_ns\":" + std::to_string(stats.max.count());
+            out += '}';
+        }
+        out += "]}";
+        return out;
+    }
+} // namespace QDB
@@ -0,0 +1,287 @@
+#include "quickdb/components/query_shape.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <vector>
+
+#include <bsoncxx/types.hpp>
+
+namespace QDB
+{
+    namespace
+    {
+        /// @brief Checks whether the documents under a key are filters, whose key order does not matter.
+        bool holds_filters(std::string_view key)
+        {
+            return key == "$match" || key == "$elemMatch" || key == "$or" || key == "$and" || key == "$nor";
+        }
+
+        bool is_operator_document(const bsoncxx::document::view &document)
+        {
+            bool any = false;
+            for (const auto &element : document)
+            {
+                const std::string_view key = element.key();
+                if (key.empty() || key.front() != '$')
+                {
+                    return false;
+                }
+                any = true;
+            }
+            return any;
+        }
+
+        void append_string(std::string &out, std::string_view text)
+        {
+            out += '"';
+            for (const char c : text)
+            {
+                if (c == '"' || c == '\\')
+                {
+                    out += '\\';
+                    out += c;
+                }
+                else if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                    out += escaped;
+                }
+                else
+                {
+                    out += c;
+                }
+            }
+            out += '"';
+        }
+
+        void append_hex(std::string &out, const std::uint8_t *bytes, std::size_t length)
+        {
+            static const char digits[] = "0123456789abcdef";
+            for (std::size_t i = 0; i < length; ++i)
+            {
+                out += digits[bytes[i] >> 4];
+                out += digits[bytes[i] & 0x0F];
+            }
+        }
+
+        void append_document(std::string &out, const bsoncxx::document::view &document, ShapeMode mode, bool sort_keys);
+        void append_array(std::string &out, const bsoncxx::array::view &array, ShapeMode mode, bool filters);
+
+        /// @brief Appends a scalar with its type.
+        void append_scalar(std::string &out, const bsoncxx::document::element &element)
+        {
+            char buffer[64];
+            switch (element.type())
+            {
+            case bsoncxx::type::k_double:
+                std::snprintf(buffer, sizeof(buffer), "%.17gd", element.get_double().value);
+                out += buffer;
+                break;
+            case bsoncxx::type::k_int32:
+                out += std::to_string(element.get_int32().value);
+                break;
+            case bsoncxx::type::k_int64:
+                out += std::to_string(element.get_int64().value);
+                out += 'L';
+                break;
+            case bsoncxx::type::k_decimal128:
+                out += "Decimal(" + element.get_decimal128().value.to_string() + ")";
+                break;
+            case bsoncxx::type::k_string:
+                append_string(out, element.get_string().value);
+                break;
+            case bsoncxx::type::k_bool:
+                out += element.get_bool().value ? "true" : "false";
+                break;
+            case bsoncxx::type::k_null:
+                out += "null";
+                break;
+            case bsoncxx::type::k_oid:
+                out += "ObjectId(" + element.get_oid().value.to_string() + ")";
+                break;
+            case bsoncxx::type::k_date:
+                std::snprintf(buffer, sizeof(buffer), "Date(%" PRId64 ")", element.get_date().to_int64());
+                out += buffer;
+                break;
+            case bsoncxx::type::k_timestamp:
+            {
+                const auto timestamp = element.get_timestamp();
+                std::snprintf(buffer, sizeof(buffer), "Timestamp(%u,%u)", static_cast<unsigned>(timestamp.timestamp),
+                              static_cast<unsigned>(timestamp.increment));
+                out += buffer;
+                break;
+            }
+            case bsoncxx::type::k_regex:
+            {
+                const auto regex = element.get_regex();
+                out += "Regex(";
+                append_string(out, regex.regex);
+                out += ',';
+                append_string(out, regex.options);
+                out += ')';
+                break;
+            }
+            case bsoncxx::type::k_binary:
+            {
+                const auto binary = element.get_binary();
+                out += "Bin(" + std::to_string(static_cast<int>(binary.sub_type)) + ",";
+                append_hex(out, binary.bytes, binary.size);
+                out += ')';
+                break;
+            }
+            case bsoncxx::type::k_code:
+                out += "Code(";
+                append_string(out, element.get_code().code);
+                out += ')';
+                break;
+            case bsoncxx::type::k_codewscope:
+            {
+                const auto code = element.get_codewscope();
+                out += "Code(";
+                append_string(out, code.code);
+                out += ',';
+                append_document(out, code.scope, ShapeMode::kWithValues, false);
+                out += ')';
+                break;
+            }
+            case bsoncxx::type::k_symbol:
+                out += "Symbol(";
+                append_string(out, element.get_symbol().symbol);
+                out += ')';
+                break;
+            case bsoncxx::type::k_dbpointer:
+            {
+                const auto pointer = element.get_dbpointer();
+                out += "DBPointer(";
+                append_string(out, pointer.collection);
+                out += "," + pointer.value.to_string() + ")";
+                break;
+            }
+            case bsoncxx::type::k_minkey:
+                out += "MinKey";
+                break;
+            case bsoncxx::type::k_maxkey:
+                out += "MaxKey";
+                break;
+            default:
+                out += "Undefined";
+                break;
+            }
+        }
+
+        /// @brief Appends an element's value. `key` is the key it is stored under, which decides whether an
+        /// embedded document's keys may be sorted.
+        void append_value(std::string &out, const bsoncxx::document::element &element, std::string_view key,
+                          ShapeMode mode)
+        {
+            switch (element.type())
+            {
+            case bsoncxx::type::k_document:
+            {
+                const bsoncxx::document::view document = element.get_document().value;
+                append_document(out, document, mode, holds_filters(key) || is_operator_document(document));
+                break;
+            }
+            case bsoncxx::type::k_array:
+                append_array(out, element.get_array().value, mode, holds_filters(key));
+                break;
+            default:
+                if (mode == ShapeMode::kRedacted)
+                {
+                    out += '?';
+                }
+                else
+                {
+                    append_scalar(out, element);
+                }
+                break;
+            }
+        }
+
+        void append_document(std::string &out, const bsoncxx::document::view &document, ShapeMode mode, bool sort_keys)
+        {
+            std::vector<bsoncxx::document::element> elements(document.begin(), document.end());
+            if (sort_keys)
+            {
+                std::stable_sort(elements.begin(), elements.end(),
+                                 [](const bsoncxx::document::element &lhs, const bsoncxx::document::element &rhs)
+                                 { return std::string_view(lhs.key()) < std::string_view(rhs.key()); });
+            }
+            out += '{';
+            bool first = true;
+            for (const auto &element : elements)
+            {
+                if (!first)
+                {
+                    out += ',';
+                }
+                first = false;
+                const std::string_view key = element.key();
+                append_string(out, key);
+                out += ':';
+                append_value(out, element, key, mode);
+            }
+            out += '}';
+        }
+
+        void append_array(std::string &out, const bsoncxx::array::view &array, ShapeMode mode, bool filters)
+        {
+            if (mode == ShapeMode::kRedacted)
+            {
+                // An array of literals (e.g. the operand of $in) has one shape whatever its length.
+                const bool literals = std::none_of(array.begin(), array.end(),
+                                                   [](const bsoncxx::array::element &element)
+                                                   {
+                                                       return element.type() == bsoncxx::type::k_document ||
+                                                              element.type() == bsoncxx::type::k_array;
+                                                   });
+                if (literals)
+                {
+                    out += array.begin() == array.end() ? "[]" : "[?]";
+                    return;
+                }
+            }
+            out += '[';
+            bool first = true;
+            for (const auto &element : array)
+            {
+                if (!first)
+                {
+                    out += ',';
+                }
+                first = false;
+                // Elements of $or/$and/$nor are filters; pipeline stages are operator documents.
+                append_value(out, element, filters ? "$match" : "", mode);
+            }
+            out += ']';
+        }
+    } // namespace
+
+    std::string canonical_document(const bsoncxx::document::view &document, ShapeMode mode, bool sort_root_keys)
+    {
+        std::string out;
+        out.reserve(document.length());
+        append_document(out, document, mode, sort_root_keys);
+        return out;
+    }
+
+    std::string canonical_array(const bsoncxx::array::view &array, ShapeMode mode)
+    {
+        std::string out;
+        out.reserve(array.length());
+        append_array(out, array, mode, false);
+        return out;
+    }
+
+    std::uint64_t shape_hash(std::string_view canonical)
+    {
+        std::uint64_t hash = 14695981039346656037ull;
+        for (const char c : canonical)
+        {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        }
+        return hash;
+    }
+} // namespace QDB
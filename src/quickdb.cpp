@@ -1,14 +1,30 @@
 #include "quickdb/quickdb.h"
 #include "quickdb/components/exception.h"
 
+#include <filesystem>
+
 // All mongocxx headers are included ONLY in the .cpp file.
 #include <mongocxx/client.hpp>
 #include <mongocxx/instance.hpp>
+#include <mongocxx/options/apm.hpp>
+#include <mongocxx/options/client.hpp>
+#include <mongocxx/options/pool.hpp>
 #include <mongocxx/pool.hpp>
 #include <mongocxx/uri.hpp>
 
 namespace QDB
 {
+    namespace
+    {
+        /// @brief Assembles the URI of an authenticated connection from its components.
+        std::string authenticated_uri(const std::string &user, const std::string &pass, const std::string &host,
+                                      std::uint16_t port, const std::string &auth_db, std::uint32_t max_pool_size)
+        {
+            return "mongodb://" + user + ":" + pass + "@" + host + ":" + std::to_string(port) +
+                   "/?authSource=" + auth_db + "&maxPoolSize=" + std::to_string(max_pool_size);
+        }
+    } // namespace
+
     // The mongocxx::instance must be created once per process.
     // This static method ensures that rule is followed.
     mongocxx::instance &Database::get_instance()
@@ -35,34 +51,52 @@ namespace QDB
         }
     }
 
-    Database::Database(const std::string &user, const std::string &pass, const std::string &host, std::uint16_t port,
-                       const std::string &auth_db, std::uint32_t max_pool_size)
+    Database::Database(const std::string &uri_string, const SlowLogOptions &slow_log)
     {
         try
         {
-            // First, ensure the global driver instance is initialized.
             get_instance();
 
-            // Assemble the full URI from the provided components.
-            std::string uri_string = "mongodb://" + user + ":" + pass + "@" + host + ":" + std::to_string(port) +
-                                     "/?authSource=" + auth_db + "&maxPoolSize=" + std::to_string(max_pool_size);
+            m_slow_log = std::make_unique<SlowOperationLog>(slow_log);
+            mongocxx::options::apm apm;
+            m_slow_log->attach(apm);
+            mongocxx::options::client client_options;
+            client_options.apm_opts(apm);
 
             mongocxx::uri uri(uri_string);
-            m_pool = std::make_unique<mongocxx::pool>(uri);
+            m_pool = std::make_unique<mongocxx::pool>(uri, mongocxx::options::pool(client_options));
         }
         catch (const std::exception &e)
         {
-            // Wrap any driver exception in our custom exception type.
             throw QDB::Exception(e.what());
         }
     }
 
+    Database::Database(const std::string &user, const std::string &pass, const std::string &host, std::uint16_t port,
+                       const std::string &auth_db, std::uint32_t max_pool_size)
+        : Database(authenticated_uri(user, pass, host, port, auth_db, max_pool_size))
+    {
+    }
+
+    Database::Database(const std::string &user, const std::string &pass, const std::string &host, std::uint16_t port,
+                       const std::string &auth_db, std::uint32_t max_pool_size, const SlowLogOptions &slow_log)
+        : Database(authenticated_uri(user, pass, host, port, auth_db, max_pool_size), slow_log)
+    {
+    }
+
     Database::~Database() = default; // Default destructor is fine with unique_ptr
 
     void Database::with_transaction(std::function<void(mongocxx::client_session &session)> callback)
     {
+        CollectionMetrics metrics = m_metrics->collection("", "");
+        auto timer = metrics.time(OperationKind::kTransaction);
+
         // Acquire a client from the pool for the scope of this transaction.
-        auto client = m_pool->acquire();
+        auto client = [&]
+        {
+            auto acquire_timer = metrics.time(OperationKind::kPoolAcquire);
+            return m_pool->acquire();
+        }();
         // A session must be started on a specific client.
         auto session = client->start_session();
 
@@ -88,14 +122,19 @@ namespace QDB
     {
         try
         {
-            auto client_entry = std::make_unique<mongocxx::pool::entry>(m_pool->acquire());
+            CollectionMetrics metrics = m_metrics->collection(db_name, bucket_name);
+            std::unique_ptr<mongocxx::pool::entry> client_entry;
+            {
+                auto timer = metrics.time(OperationKind::kPoolAcquire);
+                client_entry = std::make_unique<mongocxx::pool::entry>(m_pool->acquire());
+            }
             auto db = (*(*client_entry))[db_name];
 
             mongocxx::options::gridfs::bucket bucket_options;
             bucket_options.bucket_name(bucket_name);
 
             auto bucket_handle = db.gridfs_bucket(bucket_options);
-            return GridFSBucket(std::move(client_entry), std::move(bucket_handle));
+            return GridFSBucket(std::move(client_entry), std::move(bucket_handle), metrics);
         }
         catch (const std::exception &e)
         {
@@ -103,8 +142,130 @@ namespace QDB
         }
     }
 
+    JournalReplayResult Database::replay_journal(const std::string &path)
+    {
+        JournalReplayResult result;
+        if (!std::filesystem::exists(path))
+        {
+            return result;
+        }
+
+        Journal journal(path);
+        const std::vector<bsoncxx::document::value> records = journal.records();
+        const std::vector<std::uint64_t> ends = journal.record_ends();
+
+        // A journal record is {db, collection, op}, where op is a BulkWriter::export_operation() document.
+        struct Entry
+        {
+            std::string db_name;
+            std::string collection_name;
+            bsoncxx::document::view op;
+            bool insert;
+            /// @brief The journal position just past the record, released once the entry is done.
+            std::uint64_t end;
+        };
+        std::vector<Entry> entries;
+        entries.reserve(records.size());
+        for (std::size_t r = 0; r < records.size(); ++r)
+        {
+            const auto &record = records[r];
+            auto db_name = record.view()["db"];
+            auto collection_name = record.view()["collection"];
+            auto op = record.view()["op"];
+            if (!db_name || db_name.type() != bsoncxx::type::k_string || !collection_name ||
+                collection_name.type() != bsoncxx::type::k_string || !op || op.type() != bsoncxx::type::k_document)
+            {
+                result.errors.push_back("Malformed journal record skipped");
+                continue;
+            }
+            auto type = op.get_document().value["type"];
+            entries.push_back(Entry{std::string(db_name.get_string().value),
+                                    std::string(collection_name.get_string().value), op.get_document().value,
+                                    type && type.type() == bsoncxx::type::k_int32 &&
+                                        type.get_int32().value == static_cast<std::int32_t>(BulkOpType::kInsert),
+                                    ends[r]});
+        }
+
+        try
+        {
+            auto client = m_pool->acquire();
+
+            // Replay runs of consecutive entries for one collection. A run holds only inserts, sent unordered
+            // so inserts that already landed do not stop the rest, or only other operations, sent ordered to
+            // keep their sequence. After an ordered run stops at an error, the remainder is sent again.
+            std::size_t next = 0;
+            while (next < entries.size())
+            {
+                const Entry &first = entries[next];
+                BulkWriter<Document> writer((*client)[first.db_name][first.collection_name],
+                                            BulkWriteOptions{}.ordered(!first.insert));
+                std::vector<std::size_t> sources;
+                std::size_t end = next;
+                for (; end < entries.size(); ++end)
+                {
+                    const Entry &entry = entries[end];
+                    if (entry.db_name != first.db_name || entry.collection_name != first.collection_name ||
+                        entry.insert != first.insert)
+                    {
+                        break;
+                    }
+                    try
+                    {
+                        writer.import_operation(entry.op);
+                        sources.push_back(end);
+                    }
+                    catch (const QDB::Exception &e)
+                    {
+                        result.errors.push_back(e.what());
+                    }
+                }
+
+                BulkWriteResult batch = writer.execute();
+                next = end;
+                for (std::size_t i = 0; i < batch.operations.size(); ++i)
+                {
+                    const BulkOpResult &outcome = batch.operations[i];
+                    constexpr std::int32_t kDuplicateKey = 11000;
+                    if (outcome.status == BulkOpStatus::kSucceeded)
+                    {
+                        ++result.applied;
+                    }
+                    else if (outcome.status == BulkOpStatus::kFailed && first.insert &&
+                             outcome.error_code == kDuplicateKey)
+                    {
+                        ++result.already_applied;
+                    }
+                    else if (outcome.status == BulkOpStatus::kFailed)
+                    {
+                        result.errors.push_back(outcome.error_message);
+                    }
+                    else
+                    {
+                        next = sources[i];
+                        break;
+                    }
+                }
+
+                // Entries before `next` are applied or dropped. Releasing them keeps a replay retried after a
+                // failure from applying updates and deletes twice.
+                if (next > 0)
+                {
+                    journal.release(entries[next - 1].end);
+                }
+            }
+        }
+        catch (const std::exception &e)
+        {
+            throw QDB::Exception("Failed to replay journal '" + path + "': " + std::string(e.what()));
+        }
+
+        journal.clear();
+        return result;
+    }
+
     void Database::ping()
     {
+        auto timer = m_metrics->collection("admin", "").time(OperationKind::kPing);
         try
         {
             auto client = m_pool->acquire();
@@ -0,0 +1,99 @@
+#include "quickdb/components/result_cache.h"
+
+namespace QDB
+{
+    std::shared_ptr<const std::any> ResultCache::lookup(const std::string &scope, std::uint64_t hash,
+                                                        const std::string &canonical, std::uint64_t &ticket)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _entries.find(Key(scope, hash));
+        if (it != _entries.end() && it->second.expires <= std::chrono::steady_clock::now())
+        {
+            erase(it);
+            ++_stats.evictions;
+            it = _entries.end();
+        }
+        if (it == _entries.end() || it->second.canonical != canonical)
+        {
+            ++_stats.misses;
+            ticket = _generations[scope];
+            return nullptr;
+        }
+        ++_stats.hits;
+        _lru.splice(_lru.begin(), _lru, it->second.position);
+        return it->second.value;
+    }
+
+    void ResultCache::store(const std::string &scope, std::uint64_t hash, const std::string &canonical,
+                            std::shared_ptr<const std::any> value, std::uint64_t ticket)
+    {
+        if (_options.get_max_entries() == 0)
+        {
+            return;
+        }
+        const auto expires = std::chrono::steady_clock::now() + _options.get_ttl();
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_generations[scope] != ticket)
+        {
+            return;
+        }
+        Key key(scope, hash);
+        if (auto it = _entries.find(key); it != _entries.end())
+        {
+            // Refresh, or replace a colliding canonical form.
+            it->second.canonical = canonical;
+            it->second.value = std::move(value);
+            it->second.expires = expires;
+            _lru.splice(_lru.begin(), _lru, it->second.position);
+            return;
+        }
+        _lru.push_front(key);
+        _entries.emplace(std::move(key), Entry{canonical, std::move(value), expires, _lru.begin()});
+        if (_entries.size() > _options.get_max_entries())
+        {
+            erase(_entries.find(_lru.back()));
+            ++_stats.evictions;
+        }
+    }
+
+    void ResultCache::invalidate(const std::string &scope)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_generations[scope];
+        // Keys are ordered by scope first, so the scope's entries are contiguous.
+        auto it = _entries.lower_bound(Key(scope, 0));
+        while (it != _entries.end() && it->first.first == scope)
+        {
+            auto next = std::next(it);
+            erase(it);
+            ++_stats.invalidations;
+            it = next;
+        }
+    }
+
+    void ResultCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto &generation : _generations)
+        {
+            ++generation.second;
+        }
+        _stats.invalidations += _entries.size();
+        _entries.clear();
+        _lru.clear();
+    }
+
+    ResultCacheStats ResultCache::stats() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ResultCacheStats stats = _stats;
+        stats.size = _entries.size();
+        return stats;
+    }
+
+    void ResultCache::erase(std::map<Key, Entry>::iterator it)
+    {
+        _lru.erase(it->second.position);
+        _entries.erase(it);
+    }
+} // namespace QDB
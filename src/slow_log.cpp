@@ -0,0 +1,383 @@
+#include "quickdb/components/slow_log.h"
+#include "quickdb/components/exception.h"
+#include "quickdb/components/query_shape.h"
+
+#include <cstdio>
+#include <ctime>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <bsoncxx/builder/basic/array.hpp>
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/types.hpp>
+#include <mongocxx/events/command_failed_event.hpp>
+#include <mongocxx/events/command_started_event.hpp>
+#include <mongocxx/events/command_succeeded_event.hpp>
+
+namespace QDB
+{
+    namespace
+    {
+        /// @brief A command started on this thread and not finished yet.
+        struct PendingCommand
+        {
+            const SlowOperationLog *log;
+            std::int64_t request_id;
+            std::string database;
+            std::string collection;
+            bsoncxx::document::value command;
+        };
+
+        /// @brief Commands run synchronously on the calling thread, so a command's events arrive on the thread
+        /// that started it. Entries whose finish event never came are dropped once the list is full.
+        constexpr std::size_t kMaxPending = 8;
+
+        std::vector<PendingCommand> &pending_commands()
+        {
+            thread_local std::vector<PendingCommand> pending;
+            return pending;
+        }
+
+        std::optional<PendingCommand> take_pending(const SlowOperationLog *log, std::int64_t request_id)
+        {
+            auto &pending = pending_commands();
+            for (auto it = pending.begin(); it != pending.end(); ++it)
+            {
+                if (it->log == log && it->request_id == request_id)
+                {
+                    PendingCommand found = std::move(*it);
+                    pending.erase(it);
+                    return found;
+                }
+            }
+            return std::nullopt;
+        }
+
+        /// @brief Checks whether a field belongs to the session or cluster rather than the command.
+        bool is_session_field(std::string_view key)
+        {
+            return key == "lsid" || key == "txnNumber" || key == "autocommit" || key == "startTransaction" ||
+                   key == "$clusterTime" || key == "$db" || key == "$readPreference";
+        }
+
+        /// @brief Checks whether a field holds the statements of a batch, which usually share a shape.
+        bool is_batch_field(std::string_view key) { return key == "documents" || key == "updates" || key == "deletes"; }
+
+        /// @brief Copies a command without its session fields, keeping only the first statement of a batch.
+        bsoncxx::document::value summarize(const bsoncxx::document::view &command)
+        {
+            using bsoncxx::builder::basic::kvp;
+            bsoncxx::builder::basic::document builder;
+            for (const auto &element : command)
+            {
+                const std::string_view key = element.key();
+                if (is_session_field(key))
+                {
+                    continue;
+                }
+                if (is_batch_field(key) && element.type() == bsoncxx::type::k_array)
+                {
+                    const bsoncxx::array::view statements = element.get_array().value;
+                    bsoncxx::builder::basic::array first;
+                    if (statements.begin() != statements.end())
+                    {
+                        first.append((*statements.begin()).get_value());
+                    }
+                    builder.append(kvp(std::string(key), first.extract()));
+                    continue;
+                }
+                builder.append(kvp(std::string(key), element.get_value()));
+            }
+            return builder.extract();
+        }
+
+        /// @brief Gets the collection a command targets: its first value, or the `collection` of a getMore.
+        std::string collection_of(const bsoncxx::document::view &command)
+        {
+            if (auto collection = command["collection"]; collection && collection.type() == bsoncxx::type::k_string)
+            {
+                return std::string(collection.get_string().value);
+            }
+            auto first = command.begin();
+            if (first != command.end() && first->type() == bsoncxx::type::k_string)
+            {
+                return std::string(first->get_string().value);
+            }
+            return std::string();
+        }
+
+        /// @brief Gets the error code of a failure document.
+        std::int32_t error_code(const bsoncxx::document::view &failure)
+        {
+            auto code = failure["code"];
+            if (code && code.type() == bsoncxx::type::k_int32)
+            {
+                return code.get_int32().value;
+            }
+            if (code && code.type() == bsoncxx::type::k_int64)
+            {
+                return static_cast<std::int32_t>(code.get_int64().value);
+            }
+            return 0;
+        }
+
+        /// @brief Gets the server's name for the error code of a failure document.
+        std::string error_name(const bsoncxx::document::view &failure)
+        {
+            auto name = failure["codeName"];
+            return name && name.type() == bsoncxx::type::k_string ? std::string(name.get_string().value) : std::string();
+        }
+
+        void append_json_string(std::string &out, std::string_view text)
+        {
+            out += '"';
+            for (const char c : text)
+            {
+                if (c == '"' || c == '\\')
+                {
+                    out += '\\';
+                    out += c;
+                }
+                else if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                    out += escaped;
+                }
+                else
+                {
+                    out += c;
+                }
+            }
+            out += '"';
+        }
+
+        /// @brief Formats a time as ISO 8601 UTC with milliseconds.
+        std::string format_time(std::chrono::system_clock::time_point time)
+        {
+            const std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+            const auto millis =
+                std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count() % 1000;
+            std::tm utc{};
+#if defined(_WIN32)
+            gmtime_s(&utc, &seconds);
+#else
+            gmtime_r(&seconds, &utc);
+#endif
+            char buffer[32];
+            const std::size_t length = std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &utc);
+            std::snprintf(buffer + length, sizeof(buffer) - length, ".%03dZ", static_cast<int>(millis));
+            return buffer;
+        }
+
+        /// @brief Renders a command as one line of the log.
+        std::string to_line(const SlowCommand &command)
+        {
+            std::string line = "{\"time\":";
+            append_json_string(line, format_time(command.time));
+            line += ",\"command\":";
+            append_json_string(line, command.command_name);
+            line += ",\"database\":";
+            append_json_string(line, command.database);
+            line += ",\"collection\":";
+            append_json_string(line, command.collection);
+            line += ",\"server\":";
+            append_json_string(line, command.server);
+            line += ",\"duration_us\":" + std::to_string(command.duration.count());
+            line += ",\"reply_bytes\":" + std::to_string(command.reply_bytes);
+            line += command.failed ? ",\"ok\":false" : ",\"ok\":true";
+            if (command.failed)
+            {
+                line += ",\"error_code\":" + std::to_string(command.error_code);
+                line += ",\"error_name\":";
+                append_json_string(line, command.error_name);
+            }
+            line += ",\"shape\":";
+            if (command.command)
+            {
+                append_json_string(line, canonical_document(command.command->view(), ShapeMode::kRedacted));
+            }
+            else
+            {
+                line += "null";
+            }
+            line += "}\n";
+            return line;
+        }
+    } // namespace
+
+    SlowOperationLog::SlowOperationLog(const SlowLogOptions &options) : _options(options)
+    {
+        _file.open(options.get_path(), std::ios::out | std::ios::app);
+        if (!_file)
+        {
+            throw QDB::Exception("Failed to open slow operation log '" + options.get_path() + "'.");
+        }
+
+        std::size_t capacity = 1;
+        while (capacity < options.get_capacity())
+        {
+            capacity <<= 1;
+        }
+        _slots = std::make_unique<Slot[]>(capacity);
+        for (std::size_t i = 0; i < capacity; ++i)
+        {
+            _slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        _mask = capacity - 1;
+
+        _writer = std::thread([this] { run(); });
+    }
+
+    SlowOperationLog::~SlowOperationLog()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _wake.notify_one();
+        _writer.join();
+    }
+
+    void SlowOperationLog::attach(mongocxx::options::apm &apm)
+    {
+        apm.on_command_started(
+            [this](const mongocxx::events::command_started_event &event)
+            {
+                auto &pending = pending_commands();
+                if (pending.size() == kMaxPending)
+                {
+                    pending.erase(pending.begin());
+                }
+                const bsoncxx::document::view command = event.command();
+                pending.push_back(PendingCommand{this, event.request_id(), std::string(event.database_name()),
+                                                 collection_of(command), summarize(command)});
+            });
+
+        // Both finish events carry the same fields; the failure document stands in for the reply.
+        auto finish = [this](const auto &event, bsoncxx::document::view reply, bool failed)
+        {
+            std::optional<PendingCommand> started = take_pending(this, event.request_id());
+            const std::chrono::microseconds duration(event.duration());
+            if (duration < _options.get_threshold() && !(failed && _options.logs_failures()))
+            {
+                return;
+            }
+
+            SlowCommand command;
+            command.time = std::chrono::system_clock::now();
+            command.command_name = std::string(event.command_name());
+            command.server = std::string(event.host()) + ":" + std::to_string(event.port());
+            command.duration = duration;
+            command.reply_bytes = reply.length();
+            command.failed = failed;
+            if (failed)
+            {
+                // Messages such as E11000 quote key values, so only the code is kept.
+                command.error_code = error_code(reply);
+                command.error_name = error_name(reply);
+            }
+            if (started)
+            {
+                command.database = std::move(started->database);
+                command.collection = std::move(started->collection);
+                command.command = std::move(started->command);
+            }
+            record(std::move(command));
+        };
+        apm.on_command_succeeded([finish](const mongocxx::events::command_succeeded_event &event)
+                                 { finish(event, event.reply(), false); });
+        apm.on_command_failed([finish](const mongocxx::events::command_failed_event &event)
+                              { finish(event, event.failure(), true); });
+    }
+
+    bool SlowOperationLog::record(SlowCommand command)
+    {
+        // A bounded multi-producer queue: a slot whose sequence equals the claimed position is free, and one
+        // whose sequence is a lap behind still holds a command the writer has not read.
+        std::uint64_t position = _tail.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Slot &slot = _slots[position & _mask];
+            const std::uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto lag = static_cast<std::int64_t>(sequence - position);
+            if (lag == 0)
+            {
+                if (_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    slot.command = std::move(command);
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (lag < 0)
+            {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            else
+            {
+                position = _tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void SlowOperationLog::flush()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        const std::uint64_t target = _tail.load(std::memory_order_acquire);
+        if (target > _flush_target)
+        {
+            _flush_target = target;
+        }
+        _wake.notify_one();
+        _drained.wait(lock, [&] { return _stopping || _head.load(std::memory_order_acquire) >= target; });
+    }
+
+    void SlowOperationLog::run()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        for (;;)
+        {
+            _wake.wait_for(lock, _options.get_flush_interval(),
+                           [&] { return _stopping || _flush_target > _head.load(std::memory_order_relaxed); });
+            const bool stopping = _stopping;
+            lock.unlock();
+            drain();
+            lock.lock();
+            _drained.notify_all();
+            if (stopping)
+            {
+                return;
+            }
+        }
+    }
+
+    void SlowOperationLog::drain()
+    {
+        std::uint64_t head = _head.load(std::memory_order_relaxed);
+        bool wrote = false;
+        for (;;)
+        {
+            Slot &slot = _slots[head & _mask];
+            if (slot.sequence.load(std::memory_order_acquire) != head + 1)
+            {
+                break;
+            }
+            SlowCommand command = std::move(slot.command);
+            slot.command.command.reset();
+            slot.sequence.store(head + _mask + 1, std::memory_order_release);
+            ++head;
+
+            _file << to_line(command);
+            _logged.fetch_add(1, std::memory_order_relaxed);
+            wrote = true;
+        }
+        if (wrote)
+        {
+            _file.flush();
+        }
+        _head.store(head, std::memory_order_release);
+    }
+} // namespace QDB
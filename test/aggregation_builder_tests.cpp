@@ -52,6 +52,29 @@ bool test_aggregation_pipeline()
     ASSERT_TRUE(results[0].age == 50 && results[0].count == 2, "First group (age 50) should have 2 users.");
     ASSERT_TRUE(results[1].age == 60 && results[1].count == 1, "Second group (age 60) should have 1 user.");
 
+    std::vector<AgeResult> streamed;
+    for (auto &result : collection.aggregate_stream<AgeResult>(agg, QDB::AggregateOptions{}.batch_size(1)))
+    {
+        streamed.push_back(std::move(result));
+    }
+    ASSERT_TRUE(streamed.size() == 2, "aggregate_stream should yield the same groups as aggregate.");
+    ASSERT_TRUE(streamed[0].age == 50 && streamed[1].age == 60, "aggregate_stream should preserve pipeline order.");
+
+    return true;
+}
+
+bool test_document_builder_order()
+{
+    // Multi-key sort specs depend on key order: sort by "age" first, then by "name".
+    auto sort_doc = QDB::DocumentBuilder("age", -1).add_field("name", 1).add_field("email", 1).build();
+
+    std::vector<std::string> keys;
+    for (const auto &element : sort_doc.view())
+    {
+        keys.emplace_back(element.key());
+    }
+    ASSERT_TRUE((keys == std::vector<std::string>{"age", "name", "email"}),
+                "DocumentBuilder: BSON keys should follow insertion order.");
     return true;
 }
 
@@ -59,5 +82,6 @@ bool run_aggregation_builder_tests()
 {
     bool success = true;
     success &= run_test_case(test_aggregation_pipeline, "Aggregation Builder: Pipeline");
+    success &= run_test_case(test_document_builder_order, "Aggregation Builder: DocumentBuilder Key Order");
     return success;
 }
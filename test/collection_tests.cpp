@@ -3,6 +3,7 @@
 #include "test_runner.h"
 #include "user_document.h"
 #include <iostream>
+#include <optional>
 #include <vector>
 
 QDB::Database db("mongodb://localhost:27017");
@@ -45,6 +46,244 @@ bool test_create_many()
     return true;
 }
 
+bool test_find_stream()
+{
+    cleanup();
+    std::vector<User> users;
+    for (int32_t i = 0; i < 25; ++i)
+    {
+        users.emplace_back("Stream User " + std::to_string(i), i, "stream@example.com", std::vector<std::string>{});
+    }
+    collection.create_many(users);
+
+    auto stream = collection.find_stream(QDB::Query{}, QDB::FindOptions{}.sort("age", 1).batch_size(4));
+    int32_t expected_age = 0;
+    for (const User &user : stream)
+    {
+        ASSERT_TRUE(user.age == expected_age, "Streamed documents should arrive in cursor order.");
+        ASSERT_FALSE(user.get_id_str().empty(), "Streamed documents should carry their _id.");
+        ++expected_age;
+    }
+    ASSERT_TRUE(expected_age == 25, "find_stream should yield every matching document across batches.");
+
+    auto empty = collection.find_stream(QDB::Query{}.eq("name", std::string("nobody")));
+    ASSERT_TRUE(empty.begin() == empty.end(), "A stream with no matches should be empty.");
+    return true;
+}
+
+bool test_find_prefetch()
+{
+    cleanup();
+    std::vector<User> users;
+    for (int32_t i = 0; i < 50; ++i)
+    {
+        users.emplace_back("Prefetch User " + std::to_string(i), i, "prefetch@example.com", std::vector<std::string>{});
+    }
+    collection.create_many(users);
+
+    QDB::FindOptions options;
+    options.sort("age", 1).batch_size(8).prefetch(2);
+    int32_t expected_age = 0;
+    for (const User &user : collection.find_stream(QDB::Query{}, options))
+    {
+        ASSERT_TRUE(user.age == expected_age, "Prefetched documents should arrive in cursor order.");
+        ++expected_age;
+    }
+    ASSERT_TRUE(expected_age == 50, "A prefetching stream should yield every document.");
+
+    auto results = collection.find_many(QDB::Query{}, options);
+    ASSERT_TRUE(results.size() == 50, "find_many with prefetch should return every document.");
+    ASSERT_TRUE(results.front().age == 0 && results.back().age == 49, "find_many with prefetch should keep order.");
+
+    // Abandoning a prefetching stream part-way must stop its worker cleanly.
+    {
+        auto stream = collection.find_stream(QDB::Query{}, QDB::FindOptions{}.batch_size(4).prefetch(1));
+        ASSERT_TRUE(stream.begin() != stream.end(), "A prefetching stream should yield a first document.");
+    }
+    return true;
+}
+
+bool test_find_parallel_decode()
+{
+    cleanup();
+    std::vector<User> users;
+    for (int32_t i = 0; i < 200; ++i)
+    {
+        users.emplace_back("Parallel User " + std::to_string(i), i, "parallel@example.com",
+                           std::vector<std::string>{"tag" + std::to_string(i)});
+    }
+    collection.create_many(users);
+
+    QDB::FindOptions options;
+    options.sort("age", 1).batch_size(16).decode_threads(4);
+    auto results = collection.find_many(QDB::Query{}, options);
+    ASSERT_TRUE(results.size() == 200, "Parallel decode should return every document.");
+    for (int32_t i = 0; i < 200; ++i)
+    {
+        ASSERT_TRUE(results[i].age == i, "Parallel decode should preserve cursor order.");
+        ASSERT_TRUE((results[i].tags == std::vector<std::string>{"tag" + std::to_string(i)}),
+                    "Parallel decode should decode every field.");
+    }
+
+    QDB::FindOptions stream_options;
+    stream_options.sort("age", -1).batch_size(10).decode_threads(3).prefetch(1);
+    int32_t expected_age = 199;
+    for (const User &user : collection.find_stream(QDB::Query{}, stream_options))
+    {
+        ASSERT_TRUE(user.age == expected_age, "A parallel-decoding stream should preserve cursor order.");
+        --expected_age;
+    }
+    ASSERT_TRUE(expected_age == -1, "A parallel-decoding stream should yield every document.");
+    return true;
+}
+
+bool test_bulk_writer()
+{
+    cleanup();
+    std::vector<User> users = {
+        User("Bulk A", 1, "a@bulk.com", {}),
+        User("Bulk B", 2, "b@bulk.com", {}),
+        User("Bulk C", 3, "c@bulk.com", {}),
+    };
+
+    auto writer = collection.bulk_writer(QDB::BulkWriteOptions{}.max_batch_ops(2));
+    for (auto &user : users)
+    {
+        writer.insert(user);
+    }
+    writer.update_one(QDB::Query{}.eq("name", std::string("Bulk A")), QDB::Update{}.set("age", 10))
+        .upsert(QDB::Query{}.eq("name", std::string("Bulk D")), QDB::Update{}.set("age", 4))
+        .replace_one(QDB::Query{}.eq("name", std::string("Bulk B")), User("Bulk B2", 20, "b2@bulk.com", {}))
+        .delete_one(QDB::Query{}.eq("name", std::string("Bulk C")));
+    ASSERT_TRUE(writer.size() == 7, "BulkWriter should queue every operation.");
+
+    auto result = writer.execute();
+    ASSERT_TRUE(result.ok(), "All bulk operations should succeed.");
+    ASSERT_TRUE(writer.empty(), "execute() should clear the queue.");
+    ASSERT_TRUE(result.batch_count == 4, "Seven operations with max_batch_ops(2) should need four batches.");
+    ASSERT_TRUE(result.inserted_count == 3 && result.upserted_count == 1 && result.deleted_count == 1,
+                "Bulk counts should cover every batch.");
+    ASSERT_TRUE((result.operations[0].inserted_id && *result.operations[0].inserted_id == users[0].get_id()),
+                "Inserted ids should be assigned client-side and reported.");
+    ASSERT_TRUE(result.operations[4].upserted_id.has_value(), "The upsert should report its new _id.");
+    ASSERT_TRUE(collection.find_one(QDB::Query::by_id(users[0].get_id()))->age == 10, "The update should apply.");
+    ASSERT_TRUE(collection.count_documents() == 3, "Three documents should remain after the bulk write.");
+
+    // Unordered writes continue past a failing operation and report it individually.
+    std::string email_index = collection.create_index("email", true, true);
+    User duplicate("Dup", 5, "a@bulk.com", {});
+    User fresh("Fresh", 6, "fresh@bulk.com", {});
+    auto unordered = collection.bulk_writer(QDB::BulkWriteOptions{}.ordered(false));
+    unordered.insert(duplicate).insert(fresh);
+    auto partial = unordered.execute();
+    collection.drop_index(email_index);
+    ASSERT_FALSE(partial.ok(), "A duplicate key should fail the bulk write.");
+    ASSERT_TRUE(partial.operations[0].status == QDB::BulkOpStatus::kFailed, "The duplicate insert should fail.");
+    ASSERT_TRUE(partial.operations[0].error_code == 11000, "The failure should carry the server's error code.");
+    ASSERT_TRUE(partial.operations[1].ok(), "Unordered mode should still apply later operations.");
+    return true;
+}
+
+bool test_create_with_generated_ids()
+{
+    cleanup();
+    User user("Generated", 41, "generated@example.com", {});
+    auto before = user.get_id();
+    ASSERT_TRUE(collection.create_one(user, QDB::InsertOptions{}.generate_ids()) == 1, "create_one should succeed.");
+    ASSERT_TRUE(user.get_id() == before, "generate_ids should send the document's own ObjectId.");
+    ASSERT_TRUE(collection.find_one(QDB::Query::by_id(user.get_id())).has_value(),
+                "The client-generated id should be the stored _id.");
+
+    // A retry sends the same id, so it fails instead of inserting a second copy.
+    bool duplicate = false;
+    try
+    {
+        collection.create_one(user, QDB::InsertOptions{}.generate_ids());
+    }
+    catch (const QDB::Exception &e)
+    {
+        duplicate = std::string(e.what()).find("11000") != std::string::npos;
+    }
+    ASSERT_TRUE(duplicate, "A retried insert should fail with duplicate key error 11000.");
+    ASSERT_TRUE(collection.count_documents(QDB::Query::by_id(user.get_id())) == 1,
+                "The retry should not insert a second copy.");
+
+    std::vector<User> users = {
+        User("Generated A", 1, "ga@example.com", {}),
+        User("Generated B", 2, "gb@example.com", {}),
+    };
+    ASSERT_TRUE(collection.create_many(users, QDB::InsertOptions{}.generate_ids()) == 2, "create_many should succeed.");
+    ASSERT_TRUE(collection.find_one(QDB::Query::by_id(users[1].get_id()))->name == "Generated B",
+                "Each document should keep its client-generated id.");
+
+    // Unacknowledged inserts do not wait for a reply but still know their ids.
+    User fire_and_forget("Unacknowledged", 7, "w0@example.com", {});
+    ASSERT_TRUE(collection.create_one(fire_and_forget, QDB::InsertOptions{}.generate_ids().unacknowledged()) == 1,
+                "An unacknowledged insert should report the document as sent.");
+    ASSERT_TRUE(collection.count_documents(QDB::Query::by_id(fire_and_forget.get_id())) == 1,
+                "The unacknowledged insert should be stored under its generated id.");
+    return true;
+}
+
+bool test_watch()
+{
+    cleanup();
+    std::optional<QDB::ChangeStream<User>> stream;
+    try
+    {
+        stream.emplace(collection.watch(
+            QDB::ChangeStreamOptions{}.full_document(QDB::FullDocument::kUpdateLookup).max_await_time(std::chrono::milliseconds(100))));
+        stream->next_batch();
+    }
+    catch (const QDB::Exception &e)
+    {
+        // Standalone servers do not support change streams. The error surfaces on the first read.
+        std::cout << "    (skipped: " << e.what() << ")" << std::endl;
+        return true;
+    }
+
+    User user("Watched", 20, "watched@example.com", {});
+    collection.create_one(user);
+    collection.update_one(QDB::Query::by_id(user.get_id()), QDB::Update{}.set("age", 21));
+    collection.delete_one(QDB::Query::by_id(user.get_id()));
+
+    std::vector<QDB::ChangeEvent<User>> events;
+    for (int attempt = 0; attempt < 50 && events.size() < 3; ++attempt)
+    {
+        for (auto &event : stream->next_batch())
+        {
+            events.push_back(std::move(event));
+        }
+    }
+    ASSERT_TRUE(events.size() == 3, "The insert, update and delete should each produce an event.");
+    ASSERT_TRUE(events[0].type == QDB::ChangeType::kInsert && events[0].full_document &&
+                    events[0].full_document->name == "Watched",
+                "Insert events should carry the decoded document.");
+    ASSERT_TRUE(events[1].type == QDB::ChangeType::kUpdate && events[1].update_description.has_value(),
+                "Update events should carry the update description.");
+    ASSERT_TRUE(events[2].type == QDB::ChangeType::kDelete && events[2].id == user.get_id() && !events[2].full_document,
+                "Delete events should carry the document key only.");
+    ASSERT_TRUE(stream->resume_token().has_value(), "The stream should track a resume token.");
+
+    // Resuming after the first event replays the rest, one event per batch when limited.
+    auto resumed = collection.watch(QDB::ChangeStreamOptions{}
+                                        .resume_after(events[0].resume_token->view())
+                                        .full_document(QDB::FullDocument::kUpdateLookup)
+                                        .max_await_time(std::chrono::milliseconds(100)));
+    std::vector<QDB::ChangeEvent<User>> replayed;
+    for (int attempt = 0; attempt < 50 && replayed.size() < 2; ++attempt)
+    {
+        for (auto &event : resumed.next_batch(1))
+        {
+            replayed.push_back(std::move(event));
+        }
+    }
+    ASSERT_TRUE(replayed.size() == 2 && replayed[0].type == QDB::ChangeType::kUpdate &&
+                    replayed[1].type == QDB::ChangeType::kDelete,
+                "A resumed stream should continue after the token's event.");
+    return true;
+}
+
 // Stubs for other tests in this category
 bool test_read_operations()
 {
@@ -77,6 +316,12 @@ bool run_collection_tests()
     bool success = true;
     success &= run_test_case(test_create_one, "Collection: create_one");
     success &= run_test_case(test_create_many, "Collection: create_many");
+    success &= run_test_case(test_create_with_generated_ids, "Collection: client-generated ids");
+    success &= run_test_case(test_find_stream, "Collection: find_stream");
+    success &= run_test_case(test_find_prefetch, "Collection: prefetching find");
+    success &= run_test_case(test_find_parallel_decode, "Collection: parallel decode");
+    success &= run_test_case(test_bulk_writer, "Collection: bulk_writer");
+    success &= run_test_case(test_watch, "Collection: change streams");
     success &= run_test_case(test_read_operations, "Collection: Read Operations (STUB)");
     success &= run_test_case(test_update_operations, "Collection: Update Operations (STUB)");
     success &= run_test_case(test_delete_operations, "Collection: Delete Operations (STUB)");
@@ -0,0 +1,98 @@
+#include "coroutine_tests.h"
+#include "quickdb/quickdb.h"
+#include "test_runner.h"
+#include "user_document.h"
+#include <exception>
+#include <functional>
+#include <optional>
+#include <future>
+#include <thread>
+#include <vector>
+
+// Built only by the optional C++20 test target (QUICKDB_BUILD_CXX20).
+
+namespace
+{
+    // What the coroutine observed, checked by the test once it completes.
+    struct CrudObservations
+    {
+        bool resumed_on_loop = true;
+        int64_t created = 0;
+        std::optional<User> found;
+        int64_t updated = 0;
+        int64_t count = 0;
+        bool error_rethrown = false;
+    };
+
+    // A minimal eager coroutine type that reports its result through a std::promise.
+    struct CrudTask
+    {
+        struct promise_type
+        {
+            std::promise<CrudObservations> outcome;
+
+            CrudTask get_return_object() { return CrudTask{outcome.get_future()}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_value(CrudObservations observations) { outcome.set_value(std::move(observations)); }
+            void unhandled_exception() { outcome.set_exception(std::current_exception()); }
+        };
+
+        std::future<CrudObservations> result;
+    };
+
+    CrudTask crud_coroutine(QDB::AwaitableCollection<User> users, std::thread::id loop_thread)
+    {
+        CrudObservations seen;
+        auto check_thread = [&] { seen.resumed_on_loop &= std::this_thread::get_id() == loop_thread; };
+
+        co_await users.delete_many(QDB::Query{});
+        check_thread();
+
+        User alice("Alice", 30, "alice@coroutine.com", {"coroutine"});
+        seen.created = co_await users.create_one(alice);
+        seen.found = co_await users.find_one(QDB::Query::by_id(alice.get_id()));
+        seen.updated = co_await users.update_one(QDB::Query::by_id(alice.get_id()), QDB::Update{}.set("age", 31));
+        seen.count = co_await users.count_documents();
+        check_thread();
+
+        try
+        {
+            co_await users.run([](QDB::Collection<User> &) -> int { throw QDB::Exception("coroutine failure"); });
+        }
+        catch (const QDB::Exception &)
+        {
+            seen.error_rethrown = true;
+        }
+        check_thread();
+        co_return seen;
+    }
+} // namespace
+
+bool test_coroutine_crud()
+{
+    QDB::Database db("mongodb://localhost:27017/?maxPoolSize=4");
+    QDB::Executor loop(1);
+    std::thread::id loop_thread = loop.submit([] { return std::this_thread::get_id(); }).get();
+
+    QDB::AwaitableCollection<User> users(db.get_shared_collection<User>("qdb_test_db", "users"),
+                                         [&loop](std::function<void()> resume) { loop.post(std::move(resume)); });
+    // Start the coroutine on the loop thread, as a reactor would.
+    std::future<CrudObservations> outcome = loop.submit([&] { return crud_coroutine(users, loop_thread).result; }).get();
+    CrudObservations seen = outcome.get();
+
+    ASSERT_TRUE(seen.resumed_on_loop, "The coroutine should always resume on the caller's executor.");
+    ASSERT_TRUE(seen.created == 1, "create_one should insert one document.");
+    ASSERT_TRUE(seen.found.has_value() && seen.found->name == "Alice", "find_one should return the created document.");
+    ASSERT_TRUE(seen.updated == 1, "update_one should modify the document.");
+    ASSERT_TRUE(seen.count == 1, "count_documents should see the document.");
+    ASSERT_TRUE(seen.error_rethrown, "Exceptions from the worker should be rethrown from co_await.");
+    return true;
+}
+
+bool run_coroutine_tests()
+{
+    bool success = true;
+    success &= run_test_case(test_coroutine_crud, "Awaitable CRUD Operations");
+    return success;
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+bool run_coroutine_tests();
@@ -2,7 +2,14 @@
 #include "quickdb/quickdb.h"
 #include "test_runner.h"
 #include "user_document.h"
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <future>
 #include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 bool test_successful_connection()
 {
@@ -75,6 +82,473 @@ bool test_transaction_abort()
     return true;
 }
 
+bool test_shared_collection()
+{
+    // A pool of 4 connections shared by 32 threads through one handle.
+    QDB::Database db("mongodb://localhost:27017/?maxPoolSize=4");
+    auto users = db.get_shared_collection<User>("qdb_test_db", "users");
+    users.delete_many(QDB::Query{});
+
+    constexpr int kThreads = 32;
+    constexpr int kPerThread = 10;
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t)
+    {
+        threads.emplace_back(
+            [users, t, &failures]
+            {
+                try
+                {
+                    for (int i = 0; i < kPerThread; ++i)
+                    {
+                        User user("Shared " + std::to_string(t), t * kPerThread + i, "shared@test.com", {});
+                        users.create_one(user);
+                        if (!users.find_one(QDB::Query::by_id(user.get_id())))
+                        {
+                            ++failures;
+                        }
+                    }
+                }
+                catch (const QDB::Exception &)
+                {
+                    ++failures;
+                }
+            });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    ASSERT_TRUE(failures == 0, "Every thread should be able to use the shared handle.");
+    ASSERT_TRUE(users.count_documents() == kThreads * kPerThread, "All concurrent inserts should be stored.");
+
+    // A leased Collection keeps its client for multi-call work such as streaming.
+    auto leased = users.lease();
+    int streamed = 0;
+    for (const User &user : leased.find_stream(QDB::Query{}))
+    {
+        (void)user;
+        ++streamed;
+    }
+    ASSERT_TRUE(streamed == kThreads * kPerThread, "A leased collection should stream every document.");
+    return true;
+}
+
+bool test_create_many_pipelined()
+{
+    QDB::Database db("mongodb://localhost:27017/?maxPoolSize=4");
+    auto users = db.get_shared_collection<User>("qdb_test_db", "users");
+    users.delete_many(QDB::Query{});
+
+    std::vector<User> docs;
+    for (int i = 0; i < 2500; ++i)
+    {
+        docs.emplace_back("Pipelined " + std::to_string(i), i, "pipelined@test.com", std::vector<std::string>{});
+    }
+
+    int64_t inserted =
+        users.create_many_pipelined(docs, QDB::PipelinedInsertOptions{}.chunk_size(300).max_in_flight(3));
+    ASSERT_TRUE(inserted == 2500, "Every document should be inserted.");
+    ASSERT_TRUE(users.count_documents() == 2500, "The collection should hold every pipelined document.");
+
+    auto found = users.find_one(QDB::Query::by_id(docs[1234].get_id()));
+    ASSERT_TRUE(found.has_value() && found->age == 1234, "Inserted ids should be written back to each document.");
+    return true;
+}
+
+bool test_async_operations()
+{
+    QDB::Database db("mongodb://localhost:27017/?maxPoolSize=4");
+    auto users = db.get_shared_collection<User>("qdb_test_db", "users");
+    users.delete_many(QDB::Query{});
+
+    std::vector<User> docs;
+    for (int i = 0; i < 16; ++i)
+    {
+        docs.emplace_back("Async " + std::to_string(i), i, "async@test.com", std::vector<std::string>{});
+    }
+    std::vector<std::future<int64_t>> inserts;
+    for (auto &doc : docs)
+    {
+        inserts.push_back(users.create_one_async(doc));
+    }
+    for (auto &insert : inserts)
+    {
+        ASSERT_TRUE(insert.get() == 1, "Each async insert should report one document.");
+    }
+
+    auto count = users.count_documents_async();
+    auto adults = users.find_many_async(QDB::Query{}.gte("age", 8));
+    auto found = users.find_one_async(QDB::Query::by_id(docs[3].get_id()));
+    auto updated = users.update_many_async(QDB::Query{}.lt("age", 4), QDB::Update{}.set("email", "young@test.com"));
+    ASSERT_TRUE(count.get() == 16, "The async count should see every inserted document.");
+    ASSERT_TRUE(adults.get().size() == 8, "The async find should return the matching documents.");
+    auto found_user = found.get();
+    ASSERT_TRUE(found_user.has_value() && found_user->age == 3, "The async find_one should return the document.");
+    ASSERT_TRUE(updated.get() == 4, "The async update should modify the matching documents.");
+
+    auto removed = users.delete_many_async(QDB::Query{}.eq("email", "young@test.com"));
+    ASSERT_TRUE(removed.get() == 4, "The async delete should remove the updated documents.");
+
+    auto failing = users.async([](QDB::Collection<User> &) -> int { throw QDB::Exception("async failure"); });
+    bool threw = false;
+    try
+    {
+        failing.get();
+    }
+    catch (const QDB::Exception &)
+    {
+        threw = true;
+    }
+    ASSERT_TRUE(threw, "Exceptions from async tasks should be rethrown by the future.");
+    return true;
+}
+
+bool test_document_cache()
+{
+    QDB::Database db("mongodb://localhost:27017/?maxPoolSize=4");
+    auto users = db.get_shared_collection<User>("qdb_test_db", "users");
+    users.delete_many(QDB::Query{});
+
+    User alice("Cached Alice", 30, "alice@test.com", {});
+    User bob("Cached Bob", 40, "bob@test.com", {});
+    users.create_one(alice);
+    users.create_one(bob);
+
+    // Without a change stream the cache only relies on its own invalidation, which works on a standalone server.
+    auto cached = users.with_cache(QDB::CacheOptions{}.watch_changes(false).max_entries(1).shards(1));
+    ASSERT_TRUE(cached.find_one(QDB::Query::by_id(alice.get_id())).has_value(), "The first lookup should find the document.");
+    auto hit = cached.find_one(QDB::Query::by_id(alice.get_id()));
+    ASSERT_TRUE(hit.has_value() && hit->name == "Cached Alice", "The second lookup should return the cached document.");
+    QDB::CacheStats stats = cached.cache()->stats();
+    ASSERT_TRUE(stats.hits == 1 && stats.misses == 1 && stats.size == 1, "One hit and one miss should be counted.");
+
+    // Queries that are not plain lookups by id bypass the cache.
+    cached.find_one(QDB::Query{}.eq("name", "Cached Alice"));
+    ASSERT_TRUE(cached.cache()->stats().misses == 1, "Other queries should not touch the cache.");
+
+    // Writes through the handle, and through Collections it leases, evict immediately.
+    cached.update_one(QDB::Query::by_id(alice.get_id()), QDB::Update{}.set("age", 31));
+    auto updated = cached.find_one(QDB::Query::by_id(alice.get_id()));
+    ASSERT_TRUE(updated.has_value() && updated->age == 31, "An update should evict the cached document.");
+    cached.lease().delete_one(QDB::Query::by_id(alice.get_id()));
+    ASSERT_FALSE(cached.find_one(QDB::Query::by_id(alice.get_id())).has_value(), "A delete should evict the cached document.");
+
+    // The capacity is enforced by evicting the least recently used document.
+    User carol("Cached Carol", 50, "carol@test.com", {});
+    users.create_one(carol);
+    cached.find_one(QDB::Query::by_id(bob.get_id()));
+    cached.find_one(QDB::Query::by_id(carol.get_id()));
+    stats = cached.cache()->stats();
+    ASSERT_TRUE(stats.size == 1 && stats.evictions == 1, "A full cache should evict its least recently used entry.");
+    ASSERT_TRUE(stats.invalidations == 2, "Each write should count one invalidation.");
+
+    // Entries expire after the TTL.
+    auto short_lived = users.with_cache(QDB::CacheOptions{}.watch_changes(false).ttl(std::chrono::milliseconds(20)));
+    short_lived.find_one(QDB::Query::by_id(bob.get_id()));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    short_lived.find_one(QDB::Query::by_id(bob.get_id()));
+    stats = short_lived.cache()->stats();
+    ASSERT_TRUE(stats.hits == 0 && stats.evictions == 1, "An expired entry should be evicted, not served.");
+
+    // Bulk writes through a leased Collection evict as well.
+    auto bulk_cached = users.with_cache(QDB::CacheOptions{}.watch_changes(false));
+    ASSERT_TRUE(bulk_cached.find_one(QDB::Query::by_id(bob.get_id()))->age == 40, "Bob should be cached.");
+    {
+        auto collection = bulk_cached.lease();
+        collection.bulk_writer().update_one(QDB::Query::by_id(bob.get_id()), QDB::Update{}.set("age", 41)).execute();
+    }
+    auto bulk_updated = bulk_cached.find_one(QDB::Query::by_id(bob.get_id()));
+    ASSERT_TRUE(bulk_updated.has_value() && bulk_updated->age == 41, "A bulk update should evict the cached document.");
+    return true;
+}
+
+bool test_result_cache()
+{
+    QDB::Database db("mongodb://localhost:27017/?maxPoolSize=4");
+    auto users = db.get_shared_collection<User>("qdb_test_db", "users");
+    users.delete_many(QDB::Query{});
+
+    User alice("Result Alice", 30, "alice@test.com", {});
+    users.create_one(alice);
+
+    auto results = std::make_shared<QDB::ResultCache>(QDB::ResultCacheOptions{}.ttl(std::chrono::milliseconds(200)));
+    auto cached = users.with_result_cache(results);
+    ASSERT_TRUE(cached.count_documents() == 1, "The first count should reach the server.");
+    ASSERT_TRUE(cached.find_many(QDB::Query{}.gte("age", 18)).size() == 1, "The first find should reach the server.");
+
+    // A write through another handle is not seen until the TTL expires.
+    User bob("Result Bob", 40, "bob@test.com", {});
+    users.create_one(bob);
+    ASSERT_TRUE(cached.count_documents() == 1, "A repeated count should be served from the cache.");
+    ASSERT_TRUE(cached.find_many(QDB::Query{}.gte("age", 18)).size() == 1, "A repeated find should be served from the cache.");
+    QDB::ResultCacheStats stats = results->stats();
+    ASSERT_TRUE(stats.hits == 2 && stats.misses == 2 && stats.size == 2, "Two hits and two misses should be counted.");
+
+    // Different options are a different result.
+    QDB::FindOptions limited;
+    limited.limit(1);
+    cached.find_many(QDB::Query{}.gte("age", 18), limited);
+    ASSERT_TRUE(results->stats().misses == 3, "Different options should not share a result.");
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    ASSERT_TRUE(cached.count_documents() == 2, "An expired result should be recomputed.");
+
+    // A write through the cached handle drops the collection's results at once.
+    cached.delete_one(QDB::Query::by_id(bob.get_id()));
+    ASSERT_TRUE(cached.count_documents() == 1, "A write through the handle should invalidate its results.");
+    ASSERT_TRUE(results->stats().size == 1, "Only the recomputed count should remain cached.");
+
+    // So does a bulk write through a Collection the handle leases.
+    {
+        auto collection = cached.lease();
+        collection.bulk_writer().delete_many(QDB::Query{}).execute();
+    }
+    ASSERT_TRUE(cached.count_documents() == 0, "A bulk write should invalidate the collection's results.");
+    return true;
+}
+
+bool test_metrics()
+{
+    QDB::Database db("mongodb://localhost:27017/?maxPoolSize=4");
+    auto users = db.get_shared_collection<User>("qdb_test_db", "users");
+    users.delete_many(QDB::Query{});
+
+    User alice("Metrics Alice", 30, "alice@test.com", {});
+    User bob("Metrics Bob", 40, "bob@test.com", {});
+    users.create_one(alice, QDB::InsertOptions{}.generate_ids());
+    users.create_one(bob, QDB::InsertOptions{}.generate_ids());
+    ASSERT_TRUE(users.find_many(QDB::Query{}.gte("age", 18)).size() == 2, "Both users should be found.");
+
+    // Sending the same _id again fails with a duplicate key error.
+    bool threw = false;
+    try
+    {
+        users.create_one(alice, QDB::InsertOptions{}.generate_ids());
+    }
+    catch (const QDB::Exception &)
+    {
+        threw = true;
+    }
+    ASSERT_TRUE(threw, "A duplicate insert should throw.");
+
+    QDB::MetricsSnapshot snapshot = db.metrics().snapshot();
+    const QDB::OperationStats *creates = snapshot.find("qdb_test_db", "users", QDB::OperationKind::kCreateOne);
+    ASSERT_TRUE(creates && creates->calls == 3 && creates->errors == 1, "Three inserts, one failed, should be counted.");
+    ASSERT_TRUE(creates->bytes_encoded > 0, "Inserted documents should count encoded bytes.");
+
+    const QDB::OperationStats *finds = snapshot.find("qdb_test_db", "users", QDB::OperationKind::kFindMany);
+    ASSERT_TRUE(finds && finds->calls == 1 && finds->documents == 2, "The find should count two documents.");
+    ASSERT_TRUE(finds->bytes_decoded > 0 && finds->max >= finds->p50, "The find should count bytes and latency.");
+
+    const QDB::OperationStats *acquires = snapshot.find("qdb_test_db", "users", QDB::OperationKind::kPoolAcquire);
+    ASSERT_TRUE(acquires && acquires->calls >= 5, "Every call should lease a pooled client.");
+
+    ASSERT_TRUE(snapshot.to_text().find("qdb_test_db.users find_many") != std::string::npos,
+                "The text export should name each operation.");
+    ASSERT_TRUE(snapshot.to_json().find("\"operation\":\"create_one\"") != std::string::npos,
+                "The JSON export should name each operation.");
+    return true;
+}
+
+bool test_slow_log()
+{
+    const std::string path = "qdb_slow_log_test.jsonl";
+    std::remove(path.c_str());
+    {
+        // A zero threshold logs every command.
+        QDB::Database db("mongodb://localhost:27017/?maxPoolSize=4",
+                         QDB::SlowLogOptions{}.path(path).threshold(std::chrono::microseconds(0)));
+        auto users = db.get_shared_collection<User>("qdb_test_db", "users");
+        users.find_many(QDB::Query{}.eq("name", "Slow Secret"));
+        db.slow_log()->flush();
+        ASSERT_TRUE(db.slow_log()->logged() >= 1, "The find should be logged.");
+        ASSERT_TRUE(db.slow_log()->dropped() == 0, "Nothing should be dropped.");
+    }
+
+    std::ifstream file(path);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    const std::string log = contents.str();
+    std::remove(path.c_str());
+    ASSERT_TRUE(log.find("\"command\":\"find\",\"database\":\"qdb_test_db\",\"collection\":\"users\"") !=
+                    std::string::npos,
+                "The log should name the command and collection.");
+    ASSERT_TRUE(log.find("\"duration_us\":") != std::string::npos, "The log should record durations.");
+    ASSERT_FALSE(log.find("Slow Secret") != std::string::npos, "Literal values should be redacted.");
+    return true;
+}
+
+bool test_batch_loader()
+{
+    QDB::Database db("mongodb://localhost:27017/?maxPoolSize=4");
+    auto users = db.get_shared_collection<User>("qdb_test_db", "users");
+    users.delete_many(QDB::Query{});
+
+    std::vector<User> docs;
+    for (int i = 0; i < 20; ++i)
+    {
+        docs.emplace_back("Loaded " + std::to_string(i), i, "loader@test.com", std::vector<std::string>{});
+    }
+    users.create_many(docs);
+
+    QDB::BatchLoader<User> loader(users, QDB::BatchLoaderOptions{}.window(std::chrono::milliseconds(20)));
+    const bsoncxx::oid missing;
+
+    // Eight threads each look up every id, plus one that does not exist.
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+    {
+        threads.emplace_back(
+            [&]
+            {
+                std::vector<bsoncxx::oid> ids;
+                for (const auto &doc : docs)
+                {
+                    ids.push_back(doc.get_id());
+                }
+                ids.push_back(missing);
+                std::vector<std::optional<User>> found = loader.load_many(ids);
+                for (std::size_t i = 0; i < docs.size(); ++i)
+                {
+                    if (!found[i].has_value() || found[i]->name != docs[i].name)
+                    {
+                        ++mismatches;
+                    }
+                }
+                if (found.back().has_value())
+                {
+                    ++mismatches;
+                }
+            });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    ASSERT_TRUE(mismatches == 0, "Every waiter should receive the document for its own id.");
+    ASSERT_TRUE(loader.query_count() < 8, "Concurrent lookups should share queries.");
+
+    // A batch is sent early once it holds max_batch_size ids.
+    QDB::BatchLoader<User> small_batches(users, QDB::BatchLoaderOptions{}.max_batch_size(5).window(std::chrono::seconds(10)));
+    std::vector<bsoncxx::oid> ids;
+    for (int i = 0; i < 10; ++i)
+    {
+        ids.push_back(docs[i].get_id());
+    }
+    ASSERT_TRUE(small_batches.load_many(ids).size() == 10, "load_many should return one entry per id.");
+    ASSERT_TRUE(small_batches.query_count() == 2, "Full batches should be sent without waiting for the window.");
+    return true;
+}
+
+bool test_write_buffer()
+{
+    QDB::Database db("mongodb://localhost:27017/?maxPoolSize=4");
+    auto users = db.get_shared_collection<User>("qdb_test_db", "users");
+    users.delete_many(QDB::Query{});
+
+    std::atomic<int> reported_errors{0};
+    std::vector<User> docs;
+    for (int i = 0; i < 250; ++i)
+    {
+        docs.emplace_back("Buffered " + std::to_string(i), i, "buffered@test.com", std::vector<std::string>{});
+    }
+    {
+        QDB::WriteBuffer<User> buffer(users, QDB::WriteBufferOptions{}.max_documents(100).max_pending_bytes(16 * 1024),
+                                      [&](const QDB::WriteBufferError &) { ++reported_errors; });
+        for (auto &doc : docs)
+        {
+            buffer.insert(doc);
+        }
+        buffer.update_many(QDB::Query{}.lt("age", 10), QDB::Update{}.set("email", "early@test.com"));
+        buffer.flush();
+        ASSERT_TRUE(buffer.pending() == 0, "flush() should wait for every buffered operation.");
+        ASSERT_TRUE(users.count_documents() == 250, "Every buffered insert should be written after flush().");
+        ASSERT_TRUE(users.count_documents(QDB::Query{}.eq("email", "early@test.com")) == 10,
+                    "Buffered updates should be applied after the inserts they follow.");
+
+        // Flushes are ordered by default, so an update in the same batch sees the insert it follows.
+        User ordered("Buffered ordered", 500, "ordered@test.com", {});
+        buffer.insert(ordered).update_one(QDB::Query::by_id(ordered.get_id()), QDB::Update{}.set("age", 501));
+        buffer.flush();
+        auto ordered_found = users.find_one(QDB::Query::by_id(ordered.get_id()));
+        ASSERT_TRUE(ordered_found.has_value() && ordered_found->age == 501,
+                    "An update should be applied after the insert it follows in the same flush.");
+
+        // Write errors are reported to the handler, not thrown. An ordered flush stops at the first error, so
+        // the duplicate is flushed on its own.
+        std::string name_index = users.create_index("name", true, true);
+        User duplicate("Buffered 0", 0, "duplicate@test.com", {});
+        User fresh("Buffered fresh", 1000, "fresh@test.com", {});
+        buffer.insert(duplicate);
+        buffer.flush();
+        buffer.insert(fresh);
+        buffer.flush();
+        users.drop_index(name_index);
+        ASSERT_TRUE(reported_errors == 1, "The failed flush should be reported once.");
+        ASSERT_TRUE(buffer.failed_count() == 1, "Only the duplicate should count as failed.");
+
+        buffer.update_one(QDB::Query::by_id(fresh.get_id()), QDB::Update{}.set("age", 2000));
+    }
+    // The destructor flushes what is left.
+    auto fresh_found = users.find_one(QDB::Query{}.eq("name", "Buffered fresh"));
+    ASSERT_TRUE(fresh_found.has_value() && fresh_found->age == 2000, "The destructor should flush remaining operations.");
+    return true;
+}
+
+bool test_write_buffer_journal()
+{
+    const std::string journal_path = "qdb_test_write_buffer.journal";
+    std::remove(journal_path.c_str());
+
+    QDB::Database db("mongodb://localhost:27017/?maxPoolSize=4");
+    auto users = db.get_shared_collection<User>("qdb_test_db", "users");
+    users.delete_many(QDB::Query{});
+
+    // Buffer writes against an unreachable server: the flush fails and the operations stay journaled.
+    std::atomic<int> reported_errors{0};
+    {
+        QDB::Database unreachable("mongodb://localhost:9999/?serverSelectionTimeoutMS=200");
+        auto offline_users = unreachable.get_shared_collection<User>("qdb_test_db", "users");
+        QDB::WriteBuffer<User> buffer(offline_users,
+                                      QDB::WriteBufferOptions{}.journal(journal_path).max_delay(std::chrono::milliseconds(10)),
+                                      [&](const QDB::WriteBufferError &) { ++reported_errors; });
+        for (int i = 0; i < 20; ++i)
+        {
+            User doc("Journaled " + std::to_string(i), i, "journal@test.com", {});
+            buffer.insert(doc);
+        }
+        buffer.update_many(QDB::Query{}.lt("age", 5), QDB::Update{}.set("email", "early@journal.com"));
+    }
+    ASSERT_TRUE(reported_errors > 0, "The unreachable server should have been reported.");
+
+    // A buffer must not start over a journal that still holds operations.
+    ASSERT_THROWS(QDB::WriteBuffer<User>(users, QDB::WriteBufferOptions{}.journal(journal_path)), QDB::Exception,
+                  "Opening a non-empty journal should throw.");
+
+    QDB::JournalReplayResult replayed = db.replay_journal(journal_path);
+    ASSERT_TRUE(replayed.ok(), "Replay should apply every journaled operation.");
+    ASSERT_TRUE(replayed.applied == 21, "Every journaled insert and the update should be applied.");
+    ASSERT_TRUE(users.count_documents() == 20, "The journaled inserts should reach the collection.");
+    ASSERT_TRUE(users.count_documents(QDB::Query{}.eq("email", "early@journal.com")) == 5,
+                "The journaled update should be applied after the inserts.");
+
+    // Replaying again is a no-op, and a buffer writing to a reachable server leaves the journal empty.
+    ASSERT_TRUE(db.replay_journal(journal_path).applied == 0, "A replayed journal should be empty.");
+    {
+        QDB::WriteBuffer<User> buffer(users, QDB::WriteBufferOptions{}.journal(journal_path));
+        User doc("Journaled online", 99, "journal@test.com", {});
+        buffer.insert(doc);
+        buffer.flush();
+        ASSERT_TRUE(QDB::Journal(journal_path).empty(), "Flushed operations should be released from the journal.");
+    }
+    std::remove(journal_path.c_str());
+    return true;
+}
+
 bool run_database_tests()
 {
     bool success = true;
@@ -82,5 +556,15 @@ bool run_database_tests()
     success &= run_test_case(test_connection_failure, "Connection Failure");
     success &= run_test_case(test_transaction_commit, "Transaction Successful Commit (STUB)");
     success &= run_test_case(test_transaction_abort, "Transaction Abort on Exception");
+    success &= run_test_case(test_shared_collection, "Shared Collection Across Threads");
+    success &= run_test_case(test_create_many_pipelined, "Pipelined create_many");
+    success &= run_test_case(test_async_operations, "Async Operations");
+    success &= run_test_case(test_document_cache, "Read-Through Document Cache");
+    success &= run_test_case(test_result_cache, "TTL Result Cache");
+    success &= run_test_case(test_metrics, "Per-Operation Metrics");
+    success &= run_test_case(test_slow_log, "Slow Operation Log");
+    success &= run_test_case(test_batch_loader, "Batched Find-By-Id Loader");
+    success &= run_test_case(test_write_buffer, "Write-Behind Buffer");
+    success &= run_test_case(test_write_buffer_journal, "Write-Behind Journal Replay");
     return success;
 }
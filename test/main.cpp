@@ -1,5 +1,8 @@
 #include "aggregation_builder_tests.h"
 #include "collection_tests.h"
+#ifdef QDB_TEST_COROUTINES
+#include "coroutine_tests.h"
+#endif
 #include "database_tests.h"
 #include "gridfs_tests.h"
 #include "query_builder_tests.h"
@@ -46,6 +49,12 @@ int main()
     print_result("Serialization", serialization_tests_passed);
     all_passed &= serialization_tests_passed;
 
+#ifdef QDB_TEST_COROUTINES
+    bool coroutine_tests_passed = run_coroutine_tests();
+    print_result("Coroutines", coroutine_tests_passed);
+    all_passed &= coroutine_tests_passed;
+
+#endif
     if (all_passed)
     {
         std::cout << "All test suites passed!" << std::endl;
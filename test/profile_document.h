@@ -0,0 +1,108 @@
+#pragma once
+#include "quickdb/components/reflection.h"
+#include <map>
+#include <memory_resource>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A nested model used by Profile.
+class Address : public QDB::Model<Address>
+{
+public:
+    std::string city;
+    int32_t zip = 0;
+
+    template <typename Self, typename Visitor> static void schema(Self &self, Visitor &visitor)
+    {
+        visitor("city", self.city);
+        visitor("zip", self.zip);
+    }
+
+    bool operator==(const Address &other) const { return city == other.city && zip == other.zip; }
+};
+
+// A mock schema-based document covering scalars, containers and nested models.
+class Profile : public QDB::Model<Profile>
+{
+public:
+    std::string handle;
+    int64_t followers = 0;
+    double score = 0.0;
+    bool verified = false;
+    std::vector<std::string> tags;
+    std::map<std::string, int32_t> counters;
+    std::pair<std::string, int32_t> rank;
+    Address address;
+    std::vector<Address> previous_addresses;
+
+    template <typename Self, typename Visitor> static void schema(Self &self, Visitor &visitor)
+    {
+        visitor("handle", self.handle);
+        visitor("followers", self.followers);
+        visitor("score", self.score);
+        visitor("verified", self.verified);
+        visitor("tags", self.tags);
+        visitor("counters", self.counters);
+        visitor("rank", self.rank);
+        visitor("address", self.address);
+        visitor("previous_addresses", self.previous_addresses);
+    }
+
+    bool operator==(const Profile &other) const
+    {
+        return handle == other.handle && followers == other.followers && score == other.score &&
+               verified == other.verified && tags == other.tags && counters == other.counters && rank == other.rank &&
+               address == other.address && previous_addresses == other.previous_addresses;
+    }
+};
+
+// An allocator-aware model whose members decode into a caller-supplied memory resource.
+class ArenaNote : public QDB::Model<ArenaNote>
+{
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    std::pmr::string title;
+    std::pmr::vector<std::pmr::string> tags;
+    int32_t priority = 0;
+
+    ArenaNote() = default;
+    explicit ArenaNote(const allocator_type &alloc) : title(alloc), tags(alloc) {}
+    ArenaNote(const ArenaNote &other, const allocator_type &alloc)
+        : QDB::Model<ArenaNote>(other), title(other.title, alloc), tags(other.tags, alloc), priority(other.priority)
+    {
+    }
+    ArenaNote(ArenaNote &&other, const allocator_type &alloc)
+        : QDB::Model<ArenaNote>(std::move(other)), title(std::move(other.title), alloc),
+          tags(std::move(other.tags), alloc), priority(other.priority)
+    {
+    }
+
+    template <typename Self, typename Visitor> static void schema(Self &self, Visitor &visitor)
+    {
+        visitor("title", self.title);
+        visitor("tags", self.tags);
+        visitor("priority", self.priority);
+    }
+};
+
+// Helper to build a fully-populated Profile for tests.
+inline Profile make_test_profile()
+{
+    Profile profile;
+    profile.handle = "@schema";
+    profile.followers = 1234567890123;
+    profile.score = 4.5;
+    profile.verified = true;
+    profile.tags = {"cpp", "mongodb"};
+    profile.counters = {{"posts", 12}, {"likes", 99}};
+    profile.rank = {"gold", 3};
+    profile.address.city = "Springfield";
+    profile.address.zip = 12345;
+    Address old_address;
+    old_address.city = "Shelbyville";
+    old_address.zip = 54321;
+    profile.previous_addresses = {old_address};
+    return profile;
+}
@@ -36,10 +36,82 @@ bool test_query_operators()
     return true;
 }
 
+bool test_query_field_order()
+{
+    // Conditions keep the order they were added in, and operators on the same field are merged.
+    QDB::Query query = QDB::Query{}.eq("status", "active").gt("age", 18).lt("age", 65).exists("email");
+    const QDB::FieldMap &fields = query.get_fields();
+
+    std::vector<std::string> keys;
+    for (const auto &[key, value] : fields)
+    {
+        keys.push_back(key);
+    }
+    ASSERT_TRUE((keys == std::vector<std::string>{"status", "age", "email"}), "Query: keys should keep insertion order");
+
+    const auto &age = fields.find("age")->second;
+    ASSERT_TRUE(age.object().size() == 2 && age.object()[0].first == "$gt" && age.object()[1].first == "$lt",
+                "Query: operators on one field should merge in order");
+
+    QDB::Query same = QDB::Query{}.eq("status", "active").gt("age", 18).lt("age", 65).exists("email");
+    ASSERT_TRUE(same.get_fields() == fields, "Query: identical builders should produce identical documents");
+    return true;
+}
+
+bool test_query_id_value()
+{
+    bsoncxx::oid id;
+    ASSERT_TRUE(QDB::Query::by_id(id).id_value() == id, "Query: by_id should expose its id");
+    ASSERT_TRUE(QDB::Query::by_id(id.to_string()).id_value() == id, "Query: by_id from a string should expose its id");
+    ASSERT_FALSE(QDB::Query::by_id(id).eq("age", 30).id_value().has_value(),
+                 "Query: an id with other conditions is not a plain lookup by id");
+    ASSERT_FALSE(QDB::Query{}.eq("_id", "text").id_value().has_value(), "Query: a non-ObjectId _id has no id value");
+    ASSERT_FALSE(QDB::Query{}.id_value().has_value(), "Query: an empty query has no id value");
+    return true;
+}
+
+bool test_query_shape()
+{
+    using QDB::ShapeMode;
+    QDB::Query ab = QDB::Query{}.eq("a", 1).gt("b", 2).lt("b", 9);
+    QDB::Query ba = QDB::Query{}.lt("b", 9).gt("b", 2).eq("a", 1);
+    ASSERT_TRUE(ab.canonical() == ba.canonical() && ab.hash() == ba.hash(),
+                "Shape: key order of filters and operators should not matter");
+    ASSERT_TRUE(ab.canonical() != QDB::Query{}.eq("a", 1).gt("b", 3).lt("b", 9).canonical(),
+                "Shape: values should matter with values kept");
+    ASSERT_TRUE(QDB::Query{}.eq("a", 1).canonical() != QDB::Query{}.eq("a", int64_t{1}).canonical(),
+                "Shape: values should keep their BSON type");
+
+    QDB::Query in_small = QDB::Query{}.eq("name", "Alice").in("age", std::vector<int>{1, 2});
+    QDB::Query in_large = QDB::Query{}.in("age", std::vector<int>{3, 4, 5}).eq("name", "Bob");
+    ASSERT_TRUE(in_small.hash(ShapeMode::kRedacted) == in_large.hash(ShapeMode::kRedacted),
+                "Shape: redacted shapes should ignore values and $in lengths");
+    ASSERT_TRUE(in_small.canonical(ShapeMode::kRedacted).find("Alice") == std::string::npos,
+                "Shape: redacted shapes should not contain values");
+
+    QDB::FindOptions by_name_age, by_age_name, larger_limit;
+    by_name_age.sort("name", 1).sort("age", -1).limit(5);
+    by_age_name.sort("age", -1).sort("name", 1).limit(5);
+    larger_limit.sort("name", 1).sort("age", -1).limit(6);
+    ASSERT_TRUE(by_name_age.hash() != by_age_name.hash(), "Shape: sort key order should matter");
+    ASSERT_TRUE(by_name_age.hash() != larger_limit.hash(), "Shape: option values should matter");
+
+    QDB::Aggregation first, second, reordered;
+    first.match(ab).limit(10);
+    second.match(ba).limit(10);
+    reordered.limit(10).match(ab);
+    ASSERT_TRUE(first.canonical() == second.canonical(), "Shape: $match filters should be normalized");
+    ASSERT_TRUE(first.canonical() != reordered.canonical(), "Shape: stage order should matter");
+    return true;
+}
+
 bool run_query_builder_tests()
 {
     bool success = true;
     success &= run_test_case(test_query_operators, "Query Builder: Operators");
+    success &= run_test_case(test_query_field_order, "Query Builder: Field Order");
+    success &= run_test_case(test_query_id_value, "Query Builder: Id Value");
+    success &= run_test_case(test_query_shape, "Query Builder: Shape");
     // Add more granular tests as needed
     return success;
 }
@@ -1,4 +1,7 @@
 #include "serialization_tests.h"
+#include "profile_document.h"
+#include "quickdb/components/lazy_document.h"
+#include "quickdb/components/options.h"
 #include "test_runner.h"
 #include "user_document.h"
 #include <iostream>
@@ -31,9 +34,243 @@ bool test_serialization_cycle()
     return true;
 }
 
+bool test_model_direct_encode()
+{
+    Profile original = make_test_profile();
+
+    // to_bson writes the schema members straight into the builder.
+    bsoncxx::builder::basic::document builder;
+    original.to_bson(builder);
+    auto bson = builder.extract();
+
+    std::unordered_map<std::string, QDB::FieldValue> fields;
+    for (const auto &element : bson.view())
+    {
+        fields[static_cast<std::string>(element.key())] = QDB::fromBsonElement(element);
+    }
+    ASSERT_TRUE(fields.size() == 9, "to_bson: every schema member should be written.");
+    ASSERT_TRUE(fields == original.to_fields(), "to_bson: output should match the to_fields encoding.");
+
+    Profile decoded;
+    decoded.from_fields(fields);
+    ASSERT_TRUE(decoded == original, "to_bson: encoded document should decode back to the original.");
+    return true;
+}
+
+bool test_model_direct_decode()
+{
+    Profile original = make_test_profile();
+
+    bsoncxx::builder::basic::document builder;
+    original.to_bson(builder);
+    auto bson = builder.extract();
+
+    Profile decoded;
+    decoded.from_bson(bson.view());
+    ASSERT_TRUE(decoded == original, "from_bson: schema-ordered document should decode back to the original.");
+
+    // Out-of-order keys, unknown keys and mismatched types must still decode like from_fields().
+    using bsoncxx::builder::basic::kvp;
+    auto shuffled = bsoncxx::builder::basic::make_document(
+        kvp("_id", bsoncxx::oid()), kvp("legacy_field", "ignored"), kvp("score", 2.5), kvp("handle", "@shuffled"),
+        kvp("followers", "not-a-number"), kvp("verified", true));
+
+    Profile partial = make_test_profile();
+    partial.from_bson(shuffled.view());
+    ASSERT_TRUE(partial.handle == "@shuffled", "from_bson: out-of-order key should be found.");
+    ASSERT_TRUE(partial.score == 2.5, "from_bson: out-of-order key should be found.");
+    ASSERT_TRUE(partial.verified, "from_bson: trailing key should be found.");
+    ASSERT_TRUE(partial.followers == 0, "from_bson: mismatched type should reset the member.");
+    ASSERT_TRUE(partial.tags == original.tags, "from_bson: missing keys should leave members untouched.");
+    return true;
+}
+
+bool test_lazy_document()
+{
+    Profile original = make_test_profile();
+    bsoncxx::oid id;
+
+    bsoncxx::builder::basic::document builder;
+    builder.append(bsoncxx::builder::basic::kvp("_id", id));
+    original.to_bson(builder);
+    QDB::LazyDocument<Profile> lazy(builder.extract());
+
+    ASSERT_TRUE(lazy.get_id() == id, "LazyDocument: _id should be readable without decoding.");
+    ASSERT_TRUE(lazy.has_field("tags"), "LazyDocument: has_field should find existing keys.");
+    ASSERT_TRUE(!lazy.has_field("missing"), "LazyDocument: has_field should reject unknown keys.");
+    ASSERT_TRUE(lazy.get<std::string>("handle") == original.handle, "LazyDocument: string field should decode.");
+
+    // The second read must hit the cache and return the same object.
+    const auto &tags = lazy.get<std::vector<std::string>>("tags");
+    ASSERT_TRUE(tags == original.tags, "LazyDocument: array field should decode.");
+    ASSERT_TRUE(&tags == &lazy.get<std::vector<std::string>>("tags"), "LazyDocument: field should be cached.");
+    ASSERT_TRUE(lazy.get<Address>("address") == original.address, "LazyDocument: nested model should decode.");
+
+    bool threw = false;
+    try
+    {
+        lazy.get<int32_t>("missing");
+    }
+    catch (const QDB::Exception &)
+    {
+        threw = true;
+    }
+    ASSERT_TRUE(threw, "LazyDocument: reading a missing field should throw.");
+
+    Profile materialized = lazy.materialize();
+    ASSERT_TRUE(materialized == original, "LazyDocument: materialize should decode every field.");
+    ASSERT_TRUE(materialized.get_id() == id, "LazyDocument: materialize should keep the _id.");
+    return true;
+}
+
+bool test_schema_projection()
+{
+    const auto &projection = Profile::schema_projection();
+    ASSERT_TRUE(&projection == &Profile::schema_projection(), "schema_projection: should be cached per type.");
+
+    size_t count = 0;
+    for (const auto &element : projection.view())
+    {
+        ASSERT_TRUE(element.type() == bsoncxx::type::k_int32 && element.get_int32().value == 1,
+                    "schema_projection: every field should be included.");
+        ++count;
+    }
+    ASSERT_TRUE(count == 9, "schema_projection: should list every schema member.");
+    ASSERT_TRUE(projection.view()["previous_addresses"], "schema_projection: should use schema field names.");
+    ASSERT_TRUE(Address::schema_projection().view()["zip"], "schema_projection: nested models get their own.");
+
+    QDB::FindOptions options;
+    ASSERT_TRUE(!options.uses_schema_projection(), "schema_projection: should be opt-in.");
+    options.schema_projection();
+    ASSERT_TRUE(options.uses_schema_projection() && !options.has_projection(),
+                "schema_projection: flag should not set an explicit projection.");
+    return true;
+}
+
+bool test_model_key_table()
+{
+    const QDB::FieldKeyTable &keys = Profile::key_table();
+    ASSERT_TRUE(&keys == &Profile::key_table(), "key_table: should be built once per type.");
+    ASSERT_TRUE(keys.size() == 9, "key_table: should hold every schema member.");
+    ASSERT_TRUE(keys.addressable(), "key_table: plain members should be addressable by offset.");
+
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        ASSERT_TRUE(keys[i].hash == QDB::field_hash(keys[i].name), "key_table: hashes should be precomputed.");
+        ASSERT_TRUE(keys.find(keys[i].name) == i, "key_table: every name should be found at its schema index.");
+    }
+    ASSERT_TRUE(keys[0].name == "handle" && keys[8].name == "previous_addresses", "key_table: should keep schema order.");
+    ASSERT_TRUE(keys.find("legacy_field") == QDB::FieldKeyTable::npos, "key_table: unknown keys should not match.");
+
+    static_assert(QDB::field_hash("zip") != QDB::field_hash("city"), "field_hash should be usable at compile time.");
+    return true;
+}
+
+bool test_compact_field_value()
+{
+    ASSERT_TRUE(sizeof(QDB::FieldValue) <= 24, "FieldValue: should stay compact.");
+
+    QDB::FieldValue short_text(std::string("inline"));
+    QDB::FieldValue long_text(std::string("a string that does not fit inline"));
+    ASSERT_TRUE(short_text.string_view() == "inline", "FieldValue: short strings should round-trip.");
+    ASSERT_TRUE(long_text.as<std::string>() == "a string that does not fit inline",
+                "FieldValue: long strings should round-trip.");
+
+    // Arrays and objects keep their children contiguously and grow on demand.
+    QDB::FieldValue items = QDB::FieldValue::make_array();
+    for (int32_t i = 0; i < 100; ++i)
+    {
+        items.push_back(QDB::FieldValue(i));
+    }
+    ASSERT_TRUE(items.array().size() == 100 && items.array()[99].as<int32_t>() == 99,
+                "FieldValue: push_back should append items in order.");
+
+    QDB::FieldValue copy = items;
+    ASSERT_TRUE(copy == items, "FieldValue: copies should compare equal.");
+    copy.array()[0] = QDB::FieldValue(-1);
+    ASSERT_TRUE(copy != items, "FieldValue: copies should be deep.");
+
+    QDB::FieldValue object = QDB::FieldValue::make_object();
+    object.emplace_member("b", QDB::FieldValue(2));
+    object.emplace_member("a", QDB::FieldValue(1));
+    object.set_member("b", QDB::FieldValue(3));
+    ASSERT_TRUE(object.object().size() == 2 && object.object()[0].first == "b",
+                "FieldValue: set_member should replace existing keys in place.");
+    ASSERT_TRUE(object.find("b")->as<int32_t>() == 3 && object.find("c") == nullptr,
+                "FieldValue: find should look up members by key.");
+
+    std::map<std::string, int32_t> expected{{"a", 1}, {"b", 3}};
+    ASSERT_TRUE(object == QDB::FieldValue(expected), "FieldValue: object equality should ignore member order.");
+    ASSERT_TRUE((object.as<std::map<std::string, int32_t>>() == expected), "FieldValue: as<map> should still work.");
+    return true;
+}
+
+// Counts the allocations that reach the upstream resource.
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    size_t allocations = 0;
+
+private:
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void *ptr, size_t bytes, size_t alignment) override
+    {
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+};
+
+bool test_arena_decode()
+{
+    ArenaNote source;
+    source.title = "a title that is longer than the small string buffer";
+    source.tags = {"first tag that needs a heap allocation", "second tag that needs a heap allocation"};
+    source.priority = 7;
+
+    bsoncxx::builder::basic::document builder;
+    source.to_bson(builder);
+    auto bson = builder.extract();
+
+    CountingResource upstream;
+    {
+        std::pmr::monotonic_buffer_resource arena(&upstream);
+        QDB::ScopedFieldResource scope(&arena);
+
+        // Documents, their pmr members and FieldValue blocks are all carved out of the arena.
+        std::pmr::vector<ArenaNote> notes(&arena);
+        notes.emplace_back();
+        notes.back().from_bson(bson.view());
+        QDB::FieldValue tree = QDB::fromBsonElement(*bson.view().find("tags"));
+
+        ASSERT_TRUE(notes.back().title == source.title && notes.back().tags == source.tags,
+                    "Arena decode: pmr members should decode.");
+        ASSERT_TRUE(notes.back().title.get_allocator().resource() == &arena,
+                    "Arena decode: members should use the arena.");
+        ASSERT_TRUE(tree.as<std::vector<std::string>>().size() == 2, "Arena decode: FieldValue trees should decode.");
+        ASSERT_TRUE(upstream.allocations > 0, "Arena decode: allocations should reach the arena's upstream.");
+    }
+
+    // Outside the scope FieldValues go back to operator new.
+    size_t before = upstream.allocations;
+    QDB::FieldValue heap_value(std::string("a string long enough to need its own block"));
+    ASSERT_TRUE(upstream.allocations == before, "Arena decode: the scope should end with the block.");
+    return true;
+}
+
 bool run_serialization_tests()
 {
     bool success = true;
     success &= run_test_case(test_serialization_cycle, "Serialization: to_fields/from_fields Cycle");
+    success &= run_test_case(test_model_direct_encode, "Serialization: Model direct BSON encode");
+    success &= run_test_case(test_model_direct_decode, "Serialization: Model direct BSON decode");
+    success &= run_test_case(test_lazy_document, "Serialization: LazyDocument on-demand decode");
+    success &= run_test_case(test_schema_projection, "Serialization: Model schema projection");
+    success &= run_test_case(test_model_key_table, "Serialization: Model key table");
+    success &= run_test_case(test_compact_field_value, "Serialization: Compact FieldValue storage");
+    success &= run_test_case(test_arena_decode, "Serialization: Arena-backed decode");
     return success;
 }